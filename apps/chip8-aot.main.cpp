@@ -0,0 +1,76 @@
+#include "chip8-aot/translator.hpp"
+#include <ch8/system.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+[[nodiscard]] auto read_program(const std::filesystem::path& program_file)
+    -> std::vector<std::uint8_t>
+{
+    auto file = std::ifstream{program_file, std::ios::binary};
+    file.unsetf(std::ios::skipws);
+
+    return std::vector<std::uint8_t>{
+        std::istream_iterator<std::uint8_t>{file},
+        std::istream_iterator<std::uint8_t>{}};
+}
+
+auto write_file(const std::filesystem::path& path, const std::string& text)
+    -> bool
+{
+    auto file = std::ofstream{path, std::ios::binary};
+    file << text;
+    return static_cast<bool>(file);
+}
+
+// Usage: chip8-aot <program.ch8> <output.cpp> [symbol]
+//
+// Writes output.cpp and output.hpp. The header declares symbol(), which
+// returns the module to pass to chip8_system::load_native.
+auto main(int argc, char** argv) -> int
+{
+    const auto args = std::vector<std::string>(argv, argv + argc);
+    if (args.size() < 3 || args.size() > 4) {
+        std::cerr << "usage: chip8-aot <program.ch8> <output.cpp> [symbol]\n";
+        return 1;
+    }
+
+    const auto program_file = std::filesystem::path{args[1]};
+    const auto source_file = std::filesystem::path{args[2]};
+    auto header_file = source_file;
+    header_file.replace_extension(".hpp");
+
+    if (!std::filesystem::exists(program_file)) {
+        std::cerr << "chip8-aot: " << program_file << " does not exist\n";
+        return 1;
+    }
+
+    const auto program = read_program(program_file);
+    const auto max_size =
+        ch8::chip8_data{}.ram.size() - ch8::chip8_data::program_start;
+    if (program.size() > max_size) {
+        std::cerr << "chip8-aot: " << program_file << " is too big\n";
+        return 1;
+    }
+
+    const auto symbol = args.size() == 4
+                            ? args[3]
+                            : make_symbol(program_file.stem().string());
+    const auto result = translate(
+        program, symbol, header_file.filename().string());
+
+    if (!write_file(header_file, result.header) ||
+        !write_file(source_file, result.source)) {
+        std::cerr << "chip8-aot: could not write " << source_file << '\n';
+        return 1;
+    }
+
+    std::cout << "chip8-aot: translated " << result.instruction_count
+              << " instructions in " << result.block_count << " blocks to "
+              << source_file << '\n';
+    return 0;
+}
@@ -0,0 +1,430 @@
+#include "chip8-aot/translator.hpp"
+#include <ch8/instruction.hpp>
+#include <ch8/system.hpp>
+#include <algorithm>
+#include <cctype>
+#include <fmt/format.h>
+#include <optional>
+#include <utility>
+
+namespace {
+    constexpr auto max_block_length = std::size_t{64};
+
+    struct translated_instruction {
+        std::string code;
+        bool ends_block;
+        std::vector<std::size_t> successors;
+    };
+
+    struct block {
+        std::size_t address;
+        std::size_t instructions;
+        std::string code;
+    };
+} // namespace
+
+[[nodiscard]] auto
+translate_instruction(std::uint16_t opcode, std::size_t address)
+    -> std::optional<translated_instruction>;
+
+auto translate(
+    const std::vector<std::uint8_t>& program, const std::string_view symbol,
+    const std::string_view header_name) -> translation
+{
+    constexpr auto start = std::size_t{ch8::chip8_data::program_start};
+    const auto end = start + program.size();
+
+    const auto opcode_at = [&program](std::size_t address) {
+        return ch8::create_opcode(
+            program.at(address - start), program.at(address + 1U - start));
+    };
+
+    auto visited = std::vector<bool>(end, false);
+    auto pending = std::vector<std::size_t>{start};
+    auto blocks = std::vector<block>{};
+
+    while (!pending.empty()) {
+        const auto leader = pending.back();
+        pending.pop_back();
+        if (leader < start || leader + 1U >= end || visited.at(leader)) {
+            continue;
+        }
+        visited.at(leader) = true;
+
+        auto current = block{leader, 0, {}};
+        auto address = leader;
+        auto closed = false;
+
+        while (current.instructions < max_block_length && address + 1U < end) {
+            const auto opcode = opcode_at(address);
+            const auto translated = translate_instruction(opcode, address);
+            if (!translated) {
+                break;
+            }
+
+            current.code += fmt::format(
+                "    // {:03X}: {:04X}\n{}", address, opcode, translated->code);
+            ++current.instructions;
+            address += 2U;
+
+            if (translated->ends_block) {
+                pending.insert(
+                    pending.end(), translated->successors.begin(),
+                    translated->successors.end());
+                closed = true;
+                break;
+            }
+        }
+
+        if (current.instructions == 0) {
+            continue;
+        }
+
+        if (!closed) {
+            current.code += fmt::format(
+                "    data.program_counter = 0x{:03X};\n"
+                "    return trap::none;\n",
+                address);
+            pending.push_back(address);
+        }
+
+        blocks.push_back(std::move(current));
+    }
+
+    std::sort(blocks.begin(), blocks.end(), [](const auto& a, const auto& b) {
+        return a.address < b.address;
+    });
+
+    auto guard = std::string{symbol};
+    std::transform(guard.begin(), guard.end(), guard.begin(), [](char c) {
+        return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    });
+
+    auto result = translation{};
+    result.block_count = blocks.size();
+
+    result.header = fmt::format(
+        "// Generated by chip8-aot. Do not edit.\n"
+        "#ifndef CH8_NATIVE_{0}_HPP\n"
+        "#define CH8_NATIVE_{0}_HPP\n"
+        "\n"
+        "#include <ch8/native_code.hpp>\n"
+        "\n"
+        "auto {1}() noexcept -> const ch8::native_module&;\n"
+        "\n"
+        "#endif // CH8_NATIVE_{0}_HPP\n",
+        guard, symbol);
+
+    auto& source = result.source;
+    source = fmt::format(
+        "// Generated by chip8-aot. Do not edit.\n"
+        "#include \"{}\"\n"
+        "#include <array>\n"
+        "#include <ch8/system.hpp>\n"
+        "#include <cstddef>\n"
+        "#include <cstdint>\n"
+        "\n"
+        "namespace {{\n"
+        "using ch8::chip8_system;\n"
+        "using ch8::trap;\n"
+        "\n"
+        "constexpr auto program = std::array<std::uint8_t, {}>{{",
+        header_name, program.size());
+
+    for (auto i = std::size_t{0}; i < program.size(); ++i) {
+        source += fmt::format(
+            "{}0x{:02X},", i % 12U == 0 ? "\n    " : " ", program[i]);
+    }
+    source += "\n};\n";
+
+    for (const auto& current : blocks) {
+        result.instruction_count += current.instructions;
+        source += fmt::format(
+            "\n"
+            "auto block_{:03X}(chip8_system& system) -> trap\n"
+            "{{\n"
+            "    [[maybe_unused]] auto& data = system.data;\n"
+            "    [[maybe_unused]] auto& v = system.data.registers;\n"
+            "\n"
+            "{}"
+            "}}\n",
+            current.address, current.code);
+    }
+
+    source += fmt::format(
+        "\n"
+        "constexpr auto blocks = std::array<ch8::native_block, {}>{{{{\n",
+        blocks.size());
+    for (const auto& current : blocks) {
+        source += fmt::format(
+            "    {{0x{0:03X}, {1}, {2}, block_{0:03X}}},\n", current.address,
+            current.instructions * 2U, current.instructions);
+    }
+    source += fmt::format(
+        "}}}};\n"
+        "}} // namespace\n"
+        "\n"
+        "auto {}() noexcept -> const ch8::native_module&\n"
+        "{{\n"
+        "    static constexpr auto module = ch8::native_module{{\n"
+        "        program.data(), program.size(), blocks.data(), "
+        "blocks.size()}};\n"
+        "    return module;\n"
+        "}}\n",
+        symbol);
+
+    return result;
+}
+
+auto make_symbol(const std::string_view name) -> std::string
+{
+    auto symbol = std::string{};
+    for (const auto c : name) {
+        const auto valid = std::isalnum(static_cast<unsigned char>(c)) != 0;
+        symbol += valid ? c : '_';
+    }
+
+    if (symbol.empty() ||
+        std::isdigit(static_cast<unsigned char>(symbol.front())) != 0) {
+        symbol.insert(0, "rom_");
+    }
+
+    return symbol;
+}
+
+// Each instruction keeps the semantics of its op_* handler in system.cpp.
+// Instructions that draw, use the random number generator or wait for a key
+// are handed to chip8_system::step. Bnnn and unknown opcodes are left out so
+// the interpreter runs them.
+auto translate_instruction(
+    const std::uint16_t opcode, const std::size_t address)
+    -> std::optional<translated_instruction>
+{
+    const auto x = (opcode & 0x0F00U) >> 8U;
+    const auto y = (opcode & 0x00F0U) >> 4U;
+    const auto kk = opcode & 0x00FFU;
+    const auto nnn = opcode & 0x0FFFU;
+    const auto next = address + 2U;
+    const auto skip = address + 4U;
+
+    const auto straight = [](std::string code) {
+        return translated_instruction{std::move(code), false, {}};
+    };
+    const auto branch = [](std::string code,
+                           std::vector<std::size_t> targets) {
+        return translated_instruction{
+            std::move(code), true, std::move(targets)};
+    };
+    const auto interpret = fmt::format(
+        "    data.program_counter = 0x{:03X};\n"
+        "    if (const auto result = system.step(); result != trap::none) {{\n"
+        "        return result;\n"
+        "    }}\n",
+        address);
+    const auto skip_if = [&](const std::string& condition) {
+        return branch(
+            fmt::format(
+                "    data.program_counter = {}\n"
+                "        ? std::uint16_t{{0x{:03X}}}\n"
+                "        : std::uint16_t{{0x{:03X}}};\n"
+                "    return trap::none;\n",
+                condition, skip, next),
+            {next, skip});
+    };
+
+    switch (opcode & 0xF000U) {
+    case 0x0000:
+        if (opcode == 0x00E0) {
+            return straight(interpret);
+        }
+        if (opcode == 0x00EE) {
+            return branch(
+                fmt::format(
+                    "    const auto sp =\n"
+                    "        static_cast<std::size_t>(data.stack_pointer);\n"
+                    "    if (sp >= data.stack.size()) {{\n"
+                    "        data.program_counter = 0x{:03X};\n"
+                    "        return trap::stack_underflow;\n"
+                    "    }}\n"
+                    "    // NOLINTNEXTLINE("
+                    "cppcoreguidelines-pro-bounds-constant-array-index)\n"
+                    "    data.program_counter = data.stack[sp];\n"
+                    "    data.stack_pointer--;\n"
+                    "    return trap::none;\n",
+                    address),
+                {});
+        }
+        return straight("");
+    case 0x1000:
+        return branch(
+            fmt::format(
+                "    data.program_counter = 0x{:03X};\n"
+                "    return trap::none;\n",
+                nnn),
+            {nnn});
+    case 0x2000:
+        return branch(
+            fmt::format(
+                "    const auto sp =\n"
+                "        static_cast<std::size_t>(data.stack_pointer + 1);\n"
+                "    if (sp >= data.stack.size()) {{\n"
+                "        data.program_counter = 0x{:03X};\n"
+                "        return trap::stack_overflow;\n"
+                "    }}\n"
+                "    data.stack_pointer++;\n"
+                "    // NOLINTNEXTLINE("
+                "cppcoreguidelines-pro-bounds-constant-array-index)\n"
+                "    data.stack[sp] = 0x{:03X};\n"
+                "    data.program_counter = 0x{:03X};\n"
+                "    return trap::none;\n",
+                address, next, nnn),
+            {nnn, next});
+    case 0x3000:
+        return skip_if(fmt::format("v[0x{:X}] == 0x{:02X}", x, kk));
+    case 0x4000:
+        return skip_if(fmt::format("v[0x{:X}] != 0x{:02X}", x, kk));
+    case 0x5000:
+        if ((opcode & 0x000FU) != 0) {
+            return {};
+        }
+        return skip_if(fmt::format("v[0x{:X}] == v[0x{:X}]", x, y));
+    case 0x6000:
+        return straight(fmt::format("    v[0x{:X}] = 0x{:02X};\n", x, kk));
+    case 0x7000:
+        return straight(fmt::format(
+            "    v[0x{0:X}] =\n"
+            "        static_cast<std::uint8_t>(v[0x{0:X}] + 0x{1:02X});\n",
+            x, kk));
+    case 0x8000:
+        switch (opcode & 0x000FU) {
+        case 0x0:
+            return straight(fmt::format("    v[0x{:X}] = v[0x{:X}];\n", x, y));
+        case 0x1:
+            return straight(fmt::format("    v[0x{:X}] |= v[0x{:X}];\n", x, y));
+        case 0x2:
+            return straight(fmt::format("    v[0x{:X}] &= v[0x{:X}];\n", x, y));
+        case 0x3:
+            return straight(fmt::format("    v[0x{:X}] ^= v[0x{:X}];\n", x, y));
+        case 0x4:
+            return straight(fmt::format(
+                "    {{\n"
+                "        const auto sum = v[0x{0:X}] + v[0x{1:X}];\n"
+                "        v[0x{0:X}] = static_cast<std::uint8_t>(sum);\n"
+                "        v[0xF] = static_cast<std::uint8_t>(sum > 0xFF);\n"
+                "    }}\n",
+                x, y));
+        case 0x5:
+        case 0x7: {
+            const auto [from, by] = (opcode & 0x000FU) == 0x5
+                                        ? std::pair{x, y}
+                                        : std::pair{y, x};
+            return straight(fmt::format(
+                "    {{\n"
+                "        const auto from = v[0x{1:X}];\n"
+                "        const auto by = v[0x{2:X}];\n"
+                "        v[0x{0:X}] = static_cast<std::uint8_t>(from - by);\n"
+                "        v[0xF] = static_cast<std::uint8_t>(from > by);\n"
+                "    }}\n",
+                x, from, by));
+        }
+        case 0x6:
+            return straight(fmt::format(
+                "    {{\n"
+                "        const auto value =\n"
+                "            system.accurate_8xy6 ? v[0x{1:X}] : v[0x{0:X}];\n"
+                "        v[0x{0:X}] = static_cast<std::uint8_t>(value >> 1U);\n"
+                "        v[0xF] = static_cast<std::uint8_t>(value & 1U);\n"
+                "    }}\n",
+                x, y));
+        case 0xE:
+            return straight(fmt::format(
+                "    {{\n"
+                "        const auto value =\n"
+                "            system.accurate_8xyE ? v[0x{1:X}] : v[0x{0:X}];\n"
+                "        v[0x{0:X}] = static_cast<std::uint8_t>(value << 1U);\n"
+                "        v[0xF] = static_cast<std::uint8_t>(value >> 7U);\n"
+                "    }}\n",
+                x, y));
+        default:
+            return {};
+        }
+    case 0x9000:
+        if ((opcode & 0x000FU) != 0) {
+            return {};
+        }
+        return skip_if(fmt::format("v[0x{:X}] != v[0x{:X}]", x, y));
+    case 0xA000:
+        return straight(fmt::format("    data.i_register = 0x{:03X};\n", nnn));
+    case 0xC000:
+    case 0xD000:
+        return straight(interpret);
+    case 0xE000:
+        if (kk == 0x9E) {
+            return skip_if(fmt::format("data.keypad[v[0x{:X}] & 0xFU]", x));
+        }
+        if (kk == 0xA1) {
+            return skip_if(fmt::format("!data.keypad[v[0x{:X}] & 0xFU]", x));
+        }
+        return {};
+    case 0xF000:
+        break;
+    default:
+        return {};
+    }
+
+    const auto memory = [](std::size_t offset) {
+        return fmt::format(
+            "data.ram[(data.i_register + {}U) & 0xFFFU]", offset);
+    };
+    const auto stored = [&](std::string code) {
+        return branch(
+            code + fmt::format(
+                       "    data.program_counter = 0x{:03X};\n"
+                       "    return trap::none;\n",
+                       next),
+            {next});
+    };
+
+    switch (kk) {
+    case 0x07:
+        return straight(fmt::format("    v[0x{:X}] = data.delay_timer;\n", x));
+    case 0x0A:
+        return branch(interpret + "    return trap::none;\n", {next});
+    case 0x15:
+        return straight(fmt::format("    data.delay_timer = v[0x{:X}];\n", x));
+    case 0x18:
+        return straight(fmt::format("    data.sound_timer = v[0x{:X}];\n", x));
+    case 0x1E:
+        return straight(fmt::format(
+            "    data.i_register = static_cast<std::uint16_t>(\n"
+            "        data.i_register + v[0x{:X}]);\n",
+            x));
+    case 0x29:
+        return straight(fmt::format(
+            "    data.i_register =\n"
+            "        static_cast<std::uint16_t>(v[0x{:X}] * 5U);\n",
+            x));
+    case 0x33:
+        return stored(fmt::format(
+            "    {0} = static_cast<std::uint8_t>(v[0x{3:X}] / 100U % 10U);\n"
+            "    {1} = static_cast<std::uint8_t>(v[0x{3:X}] / 10U % 10U);\n"
+            "    {2} = static_cast<std::uint8_t>(v[0x{3:X}] % 10U);\n",
+            memory(0), memory(1), memory(2), x));
+    case 0x55: {
+        auto code = std::string{};
+        for (auto i = std::size_t{0}; i <= x; ++i) {
+            code += fmt::format("    {} = v[0x{:X}];\n", memory(i), i);
+        }
+        return stored(code);
+    }
+    case 0x65: {
+        auto code = std::string{};
+        for (auto i = std::size_t{0}; i <= x; ++i) {
+            code += fmt::format("    v[0x{:X}] = {};\n", i, memory(i));
+        }
+        return straight(code);
+    }
+    default:
+        return {};
+    }
+}
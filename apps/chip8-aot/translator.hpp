@@ -0,0 +1,26 @@
+#ifndef CHIP8_AOT_TRANSLATOR_HPP
+#define CHIP8_AOT_TRANSLATOR_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct translation {
+    std::string header;
+    std::string source;
+    std::size_t block_count{};
+    std::size_t instruction_count{};
+};
+
+// Follows the control flow of program from chip8_data::program_start and
+// emits one C++ function per basic block, plus a native_module named symbol
+// that chip8_system::load_native accepts.
+[[nodiscard]] auto translate(
+    const std::vector<std::uint8_t>& program, std::string_view symbol,
+    std::string_view header_name) -> translation;
+
+// Turns a file name into a valid C++ identifier.
+[[nodiscard]] auto make_symbol(std::string_view name) -> std::string;
+
+#endif // CHIP8_AOT_TRANSLATOR_HPP
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <ch8/profiler.hpp>
+#include <ch8/system.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct options {
+    std::uint64_t instructions{1'000'000};
+    std::uint32_t sample_interval{61};
+    bool json{false};
+    std::vector<std::filesystem::path> programs;
+};
+
+[[nodiscard]] auto parse_count(const std::string& text)
+    -> std::optional<std::uint64_t>
+{
+    try {
+        auto used = std::size_t{0};
+        const auto value = std::stoull(text, &used);
+        if (used != text.size()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+    catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+[[nodiscard]] auto parse_options(const std::vector<std::string>& args)
+    -> std::optional<options>
+{
+    auto parsed = options{};
+    for (auto i = std::size_t{1}; i < args.size(); ++i) {
+        const auto& arg = args[i];
+        if (arg == "--json" || arg == "--csv") {
+            parsed.json = arg == "--json";
+        }
+        else if (arg == "--instructions" || arg == "--sample") {
+            const auto count = i + 1 < args.size() ? parse_count(args[i + 1])
+                                                   : std::nullopt;
+            constexpr auto max_interval =
+                std::numeric_limits<std::uint32_t>::max();
+            if (!count || (arg == "--sample" && *count > max_interval)) {
+                return std::nullopt;
+            }
+            if (arg == "--instructions") {
+                parsed.instructions = *count;
+            }
+            else {
+                parsed.sample_interval = static_cast<std::uint32_t>(*count);
+            }
+            ++i;
+        }
+        else {
+            parsed.programs.emplace_back(arg);
+        }
+    }
+
+    if (parsed.programs.empty()) {
+        return std::nullopt;
+    }
+    return parsed;
+}
+
+// Runs like execute() at the default speed, a frame of instructions between
+// timer ticks, without the wall clock. Nothing is ever pressed, so programs
+// waiting for a key sit in Fx0A.
+auto profile_program(
+    const std::filesystem::path& program, std::uint64_t instructions,
+    ch8::profiler& profiler) -> bool
+{
+    auto system = ch8::chip8_system{};
+    if (system.load_program(program) != ch8::load_status::ok) {
+        std::cerr << "chip8-profile: could not load " << program << '\n';
+        return false;
+    }
+
+    const auto per_frame =
+        static_cast<std::uint64_t>(std::max(system.updates_per_second / 60, 1));
+    system.profile(&profiler);
+    while (instructions > 0) {
+        const auto count = std::min(instructions, per_frame);
+        const auto result = system.run(count);
+        if (result != ch8::trap::none) {
+            std::cerr << "chip8-profile: " << program << " trapped at "
+                      << std::hex << system.data.program_counter << std::dec
+                      << '\n';
+            break;
+        }
+        system.update_timers();
+        instructions -= count;
+    }
+    return true;
+}
+
+// Usage: chip8-profile [--instructions n] [--sample n] [--csv | --json]
+//                      <program.ch8>...
+//
+// Runs each program for n instructions and writes their combined profile to
+// stdout. Timing is sampled every n instructions, or not at all with 0.
+auto main(int argc, char** argv) -> int
+{
+    const auto parsed =
+        parse_options(std::vector<std::string>(argv, argv + argc));
+    if (!parsed) {
+        std::cerr << "usage: chip8-profile [--instructions n] [--sample n] "
+                     "[--csv | --json] <program.ch8>...\n";
+        return 1;
+    }
+
+    auto total = ch8::profiler{parsed->sample_interval};
+    auto profiled = std::size_t{0};
+    for (const auto& program : parsed->programs) {
+        if (profile_program(program, parsed->instructions, total)) {
+            ++profiled;
+        }
+    }
+
+    if (parsed->json) {
+        total.write_json(std::cout);
+    }
+    else {
+        total.write_csv(std::cout);
+    }
+
+    std::cerr << "chip8-profile: profiled " << profiled << " of "
+              << parsed->programs.size() << " programs\n";
+    return profiled == parsed->programs.size() ? 0 : 1;
+}
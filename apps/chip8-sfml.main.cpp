@@ -5,6 +5,7 @@
 #include <SFML/Window.hpp>
 #include <algorithm>
 #include <array>
+#include <ch8/program_map.hpp>
 #include <ch8/system.hpp>
 #include <chrono>
 #include <cstdint>
@@ -104,17 +105,51 @@ auto main() -> int
     auto chip8 = ch8::chip8_system{};
     chip8.updates_per_second = configs.interpreter.speed;
     auto chip8_running = false;
+    auto program = ch8::program_map{};
+    auto profiler = ch8::profiler{};
+    auto profiling = false;
 
     auto texture = sf::Texture{};
     texture.create(
         gsl::narrow<unsigned>(chip8.data.screen.width()),
         gsl::narrow<unsigned>(chip8.data.screen.height()));
 
-    chip8.observe_event(
-        ch8::chip8_system::observable_event::draw,
-        [&texture](const auto& frame_buffer) {
-            texture.update(frame_buffer.data().data());
+    // The texture is updated once per frame rather than once per draw, and
+    // only in the rows the frame changed, since a run of whole rows is
+    // contiguous in rgba. The whole screen is uploaded when it is replaced
+    // without drawing, by a reset.
+    chip8.presentation(ch8::presentation_mode::per_frame);
+    auto rgba = ch8::frame_buffer<64, 32>{};
+    const auto upload_screen = [&texture, &rgba](
+                                   const auto& frame_buffer,
+                                   const ch8::screen_region& region) {
+        if (region.empty()) {
+            return;
+        }
+        frame_buffer.to_rgba(
+            rgba, {255, 255, 255, 255}, {0, 0, 0, 255}, region);
+        texture.update(
+            &rgba.data()[region.y * rgba.width() * 4],
+            gsl::narrow<unsigned>(rgba.width()),
+            gsl::narrow<unsigned>(region.height),
+            0,
+            gsl::narrow<unsigned>(region.y));
+    };
+    chip8.observe_event<ch8::chip8_system::observable_event::frame>(
+        [&upload_screen](
+            const auto& frame_buffer, const ch8::frame_info& frame) {
+            upload_screen(frame_buffer, frame.changed);
         });
+    auto screen_replaced = true;
+
+    chip8.observe<ch8::machine_event::sound_start>(
+        [&sound]() { sound.play(); });
+    chip8.observe<ch8::machine_event::sound_stop>(
+        [&sound]() { sound.pause(); });
+    chip8.observe<ch8::machine_event::trap>([&chip8_running, &sound]() {
+        chip8_running = false;
+        sound.pause();
+    });
 
     using clock = chrono::steady_clock;
     auto previous_time = chrono::steady_clock::now();
@@ -151,7 +186,9 @@ auto main() -> int
                     else {
                         chip8_running = false;
                         chip8.reset();
+                        screen_replaced = true;
                         if (chip8.load_program(file) == ch8::load_status::ok) {
+                            program = ch8::program_map::analyze(chip8.data);
                             chip8_running = true;
                         }
                     }
@@ -164,6 +201,11 @@ auto main() -> int
             ImGui::DragInt("Speed", &chip8.updates_per_second, 1.F, 1, 10'000);
             ImGui::Checkbox("Accurate 8xyE", &chip8.accurate_8xyE);
             ImGui::Checkbox("Accurate 8xy6", &chip8.accurate_8xy6);
+            auto vip_timing = chip8.timing == ch8::timing_model::cosmac_vip;
+            if (ImGui::Checkbox("COSMAC VIP timing", &vip_timing)) {
+                chip8.timing = vip_timing ? ch8::timing_model::cosmac_vip
+                                          : ch8::timing_model::fixed;
+            }
             ImGui::EndMenu();
         }
         ImGui::EndMainMenuBar();
@@ -187,6 +229,11 @@ auto main() -> int
             },
             static_cast<void*>(&aspect_ratio));
 
+        if (screen_replaced) {
+            screen_replaced = false;
+            upload_screen(chip8.data.screen, {0, 0, 64, 32});
+        }
+
         if (ImGui::Begin("Chip8", nullptr, ImGuiWindowFlags_NoTitleBar)) {
             const auto max_content = ImGui::GetWindowContentRegionMax();
             const auto min_content = ImGui::GetWindowContentRegionMin();
@@ -214,44 +261,24 @@ auto main() -> int
         ImGui::End();
 
         if (ImGui::Begin("Program")) {
-            for (auto i = std::size_t{0}; i < 20; i += 2) {
-                const auto ram_location = chip8.data.program_counter + i;
-                if (ram_location + i >= chip8.data.ram.size()) {
-                    break;
-                }
-
-                const auto byte_1 = static_cast<std::uint16_t>(
-                    chip8.data.ram.at(ram_location) << 8U);
-                const auto byte_2 = chip8.data.ram.at(ram_location + 1);
-                const auto opcode = byte_1 | byte_2;
-
-                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
-                ImGui::Text(
-                    "%s", fmt::format("{:#06x}: {:#06x}", ram_location, opcode)
-                              .c_str());
+            program_widget(chip8.data, program);
+        }
+        ImGui::End();
+
+        if (ImGui::Begin("Profiler")) {
+            if (profiler_widget(profiler, profiling)) {
+                profiler.clear();
             }
         }
         ImGui::End();
+        chip8.profile(profiling ? &profiler : nullptr);
 
         if (window.hasFocus()) {
             handle_keyboard_input(chip8, configs.keybinds);
         }
 
         if (chip8_running) {
-            try {
-                chip8.execute(delta_time);
-            }
-            catch (const std::out_of_range&) {
-            }
-
-            if (chip8.data.sound_timer > 0) {
-                if (sound.getStatus() != sf::Sound::Playing) {
-                    sound.play();
-                }
-            }
-            else {
-                sound.pause();
-            }
+            chip8.execute(delta_time);
         }
 
         window.clear(sf::Color{50, 50, 50, 255});
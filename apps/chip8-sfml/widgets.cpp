@@ -1,6 +1,8 @@
 #include "chip8-sfml/widgets.hpp"
+#include <algorithm>
 #include <fmt/format.h>
 #include <limits>
+#include <vector>
 
 auto register_widget(
     gsl::span<std::uint8_t> registers, std::uint16_t& i_register) -> void
@@ -45,3 +47,128 @@ auto keypad_widget(std::bitset<16>& keypad) -> void
     key_widget({0x7, 0x8, 0x9, 0xE});
     key_widget({0xA, 0x0, 0xB, 0xF});
 }
+
+// Lists ram from the start of the block the program counter is in. Bytes
+// the analysis didn't find code in are shown one at a time as data.
+auto program_widget(const ch8::chip8_data& data, const ch8::program_map& map)
+    -> void
+{
+    using ch8::program_map;
+
+    const auto pc = std::size_t{data.program_counter};
+    const auto* block = map.block_at(pc);
+    auto address = block != nullptr ? std::size_t{block->address} : pc;
+
+    for (auto line = 0; line < 16 && address + 1 < data.ram.size(); ++line) {
+        const auto flags = map.flags(address);
+        const auto marker = address == pc ? '>' : ' ';
+
+        if ((flags & program_map::instruction) == 0 && address != pc) {
+            const auto kind = (flags & program_map::sprite) != 0 ? "sprite"
+                              : (flags & program_map::data_access) != 0
+                                  ? "data"
+                                  : "";
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+            ImGui::TextDisabled(
+                "%s",
+                fmt::format(
+                    "{} {:#06x}: {:#04x}   {}", marker, address,
+                    data.ram.at(address), kind)
+                    .c_str());
+            ++address;
+            continue;
+        }
+
+        const auto opcode =
+            ch8::create_opcode(data.ram.at(address), data.ram.at(address + 1));
+        const auto label = (flags & program_map::call_target) != 0 ? "sub"
+                           : (flags & program_map::jump_table) != 0 ? "case"
+                           : (flags & program_map::block_start) != 0 ? "block"
+                                                                     : "";
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+        ImGui::Text(
+            "%s", fmt::format(
+                      "{} {:#06x}: {:#06x} {}", marker, address, opcode, label)
+                      .c_str());
+        address += 2;
+    }
+}
+
+// Lists the opcode classes that ran, busiest first, with the average time of
+// their samples, then the busiest addresses.
+auto profiler_widget(const ch8::profiler& profiler, bool& profiling) -> bool
+{
+    ImGui::Checkbox("Profile", &profiling);
+    ImGui::SameLine();
+    const auto cleared = ImGui::Button("Clear");
+
+    const auto total = profiler.instructions();
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    ImGui::Text("%s", fmt::format("{} instructions", total).c_str());
+    if (total == 0) {
+        return cleared;
+    }
+
+    auto classes = std::vector<ch8::opcode_class>{};
+    for (auto i = std::size_t{0}; i < ch8::opcode_classes; ++i) {
+        const auto kind = static_cast<ch8::opcode_class>(i);
+        if (profiler.statistics(kind).executions > 0) {
+            classes.push_back(kind);
+        }
+    }
+    std::sort(
+        classes.begin(), classes.end(),
+        [&profiler](ch8::opcode_class a, ch8::opcode_class b) {
+            return profiler.statistics(a).executions >
+                   profiler.statistics(b).executions;
+        });
+
+    const auto percent = [total](std::uint64_t count) {
+        return 100.0 * static_cast<double>(count) / static_cast<double>(total);
+    };
+
+    ImGui::Separator();
+    for (const auto kind : classes) {
+        const auto& stats = profiler.statistics(kind);
+        const auto average =
+            stats.samples == 0
+                ? std::string{"-"}
+                : fmt::format(
+                      "{} ns", stats.sampled_time.count() /
+                                   static_cast<std::int64_t>(stats.samples));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+        ImGui::Text(
+            "%s", fmt::format(
+                      "{:<7} {:>12} {:>6.2f}%  {}", ch8::name(kind),
+                      stats.executions, percent(stats.executions), average)
+                      .c_str());
+    }
+
+    auto addresses = std::vector<std::size_t>{};
+    for (auto address = std::size_t{0}; address < 4096; ++address) {
+        if (profiler.executions_at(address) > 0) {
+            addresses.push_back(address);
+        }
+    }
+    const auto shown = std::min(addresses.size(), std::size_t{16});
+    const auto last_shown =
+        addresses.begin() + gsl::narrow<std::ptrdiff_t>(shown);
+    std::partial_sort(
+        addresses.begin(), last_shown, addresses.end(),
+        [&profiler](std::size_t a, std::size_t b) {
+            return profiler.executions_at(a) > profiler.executions_at(b);
+        });
+
+    ImGui::Separator();
+    for (auto i = std::size_t{0}; i < shown; ++i) {
+        const auto count = profiler.executions_at(addresses[i]);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+        ImGui::Text(
+            "%s", fmt::format(
+                      "{:#06x} {:>12} {:>6.2f}%", addresses[i], count,
+                      percent(count))
+                      .c_str());
+    }
+
+    return cleared;
+}
@@ -3,6 +3,9 @@
 
 #include <array>
 #include <bitset>
+#include <ch8/profiler.hpp>
+#include <ch8/program_map.hpp>
+#include <ch8/system.hpp>
 #include <cstdint>
 #include <gsl-lite/gsl-lite.hpp>
 #include <imgui.h>
@@ -55,5 +58,9 @@ auto register_widget(
     gsl::span<std::uint8_t> registers, std::uint16_t& i_register) -> void;
 auto timer_widget(std::uint8_t& sound_timer, std::uint8_t& delay_timer) -> void;
 auto keypad_widget(std::bitset<16>& keypad) -> void;
+auto program_widget(const ch8::chip8_data& data, const ch8::program_map& map)
+    -> void;
+// Returns true if the profile was cleared.
+auto profiler_widget(const ch8::profiler& profiler, bool& profiling) -> bool;
 
 #endif // CHIP8_SFML_WIDGETS_HPP
@@ -0,0 +1,168 @@
+#include <ch8/trace.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct trace_filter {
+    std::uint16_t first_pc{0x000};
+    std::uint16_t last_pc{0xFFF};
+    std::uint16_t opcode_mask{0x0000};
+    std::uint16_t opcode_value{0x0000};
+    std::optional<std::uint8_t> changed_register;
+
+    [[nodiscard]] auto matches(const ch8::trace_record& record) const noexcept
+        -> bool
+    {
+        return record.program_counter >= first_pc &&
+               record.program_counter <= last_pc &&
+               (record.opcode & opcode_mask) == opcode_value &&
+               (!changed_register ||
+                record.changed_register == *changed_register);
+    }
+};
+
+[[nodiscard]] auto parse_number(const std::string& text)
+    -> std::optional<std::uint16_t>
+{
+    try {
+        auto used = std::size_t{0};
+        const auto value = std::stoul(text, &used, 0);
+        if (used != text.size() || value > 0xFFFF) {
+            return std::nullopt;
+        }
+        return static_cast<std::uint16_t>(value);
+    }
+    catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+// Each option is "first-last" or "mask=value", split at separator.
+[[nodiscard]] auto parse_pair(const std::string& text, char separator)
+    -> std::optional<std::pair<std::uint16_t, std::uint16_t>>
+{
+    const auto split = text.find(separator);
+    if (split == std::string::npos) {
+        return std::nullopt;
+    }
+
+    const auto left = parse_number(text.substr(0, split));
+    const auto right = parse_number(text.substr(split + 1));
+    if (!left || !right) {
+        return std::nullopt;
+    }
+    return std::pair{*left, *right};
+}
+
+[[nodiscard]] auto parse_filter(const std::vector<std::string>& options)
+    -> std::optional<trace_filter>
+{
+    auto filter = trace_filter{};
+    for (auto i = std::size_t{0}; i + 1 < options.size(); i += 2) {
+        const auto& name = options[i];
+        const auto& value = options[i + 1];
+        if (name == "--pc") {
+            const auto range = parse_pair(value, '-');
+            if (!range) {
+                return std::nullopt;
+            }
+            filter.first_pc = range->first;
+            filter.last_pc = range->second;
+        }
+        else if (name == "--opcode") {
+            const auto pattern = parse_pair(value, '=');
+            if (!pattern) {
+                return std::nullopt;
+            }
+            filter.opcode_mask = pattern->first;
+            filter.opcode_value =
+                static_cast<std::uint16_t>(pattern->second & pattern->first);
+        }
+        else if (name == "--register") {
+            const auto x = parse_number(value);
+            if (!x || *x > 0xF) {
+                return std::nullopt;
+            }
+            filter.changed_register = static_cast<std::uint8_t>(*x);
+        }
+        else {
+            return std::nullopt;
+        }
+    }
+
+    if (options.size() % 2 != 0) {
+        return std::nullopt;
+    }
+    return filter;
+}
+
+auto print(
+    std::ostream& out, std::size_t index, const ch8::trace_record& record)
+    -> void
+{
+    out << std::dec << std::setfill(' ') << std::setw(10) << index
+        << std::hex << std::uppercase << std::setfill('0') << "  "
+        << std::setw(3) << record.program_counter << "  " << std::setw(4)
+        << record.opcode << "  I=" << std::setw(3) << record.i_register
+        << "  V" << int{record.changed_register} << '=' << std::setw(2)
+        << int{record.value} << '\n';
+}
+
+// Usage: chip8-trace <trace> [--pc first-last] [--opcode mask=value]
+//                    [--register x]
+//
+// Prints the records of a trace written by ch8::trace_writer, with their
+// position in the trace, that run at a pc in range, whose opcode matches
+// value in the bits set in mask, and that changed Vx.
+auto main(int argc, char** argv) -> int
+{
+    const auto args = std::vector<std::string>(argv, argv + argc);
+    const auto filter = args.size() >= 2
+                            ? parse_filter({args.begin() + 2, args.end()})
+                            : std::nullopt;
+    if (!filter) {
+        std::cerr << "usage: chip8-trace <trace> [--pc first-last] "
+                     "[--opcode mask=value] [--register x]\n";
+        return 1;
+    }
+
+    const auto trace_file = std::filesystem::path{args[1]};
+    auto file = std::ifstream{trace_file, std::ios::binary};
+    if (!file) {
+        std::cerr << "chip8-trace: could not open " << trace_file << '\n';
+        return 1;
+    }
+
+    auto trace = std::vector<ch8::trace_record>{};
+    switch (ch8::read_trace(file, trace)) {
+    case ch8::trace_status::not_a_trace:
+        std::cerr << "chip8-trace: " << trace_file << " is not a trace\n";
+        return 1;
+    case ch8::trace_status::unsupported_version:
+        std::cerr << "chip8-trace: " << trace_file
+                  << " was written by a newer version\n";
+        return 1;
+    default:
+        break;
+    }
+
+    auto shown = std::size_t{0};
+    for (auto i = std::size_t{0}; i < trace.size(); ++i) {
+        if (filter->matches(trace[i])) {
+            print(std::cout, i, trace[i]);
+            ++shown;
+        }
+    }
+
+    std::cerr << "chip8-trace: " << shown << " of " << trace.size()
+              << " records\n";
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include "bench_results.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string_view>
+
+namespace {
+    auto write_string(std::ostream& out, std::string_view text) -> void
+    {
+        out << '"';
+        for (const auto c : text) {
+            if (c == '"' || c == '\\') {
+                out << '\\';
+            }
+            out << c;
+        }
+        out << '"';
+    }
+
+    // at is just past the opening quote and is left just past the closing
+    // one.
+    auto read_string(const std::string& text, std::size_t& at)
+        -> std::optional<std::string>
+    {
+        auto result = std::string{};
+        while (at < text.size() && text[at] != '"') {
+            if (text[at] == '\\') {
+                ++at;
+            }
+            if (at < text.size()) {
+                result += text[at++];
+            }
+        }
+        if (at >= text.size()) {
+            return std::nullopt;
+        }
+        ++at;
+        return result;
+    }
+
+    auto read_number(std::string_view object, std::string_view key)
+        -> std::optional<double>
+    {
+        const auto quoted = "\"" + std::string{key} + "\": ";
+        const auto at = object.find(quoted);
+        if (at == std::string_view::npos) {
+            return std::nullopt;
+        }
+
+        const auto number = std::string{object.substr(at + quoted.size())};
+        char* end = nullptr;
+        const auto value = std::strtod(number.c_str(), &end);
+        if (end == number.c_str()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+} // namespace
+
+auto benchmark_change::relative() const -> double
+{
+    return baseline && current ? *current / *baseline - 1.0 : 0.0;
+}
+
+auto write_results(
+    std::ostream& out, const std::vector<benchmark_result>& results) -> void
+{
+    const auto flags = out.flags();
+    out << std::fixed << std::setprecision(3) << "{\n  \"benchmarks\": [";
+    for (auto i = std::size_t{0}; i < results.size(); ++i) {
+        const auto& result = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        write_string(out, result.name);
+        out << ", \"mean_ns\": " << result.mean
+            << ", \"low_mean_ns\": " << result.low_mean
+            << ", \"high_mean_ns\": " << result.high_mean
+            << ", \"std_dev_ns\": " << result.standard_deviation
+            << ", \"samples\": " << result.samples << '}';
+    }
+    out << "\n  ]\n}\n";
+    out.flags(flags);
+}
+
+// Each benchmark is an object with the name first, so the fields of one
+// are those between the end of its name and the next closing brace.
+auto read_results(std::istream& in)
+    -> std::optional<std::vector<benchmark_result>>
+{
+    auto buffer = std::ostringstream{};
+    buffer << in.rdbuf();
+    const auto text = buffer.str();
+    if (text.find("\"benchmarks\"") == std::string::npos) {
+        return std::nullopt;
+    }
+
+    constexpr auto name_key = std::string_view{"{\"name\": \""};
+    auto results = std::vector<benchmark_result>{};
+    auto at = text.find(name_key);
+    while (at != std::string::npos) {
+        at += name_key.size();
+        const auto name = read_string(text, at);
+        const auto end = text.find('}', at);
+        if (!name || end == std::string::npos) {
+            return std::nullopt;
+        }
+
+        const auto object = std::string_view{text}.substr(at, end - at);
+        const auto mean = read_number(object, "mean_ns");
+        const auto low = read_number(object, "low_mean_ns");
+        const auto high = read_number(object, "high_mean_ns");
+        const auto deviation = read_number(object, "std_dev_ns");
+        const auto samples = read_number(object, "samples");
+        if (!mean || !low || !high || !deviation || !samples) {
+            return std::nullopt;
+        }
+
+        results.push_back(
+            {*name, *mean, *low, *high, *deviation,
+             static_cast<std::size_t>(*samples)});
+        at = text.find(name_key, end);
+    }
+    return results;
+}
+
+auto compare_results(
+    const std::vector<benchmark_result>& baseline,
+    const std::vector<benchmark_result>& current)
+    -> std::vector<benchmark_change>
+{
+    const auto find = [](const std::vector<benchmark_result>& results,
+                         const std::string& name) -> std::optional<double> {
+        const auto found = std::find_if(
+            results.begin(), results.end(),
+            [&name](const benchmark_result& r) { return r.name == name; });
+        if (found == results.end()) {
+            return std::nullopt;
+        }
+        return found->mean;
+    };
+
+    auto changes = std::vector<benchmark_change>{};
+    for (const auto& result : current) {
+        changes.push_back(
+            {result.name, find(baseline, result.name), result.mean});
+    }
+    for (const auto& result : baseline) {
+        if (!find(current, result.name)) {
+            changes.push_back({result.name, result.mean, std::nullopt});
+        }
+    }
+    return changes;
+}
+
+auto report_changes(
+    std::ostream& out, const std::vector<benchmark_change>& changes,
+    const double tolerance) -> std::size_t
+{
+    const auto flags = out.flags();
+    auto regressions = std::size_t{0};
+    for (const auto& change : changes) {
+        if (!change.baseline) {
+            out << "     new  ";
+        }
+        else if (!change.current) {
+            out << " missing  ";
+        }
+        else {
+            out << std::showpos << std::fixed << std::setprecision(1)
+                << std::setw(7) << change.relative() * 100.0 << "%  "
+                << std::noshowpos;
+        }
+        out << change.name;
+
+        if (change.relative() > tolerance) {
+            out << "  [slower]";
+            ++regressions;
+        }
+        out << '\n';
+    }
+    out.flags(flags);
+    return regressions;
+}
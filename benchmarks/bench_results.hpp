@@ -0,0 +1,48 @@
+#ifndef CHIP8_BENCH_RESULTS_HPP
+#define CHIP8_BENCH_RESULTS_HPP
+
+#include <cstddef>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+// A benchmark is named after its test case and BENCHMARK, joined by " / ".
+// Times are in nanoseconds per run of the benchmark body.
+struct benchmark_result {
+    std::string name;
+    double mean;
+    double low_mean;
+    double high_mean;
+    double standard_deviation;
+    std::size_t samples;
+};
+
+struct benchmark_change {
+    std::string name;
+    std::optional<double> baseline;
+    std::optional<double> current;
+
+    // current / baseline - 1, so 0.1 is 10% slower.
+    [[nodiscard]] auto relative() const -> double;
+};
+
+auto write_results(
+    std::ostream& out, const std::vector<benchmark_result>& results) -> void;
+// Reads what write_results wrote. Returns nullopt on anything else.
+auto read_results(std::istream& in)
+    -> std::optional<std::vector<benchmark_result>>;
+
+// Every benchmark in either list, in the order of current, followed by those
+// only in the baseline.
+auto compare_results(
+    const std::vector<benchmark_result>& baseline,
+    const std::vector<benchmark_result>& current)
+    -> std::vector<benchmark_change>;
+
+// Prints the changes and returns how many are slower than tolerance allows.
+auto report_changes(
+    std::ostream& out, const std::vector<benchmark_change>& changes,
+    double tolerance) -> std::size_t;
+
+#endif // CHIP8_BENCH_RESULTS_HPP
@@ -0,0 +1,102 @@
+#define CATCH_CONFIG_RUNNER
+#include "bench_results.hpp"
+#include <catch2/catch.hpp>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    // Filled by the listener as benchmarks end, in the order they ran.
+    auto results = std::vector<benchmark_result>{};
+
+    struct result_listener : Catch::TestEventListenerBase {
+        using TestEventListenerBase::TestEventListenerBase;
+
+        auto testCaseStarting(const Catch::TestCaseInfo& info) -> void override
+        {
+            test_case = info.name;
+        }
+
+        auto benchmarkEnded(const Catch::BenchmarkStats<>& stats)
+            -> void override
+        {
+            results.push_back(
+                {test_case + " / " + stats.info.name, stats.mean.point.count(),
+                 stats.mean.lower_bound.count(),
+                 stats.mean.upper_bound.count(),
+                 stats.standardDeviation.point.count(),
+                 stats.samples.size()});
+        }
+
+        std::string test_case;
+    };
+} // namespace
+
+CATCH_REGISTER_LISTENER(result_listener)
+
+// On top of Catch's own options:
+//
+//   --json <file>        writes the results to file
+//   --baseline <file>    compares the results with a file written by --json
+//   --tolerance <pct>    how much slower than the baseline a benchmark may
+//                        get before the run fails, 10 by default
+auto main(int argc, char** argv) -> int
+{
+    auto session = Catch::Session{};
+    auto json_file = std::string{};
+    auto baseline_file = std::string{};
+    auto tolerance = 10.0;
+
+    using Catch::clara::Opt;
+    session.cli(
+        session.cli() |
+        Opt(json_file, "file")["--json"]("write the results as JSON") |
+        Opt(baseline_file, "file")["--baseline"](
+            "compare the results with an earlier --json file") |
+        Opt(tolerance, "percent")["--tolerance"](
+            "fail when a benchmark is this much slower than the baseline"));
+
+    if (const auto status = session.applyCommandLine(argc, argv);
+        status != 0) {
+        return status;
+    }
+
+    auto baseline = std::vector<benchmark_result>{};
+    if (!baseline_file.empty()) {
+        auto file = std::ifstream{baseline_file};
+        auto read = read_results(file);
+        if (!read) {
+            std::cerr << "chip8_bench: " << baseline_file
+                      << " is not a results file\n";
+            return 1;
+        }
+        baseline = std::move(*read);
+    }
+
+    const auto failed = session.run();
+    if (failed != 0) {
+        return failed;
+    }
+
+    if (!json_file.empty()) {
+        auto file = std::ofstream{json_file};
+        write_results(file, results);
+        if (!file) {
+            std::cerr << "chip8_bench: could not write " << json_file << '\n';
+            return 1;
+        }
+    }
+
+    if (!baseline_file.empty()) {
+        std::cout << "\nCompared with " << baseline_file << ":\n";
+        const auto slower = report_changes(
+            std::cout, compare_results(baseline, results), tolerance / 100.0);
+        if (slower > 0) {
+            std::cout << slower << " benchmarks are more than " << tolerance
+                      << "% slower\n";
+            return 1;
+        }
+    }
+    return 0;
+}
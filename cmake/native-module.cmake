@@ -0,0 +1,20 @@
+# Translates a CHIP-8 program to C++ with chip8-aot and compiles the result
+# into TARGET. SYMBOL names the function returning the ch8::native_module,
+# declared in ${SYMBOL}.hpp.
+function (target_add_native_module TARGET PROGRAM SYMBOL)
+    set(OUTPUT_DIR ${CMAKE_CURRENT_BINARY_DIR}/native)
+    set(SOURCE ${OUTPUT_DIR}/${SYMBOL}.cpp)
+    set(HEADER ${OUTPUT_DIR}/${SYMBOL}.hpp)
+
+    add_custom_command(
+        OUTPUT ${SOURCE} ${HEADER}
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${OUTPUT_DIR}
+        COMMAND ${PROJECT_NAME}-aot_exe ${PROGRAM} ${SOURCE} ${SYMBOL}
+        DEPENDS ${PROJECT_NAME}-aot_exe ${PROGRAM}
+        COMMENT "Translating ${PROGRAM} to native code"
+        VERBATIM
+    )
+
+    target_sources(${TARGET} PRIVATE ${SOURCE})
+    target_include_directories(${TARGET} PRIVATE ${OUTPUT_DIR})
+endfunction ()
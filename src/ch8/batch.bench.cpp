@@ -0,0 +1,53 @@
+#include "ch8/batch.hpp"
+#include "ch8/system.hpp"
+#include <algorithm>
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <vector>
+
+// Arithmetic and branches only, so every lane stays on the same opcode and
+// the batch runs one kernel per step.
+constexpr auto lockstep_program = std::array<std::uint8_t, 20>{
+    0x7A, 0x01, // 200: ADD VA, 0x01
+    0x8A, 0xB4, // 202: ADD VA, VB
+    0x8B, 0xA6, // 204: SHR VB, VA
+    0x8C, 0xAE, // 206: SHL VC, VA
+    0x8D, 0xE3, // 208: XOR VD, VE
+    0x8E, 0x15, // 20A: SUB VE, V1
+    0xF2, 0x07, // 20C: LD V2, DT
+    0xA3, 0x00, // 20E: LD I, 0x300
+    0xF0, 0x1E, // 210: ADD I, V0
+    0x12, 0x00, // 212: JP 0x200
+};
+
+TEST_CASE("64 machines running the same program", "[benchmark]")
+{
+    constexpr auto lanes = std::size_t{64};
+    constexpr auto steps = std::size_t{1'000};
+
+    auto batch = ch8::chip8_batch<lanes>{};
+    auto systems = std::vector<ch8::chip8_system>(lanes);
+    for (auto lane = std::size_t{0}; lane < lanes; ++lane) {
+        auto& system = systems.at(lane);
+        std::copy(
+            lockstep_program.begin(), lockstep_program.end(),
+            system.data.ram.begin() + ch8::chip8_data::program_start);
+        system.data.registers.at(0xB) = static_cast<std::uint8_t>(lane);
+        batch.set_lane(lane, system.data);
+    }
+
+    BENCHMARK("chip8_system, 1'000 instructions each")
+    {
+        for (auto& system : systems) {
+            system.run(steps);
+        }
+        return systems.front().data.program_counter;
+    };
+
+    BENCHMARK("chip8_batch, 1'000 instructions each")
+    {
+        batch.run(steps);
+        return batch.data.program_counter.front();
+    };
+}
@@ -0,0 +1,781 @@
+#ifndef CH8_BATCH_HPP
+#define CH8_BATCH_HPP
+
+#include "ch8/frame_buffer.hpp"
+#include "ch8/instruction.hpp"
+#include "ch8/observable.hpp"
+#include "ch8/quirks.hpp"
+#include "ch8/random.hpp"
+#include "ch8/system.hpp"
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+namespace ch8 {
+    // The state of Lanes machines, laid out so the same register, stack level
+    // or memory address of every machine is contiguous. Lanes running the
+    // same code then fetch from one cache line instead of one page each.
+    // Screens are only touched by 00E0 and Dxyn, so they stay per machine.
+    template <std::size_t Lanes>
+    struct chip8_batch_data {
+        template <typename T>
+        using lane_array = std::array<T, Lanes>;
+
+        chip8_batch_data();
+        lane_array<std::uint16_t> program_counter;
+        lane_array<std::uint16_t> i_register;
+        lane_array<std::uint8_t> delay_timer;
+        lane_array<std::uint8_t> sound_timer;
+        lane_array<std::int8_t> stack_pointer;
+        std::array<lane_array<std::uint8_t>, 16> registers;
+        std::array<lane_array<std::uint16_t>, 16> stack;
+        lane_array<std::uint16_t> keypad;
+        lane_array<bool> waiting_for_keypress;
+        std::vector<lane_array<std::uint8_t>> ram;
+        std::vector<packed_frame_buffer<64, 32>> screen;
+    };
+
+    // Steps Lanes machines in lock step. Each step groups the lanes by
+    // opcode and runs every group through one kernel over all lanes, masked
+    // to the group, so machines running the same code share the work and
+    // the compiler can vectorise it. Machines that diverge only cost an extra
+    // group per distinct opcode.
+    //
+    // After each 00E0 and Dxyn, draw_sink is notified with the lane, its
+    // screen and the region that changed. It is picked at compile time, so a
+    // static_observable of known observers is called without any indirection
+    // and the default one costs nothing.
+    template <std::size_t Lanes, typename DrawSink = static_observable<>>
+    class chip8_batch {
+    public:
+        static_assert(Lanes > 0, "a batch needs at least one lane");
+
+        chip8_batch();
+        explicit chip8_batch(DrawSink sink);
+
+        [[nodiscard]] static constexpr auto size() noexcept -> std::size_t;
+
+        auto load_program(const std::filesystem::path& program_file)
+            -> load_status;
+        auto seed(std::size_t lane, std::uint64_t value) -> void;
+
+        auto step() noexcept -> void;
+        template <typename Quirks>
+        auto step() noexcept -> void;
+        auto run(std::size_t instruction_count) noexcept -> void;
+        auto update_timers() noexcept -> void;
+
+        [[nodiscard]] auto lane(std::size_t index) const -> chip8_data;
+        auto set_lane(std::size_t index, const chip8_data& lane_data) -> void;
+        [[nodiscard]] auto status(std::size_t index) const -> trap;
+
+        // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+        chip8_batch_data<Lanes> data;
+
+        // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+        bool accurate_8xyE;
+        // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+        bool accurate_8xy6;
+        // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+        DrawSink draw_sink;
+
+    private:
+        template <typename T>
+        using lane_array = std::array<T, Lanes>;
+        // Masks hold 0x00 or 0xFF per lane, so selecting between two values
+        // is bitwise arithmetic the compiler can vectorise.
+        using lane_mask = lane_array<std::uint8_t>;
+
+        static constexpr auto to_mask(bool value) noexcept -> std::uint8_t;
+        template <typename T>
+        static constexpr auto blend(std::uint8_t mask, T if_set, T otherwise)
+            noexcept -> T;
+
+        template <typename Quirks>
+        auto execute(
+            std::uint16_t opcode, const lane_mask& mask,
+            const lane_array<std::uint16_t>& fetched_from) noexcept -> void;
+        template <typename Quirks>
+        auto execute_row_8(std::uint16_t opcode, const lane_mask& mask) noexcept
+            -> bool;
+        auto execute_row_F(std::uint16_t opcode, const lane_mask& mask) noexcept
+            -> bool;
+        auto skip_if(const lane_mask& condition) noexcept -> void;
+        auto draw(std::size_t lane, std::uint16_t opcode) noexcept -> void;
+        auto wait_for_key(std::size_t lane, std::size_t reg) noexcept -> void;
+
+        lane_array<trap> traps;
+        lane_mask running;
+        lane_array<xoshiro128> rng;
+    };
+} // namespace ch8
+
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define CH8_BATCH ch8::chip8_batch<Lanes, DrawSink>
+
+template <std::size_t Lanes>
+ch8::chip8_batch_data<Lanes>::chip8_batch_data()
+    : program_counter{}
+    , i_register{}
+    , delay_timer{}
+    , sound_timer{}
+    , stack_pointer{}
+    , registers{}
+    , stack{}
+    , keypad{}
+    , waiting_for_keypress{}
+    , ram(chip8_data{}.ram.size())
+    , screen(Lanes)
+{
+    const auto initial = chip8_data{};
+    program_counter.fill(initial.program_counter);
+    i_register.fill(initial.i_register);
+    stack_pointer.fill(initial.stack_pointer);
+    for (auto address = std::size_t{0}; address < ram.size(); ++address) {
+        ram[address].fill(initial.ram.at(address));
+    }
+    std::fill(screen.begin(), screen.end(), initial.screen);
+}
+
+template <std::size_t Lanes, typename DrawSink>
+CH8_BATCH::chip8_batch() : chip8_batch{DrawSink{}}
+{
+}
+
+template <std::size_t Lanes, typename DrawSink>
+CH8_BATCH::chip8_batch(DrawSink sink)
+    : data{}
+    , accurate_8xyE{true}
+    , accurate_8xy6{true}
+    , draw_sink{std::move(sink)}
+    , traps{}
+    , running{}
+    , rng{}
+{
+    traps.fill(trap::none);
+    running.fill(0xFF);
+    for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+        seed(lane, lane);
+    }
+}
+
+template <std::size_t Lanes, typename DrawSink>
+constexpr auto CH8_BATCH::size() noexcept -> std::size_t
+{
+    return Lanes;
+}
+
+template <std::size_t Lanes, typename DrawSink>
+constexpr auto CH8_BATCH::to_mask(const bool value) noexcept -> std::uint8_t
+{
+    return static_cast<std::uint8_t>(0U - static_cast<unsigned>(value));
+}
+
+template <std::size_t Lanes, typename DrawSink>
+template <typename T>
+constexpr auto
+CH8_BATCH::blend(const std::uint8_t mask, const T if_set, const T otherwise)
+    noexcept -> T
+{
+    const auto bits = static_cast<T>(0U - (mask & 1U));
+    return static_cast<T>((if_set & bits) | (otherwise & ~bits));
+}
+
+// Loads the same program into every lane.
+template <std::size_t Lanes, typename DrawSink>
+auto CH8_BATCH::load_program(const std::filesystem::path& program_file)
+    -> load_status
+{
+    auto system = chip8_system{};
+    const auto status = system.load_program(program_file);
+    if (status != load_status::ok) {
+        return status;
+    }
+
+    const auto& program = system.data.ram;
+    for (auto address = std::size_t{chip8_data::program_start};
+         address < program.size(); ++address) {
+        data.ram[address].fill(program.at(address));
+    }
+
+    return load_status::ok;
+}
+
+template <std::size_t Lanes, typename DrawSink>
+auto CH8_BATCH::seed(const std::size_t lane, const std::uint64_t value)
+    -> void
+{
+    rng.at(lane).seed(value);
+}
+
+template <std::size_t Lanes, typename DrawSink>
+auto CH8_BATCH::step() noexcept -> void
+{
+    with_quirks(accurate_8xy6, accurate_8xyE, [this](auto quirk_set) {
+        step<decltype(quirk_set)>();
+    });
+}
+
+template <std::size_t Lanes, typename DrawSink>
+template <typename Quirks>
+auto CH8_BATCH::step() noexcept -> void
+{
+    auto opcodes = lane_array<std::uint16_t>{};
+    auto pending = lane_mask{};
+    const auto fetched_from = data.program_counter;
+    const auto shared_pc = std::size_t{fetched_from[0]};
+
+    auto diverged = 0U;
+    for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+        diverged |= fetched_from[lane] ^ shared_pc;
+    }
+
+    // Lanes at the same address read two contiguous rows of memory.
+    if (diverged == 0 && shared_pc + 1U < data.ram.size()) {
+        const auto& high = data.ram[shared_pc];
+        const auto& low = data.ram[shared_pc + 1U];
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            opcodes[lane] = create_opcode(high[lane], low[lane]);
+        }
+    }
+    else {
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            const auto pc = std::size_t{fetched_from[lane]};
+            const auto high = data.ram[pc & 0xFFFU][lane];
+            const auto low = data.ram[(pc + 1U) & 0xFFFU][lane];
+            opcodes[lane] = create_opcode(high, low);
+        }
+    }
+
+    auto stopped = std::uint8_t{0};
+    for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+        const auto pc = fetched_from[lane];
+        pending[lane] = running[lane] & to_mask(pc + 1U < 0x1000U);
+        stopped |= running[lane] ^ pending[lane];
+        const auto advance = static_cast<std::uint8_t>(
+            pending[lane] & to_mask(!data.waiting_for_keypress[lane]));
+        data.program_counter[lane] += advance & 2U;
+    }
+
+    for (auto lane = std::size_t{0}; stopped != 0 && lane < Lanes; ++lane) {
+        if (running[lane] != pending[lane]) {
+            traps[lane] = trap::pc_out_of_range;
+            running[lane] = 0;
+        }
+    }
+
+    for (auto first = std::size_t{0}; first < Lanes; ++first) {
+        if (pending[first] == 0) {
+            continue;
+        }
+
+        const auto opcode = opcodes[first];
+        auto mask = lane_mask{};
+        auto left = std::uint8_t{0};
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            mask[lane] = pending[lane] & to_mask(opcodes[lane] == opcode);
+            pending[lane] &= static_cast<std::uint8_t>(~mask[lane]);
+            left |= pending[lane];
+        }
+
+        execute<Quirks>(opcode, mask, fetched_from);
+        if (left == 0) {
+            break;
+        }
+    }
+}
+
+template <std::size_t Lanes, typename DrawSink>
+auto CH8_BATCH::run(const std::size_t instruction_count) noexcept -> void
+{
+    with_quirks(
+        accurate_8xy6, accurate_8xyE,
+        [this, instruction_count](auto quirk_set) {
+            for (auto i = std::size_t{0}; i < instruction_count; ++i) {
+                step<decltype(quirk_set)>();
+            }
+        });
+}
+
+template <std::size_t Lanes, typename DrawSink>
+auto CH8_BATCH::update_timers() noexcept -> void
+{
+    for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+        data.delay_timer[lane] -=
+            static_cast<std::uint8_t>(data.delay_timer[lane] > 0);
+        data.sound_timer[lane] -=
+            static_cast<std::uint8_t>(data.sound_timer[lane] > 0);
+    }
+}
+
+template <std::size_t Lanes, typename DrawSink>
+auto CH8_BATCH::lane(const std::size_t index) const -> chip8_data
+{
+    auto lane_data = chip8_data{};
+    lane_data.program_counter = data.program_counter.at(index);
+    lane_data.i_register = data.i_register[index];
+    lane_data.delay_timer = data.delay_timer[index];
+    lane_data.sound_timer = data.sound_timer[index];
+    lane_data.stack_pointer = data.stack_pointer[index];
+    for (auto address = std::size_t{0}; address < data.ram.size(); ++address) {
+        lane_data.ram.at(address) = data.ram[address][index];
+    }
+    for (auto reg = std::size_t{0}; reg < lane_data.registers.size(); ++reg) {
+        lane_data.registers.at(reg) = data.registers.at(reg)[index];
+    }
+    for (auto level = std::size_t{0}; level < lane_data.stack.size(); ++level) {
+        lane_data.stack.at(level) = data.stack.at(level)[index];
+    }
+    lane_data.keypad = std::bitset<16>{data.keypad[index]};
+    lane_data.screen = data.screen[index];
+    lane_data.waiting_for_keypress = data.waiting_for_keypress[index];
+
+    return lane_data;
+}
+
+template <std::size_t Lanes, typename DrawSink>
+auto CH8_BATCH::set_lane(const std::size_t index, const chip8_data& lane_data)
+    -> void
+{
+    data.program_counter.at(index) = lane_data.program_counter;
+    data.i_register[index] = lane_data.i_register;
+    data.delay_timer[index] = lane_data.delay_timer;
+    data.sound_timer[index] = lane_data.sound_timer;
+    data.stack_pointer[index] = lane_data.stack_pointer;
+    for (auto address = std::size_t{0}; address < data.ram.size(); ++address) {
+        data.ram[address][index] = lane_data.ram.at(address);
+    }
+    for (auto reg = std::size_t{0}; reg < lane_data.registers.size(); ++reg) {
+        data.registers.at(reg)[index] = lane_data.registers.at(reg);
+    }
+    for (auto level = std::size_t{0}; level < lane_data.stack.size(); ++level) {
+        data.stack.at(level)[index] = lane_data.stack.at(level);
+    }
+    data.keypad[index] =
+        static_cast<std::uint16_t>(lane_data.keypad.to_ulong());
+    data.screen[index] = lane_data.screen;
+    data.waiting_for_keypress[index] = lane_data.waiting_for_keypress;
+    traps[index] = trap::none;
+    running[index] = 0xFF;
+}
+
+// The trap that stopped a lane, or trap::none while it is still running.
+template <std::size_t Lanes, typename DrawSink>
+auto CH8_BATCH::status(const std::size_t index) const -> trap
+{
+    return traps.at(index);
+}
+
+template <std::size_t Lanes, typename DrawSink>
+template <typename Quirks>
+auto CH8_BATCH::execute(
+    const std::uint16_t opcode, const lane_mask& mask,
+    const lane_array<std::uint16_t>& fetched_from) noexcept -> void
+{
+    const auto x = std::size_t{(opcode & 0x0F00U) >> 8U};
+    const auto y = std::size_t{(opcode & 0x00F0U) >> 4U};
+    const auto kk = static_cast<std::uint8_t>(opcode & 0x00FFU);
+    const auto nnn = static_cast<std::uint16_t>(opcode & 0x0FFFU);
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    auto& vx = data.registers[x];
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    const auto& vy = data.registers[y];
+    auto& pc = data.program_counter;
+
+    const auto fault = [this, &fetched_from](std::size_t lane, trap error) {
+        traps[lane] = error;
+        running[lane] = 0;
+        data.program_counter[lane] = fetched_from[lane];
+    };
+
+    auto condition = lane_mask{};
+    auto known = true;
+
+    switch (opcode >> 12U) {
+    case 0x0:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            if (mask[lane] == 0) {
+                continue;
+            }
+            if (opcode == 0x00E0) {
+                auto& screen = data.screen[lane];
+                screen.mark_clean();
+                screen.clear();
+                draw_sink.notify(lane, screen, screen.dirty());
+            }
+            else if (opcode == 0x00EE) {
+                const auto sp =
+                    static_cast<std::size_t>(data.stack_pointer[lane]);
+                if (sp >= data.stack.size()) {
+                    fault(lane, trap::stack_underflow);
+                    continue;
+                }
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+                pc[lane] = data.stack[sp][lane];
+                --data.stack_pointer[lane];
+            }
+        }
+        break;
+    case 0x1:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            pc[lane] = blend(mask[lane], nnn, pc[lane]);
+        }
+        break;
+    case 0x2:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            if (mask[lane] == 0) {
+                continue;
+            }
+            const auto sp =
+                static_cast<std::size_t>(data.stack_pointer[lane] + 1);
+            if (sp >= data.stack.size()) {
+                fault(lane, trap::stack_overflow);
+                continue;
+            }
+            ++data.stack_pointer[lane];
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+            data.stack[sp][lane] = pc[lane];
+            pc[lane] = nnn;
+        }
+        break;
+    case 0x3:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            condition[lane] = mask[lane] & to_mask(vx[lane] == kk);
+        }
+        skip_if(condition);
+        break;
+    case 0x4:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            condition[lane] = mask[lane] & to_mask(vx[lane] != kk);
+        }
+        skip_if(condition);
+        break;
+    case 0x5:
+        known = (opcode & 0x000FU) == 0;
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            condition[lane] =
+                mask[lane] & to_mask(known && vx[lane] == vy[lane]);
+        }
+        skip_if(condition);
+        break;
+    case 0x6:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            vx[lane] = blend(mask[lane], kk, vx[lane]);
+        }
+        break;
+    case 0x7:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            vx[lane] += mask[lane] & kk;
+        }
+        break;
+    case 0x8:
+        known = execute_row_8<Quirks>(opcode, mask);
+        break;
+    case 0x9:
+        known = (opcode & 0x000FU) == 0;
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            condition[lane] =
+                mask[lane] & to_mask(known && vx[lane] != vy[lane]);
+        }
+        skip_if(condition);
+        break;
+    case 0xA:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            data.i_register[lane] =
+                blend(mask[lane], nnn, data.i_register[lane]);
+        }
+        break;
+    case 0xB:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            const auto target =
+                static_cast<std::uint16_t>(nnn + data.registers[0x0][lane]);
+            pc[lane] = blend(mask[lane], target, pc[lane]);
+        }
+        break;
+    case 0xC:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            if (mask[lane] != 0) {
+                const auto random_number = rng[lane]() >> 24U;
+                vx[lane] = static_cast<std::uint8_t>(kk & random_number);
+            }
+        }
+        break;
+    case 0xD:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            if (mask[lane] != 0) {
+                draw(lane, opcode);
+            }
+        }
+        break;
+    case 0xE: {
+        const auto pressed_skips = kk == 0x9E;
+        known = kk == 0x9E || kk == 0xA1;
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            const auto key = vx[lane] & 0xFU;
+            const auto pressed = ((data.keypad[lane] >> key) & 1U) != 0;
+            condition[lane] =
+                mask[lane] & to_mask(known && pressed == pressed_skips);
+        }
+        skip_if(condition);
+        break;
+    }
+    default:
+        known = execute_row_F(opcode, mask);
+        break;
+    }
+
+    if (!known) {
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            if (mask[lane] != 0) {
+                fault(lane, trap::unknown_opcode);
+            }
+        }
+    }
+}
+
+template <std::size_t Lanes, typename DrawSink>
+template <typename Quirks>
+auto CH8_BATCH::execute_row_8(
+    const std::uint16_t opcode, const lane_mask& mask) noexcept -> bool
+{
+    const auto x = std::size_t{(opcode & 0x0F00U) >> 8U};
+    const auto y = std::size_t{(opcode & 0x00F0U) >> 4U};
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    auto& vx = data.registers[x];
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    const auto& vy = data.registers[y];
+    auto& vf = data.registers[0xF];
+
+    // Each lane writes Vx before VF, like the scalar handlers, so the result
+    // is the same when x or y is F.
+    const auto apply = [&](auto operation) {
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            const auto x_value = vx[lane];
+            const auto y_value = vy[lane];
+            auto result = x_value;
+            auto flag = vf[lane];
+            operation(x_value, y_value, result, flag);
+            vx[lane] = blend(mask[lane], result, x_value);
+            vf[lane] = blend(mask[lane], flag, vf[lane]);
+        }
+    };
+
+    using byte = std::uint8_t;
+    switch (opcode & 0x000FU) {
+    case 0x0:
+        apply([](byte, byte y_value, byte& result, byte&) {
+            result = y_value;
+        });
+        return true;
+    case 0x1:
+        apply([](byte x_value, byte y_value, byte& result, byte&) {
+            result = x_value | y_value;
+        });
+        return true;
+    case 0x2:
+        apply([](byte x_value, byte y_value, byte& result, byte&) {
+            result = x_value & y_value;
+        });
+        return true;
+    case 0x3:
+        apply([](byte x_value, byte y_value, byte& result, byte&) {
+            result = x_value ^ y_value;
+        });
+        return true;
+    case 0x4:
+        apply([](byte x_value, byte y_value, byte& result, byte& flag) {
+            const auto sum = static_cast<unsigned>(x_value + y_value);
+            result = static_cast<byte>(sum);
+            flag = static_cast<byte>(sum > 255);
+        });
+        return true;
+    case 0x5:
+        apply([](byte x_value, byte y_value, byte& result, byte& flag) {
+            result = static_cast<byte>(x_value - y_value);
+            flag = static_cast<byte>(x_value > y_value);
+        });
+        return true;
+    case 0x6:
+        apply([](byte x_value, byte y_value, byte& result, byte& flag) {
+            const auto value = Quirks::accurate_8xy6 ? y_value : x_value;
+            result = static_cast<byte>(value >> 1U);
+            flag = static_cast<byte>(value & 0b00000001U);
+        });
+        return true;
+    case 0x7:
+        apply([](byte x_value, byte y_value, byte& result, byte& flag) {
+            result = static_cast<byte>(y_value - x_value);
+            flag = static_cast<byte>(y_value > x_value);
+        });
+        return true;
+    case 0xE:
+        apply([](byte x_value, byte y_value, byte& result, byte& flag) {
+            const auto value = Quirks::accurate_8xyE ? y_value : x_value;
+            result = static_cast<byte>(value << 1U);
+            flag = static_cast<byte>(value >> 7U);
+        });
+        return true;
+    default:
+        return false;
+    }
+}
+
+template <std::size_t Lanes, typename DrawSink>
+auto CH8_BATCH::execute_row_F(
+    const std::uint16_t opcode, const lane_mask& mask) noexcept -> bool
+{
+    const auto x = std::size_t{(opcode & 0x0F00U) >> 8U};
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    auto& vx = data.registers[x];
+    auto& i = data.i_register;
+
+    const auto ram_at = [this](std::size_t lane, std::size_t address) -> auto& {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        return data.ram[address & 0xFFFU][lane];
+    };
+
+    switch (opcode & 0x00FFU) {
+    case 0x07:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            vx[lane] = blend(mask[lane], data.delay_timer[lane], vx[lane]);
+        }
+        return true;
+    case 0x0A:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            if (mask[lane] != 0) {
+                wait_for_key(lane, x);
+            }
+        }
+        return true;
+    case 0x15:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            data.delay_timer[lane] =
+                blend(mask[lane], vx[lane], data.delay_timer[lane]);
+        }
+        return true;
+    case 0x18:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            data.sound_timer[lane] =
+                blend(mask[lane], vx[lane], data.sound_timer[lane]);
+        }
+        return true;
+    case 0x1E:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            i[lane] += mask[lane] & vx[lane];
+        }
+        return true;
+    case 0x29:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            const auto sprite = static_cast<std::uint16_t>(vx[lane] * 5U);
+            i[lane] = blend(mask[lane], sprite, i[lane]);
+        }
+        return true;
+    case 0x33:
+        for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+            if (mask[lane] != 0) {
+                const auto value = vx[lane];
+                ram_at(lane, i[lane]) = static_cast<std::uint8_t>(value / 100);
+                ram_at(lane, i[lane] + 1U) =
+                    static_cast<std::uint8_t>((value / 10) % 10);
+                ram_at(lane, i[lane] + 2U) =
+                    static_cast<std::uint8_t>(value % 10);
+            }
+        }
+        return true;
+    case 0x55:
+        for (auto reg = std::size_t{0}; reg <= x; ++reg) {
+            const auto& source = data.registers.at(reg);
+            for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+                if (mask[lane] != 0) {
+                    ram_at(lane, i[lane] + reg) = source[lane];
+                }
+            }
+        }
+        return true;
+    case 0x65:
+        for (auto reg = std::size_t{0}; reg <= x; ++reg) {
+            auto& target = data.registers.at(reg);
+            for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+                if (mask[lane] != 0) {
+                    target[lane] = ram_at(lane, i[lane] + reg);
+                }
+            }
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+template <std::size_t Lanes, typename DrawSink>
+auto CH8_BATCH::skip_if(const lane_mask& condition) noexcept -> void
+{
+    for (auto lane = std::size_t{0}; lane < Lanes; ++lane) {
+        data.program_counter[lane] += condition[lane] & 2U;
+    }
+}
+
+template <std::size_t Lanes, typename DrawSink>
+auto CH8_BATCH::draw(
+    const std::size_t lane, const std::uint16_t opcode) noexcept -> void
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    const auto x_pos = data.registers[(opcode & 0x0F00U) >> 8U][lane];
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    const auto y_pos = data.registers[(opcode & 0x00F0U) >> 4U][lane];
+    const auto sprite_size = opcode & 0x000FU;
+    auto& screen = data.screen[lane];
+
+    auto sprite = std::array<std::uint8_t, 15>{};
+    for (auto row = std::size_t{0}; row < sprite_size; ++row) {
+        const auto address = (data.i_register[lane] + row) & 0xFFFU;
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        sprite[row] = data.ram[address][lane];
+    }
+
+    screen.mark_clean();
+    const auto erased_a_pixel =
+        screen.draw_sprite(x_pos, y_pos, {sprite.data(), sprite_size});
+
+    data.registers[0xF][lane] = erased_a_pixel ? 1 : 0;
+    draw_sink.notify(lane, screen, screen.dirty());
+}
+
+template <std::size_t Lanes, typename DrawSink>
+auto CH8_BATCH::wait_for_key(
+    const std::size_t lane, const std::size_t reg) noexcept -> void
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    auto& value = data.registers[reg][lane];
+    auto& keypad = data.keypad[lane];
+
+    if (!data.waiting_for_keypress[lane]) {
+        keypad = 0;
+        value = 0xFF;
+        data.waiting_for_keypress[lane] = true;
+        data.program_counter[lane] -= 2U;
+    }
+    else if (value == 0xFF) {
+        for (auto key = 0U; key < 16U; ++key) {
+            if (((keypad >> key) & 1U) != 0) {
+                value = static_cast<std::uint8_t>(key);
+            }
+        }
+    }
+    else if (((keypad >> (value & 0xFU)) & 1U) == 0) {
+        data.waiting_for_keypress[lane] = false;
+        data.program_counter[lane] += 2U;
+    }
+}
+
+#undef CH8_BATCH
+
+#endif // CH8_BATCH_HPP
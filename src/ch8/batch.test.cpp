@@ -0,0 +1,182 @@
+#include "ch8/batch.hpp"
+#include "ch8/system.hpp"
+#include "ch8/system_state.test.hpp"
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <vector>
+
+constexpr auto batch_workload = std::array<std::uint8_t, 30>{
+    0x30, 0x03, // 200: SE V0, 0x03
+    0x22, 0x10, // 202: CALL 0x210
+    0x70, 0x01, // 204: ADD V0, 0x01
+    0xA3, 0x00, // 206: LD I, 0x300
+    0xF2, 0x33, // 208: LD B, V2
+    0xD0, 0x15, // 20A: DRW V0, V1, 5
+    0x8E, 0x04, // 20C: ADD VE, V0
+    0x12, 0x00, // 20E: JP 0x200
+    0x81, 0x06, // 210: SHR V1, V0
+    0x82, 0x0E, // 212: SHL V2, V0
+    0xF0, 0x29, // 214: LD F, V0
+    0xE0, 0x9E, // 216: SKP V0
+    0x83, 0x17, // 218: SUBN V3, V1
+    0xF3, 0x55, // 21A: LD [I], V3
+    0x00, 0xEE, // 21C: RET
+};
+
+TEST_CASE("chip8_batch lanes match chip8_system when they diverge")
+{
+    constexpr auto lanes = std::size_t{8};
+    const auto instruction_count = GENERATE(1U, 2U, 5U, 40U, 300U);
+    const auto accurate = GENERATE(false, true);
+
+    auto batch = ch8::chip8_batch<lanes>{};
+    batch.accurate_8xy6 = accurate;
+    batch.accurate_8xyE = accurate;
+    auto systems = std::vector<ch8::chip8_system>(lanes);
+
+    for (auto lane = std::size_t{0}; lane < lanes; ++lane) {
+        auto& system = systems.at(lane);
+        load(system, batch_workload);
+        system.accurate_8xy6 = accurate;
+        system.accurate_8xyE = accurate;
+        system.data.registers.at(0x0) = static_cast<std::uint8_t>(lane);
+        system.data.registers.at(0x1) = static_cast<std::uint8_t>(lane * 7U);
+        system.data.keypad.set(lane * 3U % 16U);
+        batch.set_lane(lane, system.data);
+    }
+
+    batch.run(instruction_count);
+    for (auto& system : systems) {
+        system.run(instruction_count);
+    }
+
+    for (auto lane = std::size_t{0}; lane < lanes; ++lane) {
+        REQUIRE(batch.status(lane) == ch8::trap::none);
+        require_same_state(batch.lane(lane), systems.at(lane).data);
+    }
+}
+
+TEST_CASE("chip8_batch stops only the lanes that trap")
+{
+    constexpr auto rom = std::array<std::uint8_t, 6>{
+        0x22, 0x04, // 200: CALL 0x204
+        0x12, 0x02, // 202: JP 0x202
+        0x00, 0xEE, // 204: RET
+    };
+
+    auto batch = ch8::chip8_batch<4>{};
+    for (auto lane = std::size_t{0}; lane < batch.size(); ++lane) {
+        auto lane_data = ch8::chip8_data{};
+        std::copy(
+            rom.begin(), rom.end(),
+            lane_data.ram.begin() + ch8::chip8_data::program_start);
+        batch.set_lane(lane, lane_data);
+    }
+    batch.data.stack_pointer[1] = 15;
+    batch.data.program_counter[2] = 0x204;
+
+    batch.run(3);
+
+    REQUIRE(batch.status(0) == ch8::trap::none);
+    REQUIRE(batch.status(1) == ch8::trap::stack_overflow);
+    REQUIRE(batch.status(2) == ch8::trap::stack_underflow);
+    REQUIRE(batch.status(3) == ch8::trap::none);
+    REQUIRE(batch.lane(0).program_counter == 0x202);
+    REQUIRE(batch.lane(1).program_counter == 0x200);
+    REQUIRE(batch.lane(2).program_counter == 0x204);
+    REQUIRE(batch.lane(3).program_counter == 0x202);
+
+    batch.set_lane(1, batch.lane(3));
+    REQUIRE(batch.status(1) == ch8::trap::none);
+}
+
+TEST_CASE("chip8_batch traps on 5xyN and 9xyN unless N is 0")
+{
+    const auto [opcode, status, pc] =
+        GENERATE(table<std::uint16_t, ch8::trap, std::uint16_t>({
+            {0x5120, ch8::trap::none, 0x204},
+            {0x9120, ch8::trap::none, 0x202},
+            {0x5121, ch8::trap::unknown_opcode, 0x200},
+            {0x912F, ch8::trap::unknown_opcode, 0x200},
+        }));
+
+    auto lane_data = ch8::chip8_data{};
+    lane_data.ram.at(0x200) = static_cast<std::uint8_t>(opcode >> 8U);
+    lane_data.ram.at(0x201) = static_cast<std::uint8_t>(opcode & 0xFFU);
+    auto batch = ch8::chip8_batch<2>{};
+    batch.set_lane(0, lane_data);
+    batch.set_lane(1, lane_data);
+
+    batch.run(1);
+
+    for (auto lane = std::size_t{0}; lane < batch.size(); ++lane) {
+        REQUIRE(batch.status(lane) == status);
+        REQUIRE(batch.lane(lane).program_counter == pc);
+    }
+}
+
+TEST_CASE("chip8_batch draws random numbers from each lane's seed")
+{
+    auto first = ch8::chip8_batch<2>{};
+    auto second = ch8::chip8_batch<2>{};
+    for (auto* batch : {&first, &second}) {
+        for (auto lane = std::size_t{0}; lane < batch->size(); ++lane) {
+            batch->data.ram.at(0x200).at(lane) = 0xC0;
+            batch->data.ram.at(0x201).at(lane) = 0x0F;
+            batch->seed(lane, 1234);
+        }
+    }
+    second.seed(1, 99);
+
+    first.step();
+    second.step();
+
+    REQUIRE(first.data.registers[0][0] == second.data.registers[0][0]);
+    REQUIRE(first.data.registers[0][0] == first.data.registers[0][1]);
+    REQUIRE(first.data.registers[0][0] <= 0x0F);
+}
+
+TEST_CASE("chip8_batch::update_timers counts every lane down to zero")
+{
+    auto batch = ch8::chip8_batch<3>{};
+    batch.data.delay_timer = {0, 1, 5};
+    batch.data.sound_timer = {2, 0, 1};
+
+    batch.update_timers();
+
+    REQUIRE(batch.data.delay_timer == std::array<std::uint8_t, 3>{0, 0, 4});
+    REQUIRE(batch.data.sound_timer == std::array<std::uint8_t, 3>{1, 0, 0});
+}
+
+TEST_CASE("chip8_batch notifies its draw sink after 00E0 and Dxyn")
+{
+    struct draw {
+        std::size_t lane;
+        ch8::screen_region changed;
+    };
+    auto draws = std::vector<draw>{};
+    auto sink = ch8::static_observable{
+        [&draws](std::size_t lane, const auto&, const auto& changed) {
+            draws.push_back({lane, changed});
+        }};
+
+    auto batch = ch8::chip8_batch<2, decltype(sink)>{sink};
+    for (auto lane = std::size_t{0}; lane < batch.size(); ++lane) {
+        batch.data.ram.at(0x200).at(lane) = 0xD0; // DRW V0, V1, 5
+        batch.data.ram.at(0x201).at(lane) = 0x15;
+        batch.data.ram.at(0x202).at(lane) = 0x00; // CLS
+        batch.data.ram.at(0x203).at(lane) = 0xE0;
+    }
+    batch.data.registers[0][1] = 8;
+
+    batch.run(2);
+
+    REQUIRE(draws.size() == 4);
+    REQUIRE(draws[0].lane == 0);
+    REQUIRE(draws[0].changed == ch8::screen_region{0, 0, 8, 5});
+    REQUIRE(draws[1].lane == 1);
+    REQUIRE(draws[1].changed == ch8::screen_region{8, 0, 8, 5});
+    REQUIRE(draws[2].changed == ch8::screen_region{0, 0, 64, 32});
+    REQUIRE(draws[3].changed == ch8::screen_region{0, 0, 64, 32});
+}
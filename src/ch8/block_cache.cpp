@@ -0,0 +1,298 @@
+#include "ch8/block_cache.hpp"
+#include "ch8/system.hpp"
+#include <algorithm>
+
+[[nodiscard]] constexpr auto ends_block(const std::uint16_t opcode) noexcept
+    -> bool
+{
+    switch (opcode & 0xF000U) {
+    case 0x0000:
+        return opcode == 0x00EE;
+    case 0x1000:
+    case 0x2000:
+    case 0x3000:
+    case 0x4000:
+    case 0x5000:
+    case 0x9000:
+    case 0xB000:
+    case 0xE000:
+        return true;
+    case 0xF000:
+        switch (opcode & 0x00FFU) {
+        case 0x000A:
+        case 0x0033:
+        case 0x0055:
+            return true;
+        default:
+            return false;
+        }
+    default:
+        return false;
+    }
+}
+
+[[nodiscard]] constexpr auto length_of(const ch8::fusion kind) noexcept
+    -> std::size_t
+{
+    return kind == ch8::fusion::none ? 1U : 2U;
+}
+
+// 3xkk and 4xkk leave the registers alone, so whether a fused skip and jump
+// took the skip can be worked out after it ran.
+[[nodiscard]] constexpr auto
+skip_taken(const ch8::chip8_data& data, const std::uint16_t opcode) noexcept
+    -> bool
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    const auto value = data.registers[(opcode & 0x0F00U) >> 8U];
+    const auto equal = value == (opcode & 0x00FFU);
+
+    return (opcode & 0xF000U) == 0x3000U ? equal : !equal;
+}
+
+auto ch8::block_cache::statistics::hit_rate() const noexcept -> double
+{
+    const auto lookups = hits + misses;
+    if (lookups == 0) {
+        return 0.0;
+    }
+
+    return static_cast<double>(hits) / static_cast<double>(lookups);
+}
+
+ch8::block_cache::block_cache() noexcept : blocks{}, cache_stats{0, 0, 0, {}}
+{
+}
+
+auto ch8::block_cache::run(
+    chip8_system& system, const std::size_t instruction_count) -> trap
+{
+    auto& data = system.data;
+
+    if (blocks.empty()) {
+        blocks.resize(data.ram.size());
+    }
+
+    const auto* table = &system.active_instructions();
+
+    auto remaining = instruction_count;
+    while (remaining > 0) {
+        const auto start = std::size_t{data.program_counter};
+
+        if (start + 1U >= data.ram.size()) {
+            const auto result = system.step();
+            if (result != trap::none) {
+                return result;
+            }
+            --remaining;
+            continue;
+        }
+
+        auto* entry = &blocks[start];
+        const auto cached = !entry->code.empty();
+        if (cached && entry->table == table &&
+            std::equal(
+                entry->source.begin(), entry->source.end(),
+                data.ram.begin() + start)) {
+            ++cache_stats.hits;
+        }
+        else {
+            if (cached) {
+                ++cache_stats.invalidations;
+            }
+            ++cache_stats.misses;
+            entry = &build(system, start);
+        }
+
+        // A block that doesn't fit runs up to the last whole entry, and a
+        // fused pair that doesn't fit is stepped through one at a time.
+        const auto whole = entry->instructions <= remaining;
+        auto length = entry->code.size();
+        auto executed = entry->instructions;
+        if (!whole) {
+            length = 0;
+            executed = 0;
+            while (executed + length_of(entry->code[length].kind) <=
+                   remaining) {
+                executed += length_of(entry->code[length].kind);
+                ++length;
+            }
+        }
+
+        if (length == 0) {
+            const auto result = system.step();
+            if (result != trap::none) {
+                return result;
+            }
+            --remaining;
+            continue;
+        }
+
+        const auto stores = entry->ends_in_store && whole;
+        const auto straight_line = stores ? length - 1 : length;
+
+        for (auto i = std::size_t{0}; i < straight_line; ++i) {
+            const auto& decoded = entry->code[i];
+            const auto pc = data.program_counter;
+            if (!data.waiting_for_keypress) {
+                data.program_counter += 2;
+            }
+
+            const auto result = decoded.op(system, decoded.opcode);
+            if (result != trap::none) {
+                data.program_counter = pc;
+                return result;
+            }
+        }
+
+        if (stores) {
+            const auto& decoded = entry->code.back();
+            const auto first = std::size_t{data.i_register};
+            const auto last =
+                last_written_address(data.i_register, decoded.opcode);
+
+            if (!data.waiting_for_keypress) {
+                data.program_counter += 2;
+            }
+            decoded.op(system, decoded.opcode);
+
+            invalidate(first, last);
+        }
+
+        if (whole) {
+            for (auto kind = std::size_t{1}; kind < fusion_kinds; ++kind) {
+                cache_stats.fusions[kind] += entry->fusions[kind];
+            }
+            if (entry->ends_in_skip &&
+                skip_taken(data, entry->code.back().opcode)) {
+                --executed;
+            }
+        }
+        else {
+            for (auto i = std::size_t{0}; i < length; ++i) {
+                const auto kind = entry->code[i].kind;
+                if (kind != fusion::none) {
+                    ++cache_stats.fusions[static_cast<std::size_t>(kind)];
+                }
+            }
+        }
+
+        remaining -= executed;
+    }
+
+    return trap::none;
+}
+
+auto ch8::block_cache::invalidate(
+    const std::size_t first, const std::size_t last) noexcept -> void
+{
+    if (blocks.empty()) {
+        return;
+    }
+
+    // Stores through I wrap around the end of memory.
+    const auto size = blocks.size();
+    if (first >= size || last >= size) {
+        const auto wrapped_first = first % size;
+        const auto wrapped_last = last % size;
+        if (wrapped_first <= wrapped_last) {
+            invalidate(wrapped_first, wrapped_last);
+        }
+        else {
+            invalidate(wrapped_first, size - 1U);
+            invalidate(0, wrapped_last);
+        }
+        return;
+    }
+
+    const auto reach = max_block_length * 2U - 1U;
+    const auto begin = first > reach ? first - reach : std::size_t{0};
+    const auto end = last + 1U;
+
+    for (auto start = begin; start < end; ++start) {
+        auto& entry = blocks[start];
+        if (!entry.code.empty() && start + entry.source.size() > first) {
+            entry.code.clear();
+            entry.source.clear();
+            ++cache_stats.invalidations;
+        }
+    }
+}
+
+auto ch8::block_cache::clear() noexcept -> void
+{
+    for (auto& entry : blocks) {
+        entry.code.clear();
+        entry.source.clear();
+    }
+}
+
+auto ch8::block_cache::stats() const noexcept -> const statistics&
+{
+    return cache_stats;
+}
+
+auto ch8::block_cache::build(
+    const chip8_system& system, const std::size_t start) -> block&
+{
+    const auto& ram = system.data.ram;
+    auto& entry = blocks[start];
+    entry.code.clear();
+    entry.source.clear();
+    entry.table = &system.active_instructions();
+
+    entry.instructions = 0;
+    entry.fusions = {};
+    entry.ends_in_skip = false;
+
+    auto address = start;
+    while (entry.instructions < max_block_length &&
+           address + 1U < ram.size()) {
+        const auto byte1 = ram[address];
+        const auto byte2 = ram[address + 1U];
+        const auto opcode = create_opcode(byte1, byte2);
+
+        if (entry.instructions + 2U <= max_block_length &&
+            address + 3U < ram.size()) {
+            const auto byte3 = ram[address + 2U];
+            const auto byte4 = ram[address + 3U];
+            const auto second = create_opcode(byte3, byte4);
+            const auto kind = fusion_of(opcode, second);
+
+            if (kind != fusion::none) {
+                const auto op = chip8_system::fused_instruction(kind);
+                entry.code.push_back({op, opcode, kind});
+                entry.source.insert(
+                    entry.source.end(), {byte1, byte2, byte3, byte4});
+                entry.instructions += 2U;
+                ++entry.fusions[static_cast<std::size_t>(kind)];
+                address += 4U;
+
+                if (ends_block(second)) {
+                    entry.ends_in_skip = kind == fusion::skip_and_jump;
+                    break;
+                }
+                continue;
+            }
+        }
+
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        const auto op = (*entry.table)[opcode >> 12U][byte2];
+
+        entry.code.push_back({op, opcode, fusion::none});
+        entry.source.push_back(byte1);
+        entry.source.push_back(byte2);
+        entry.instructions += 1U;
+        address += 2U;
+
+        if (ends_block(opcode)) {
+            break;
+        }
+    }
+
+    const auto& last = entry.code.back();
+    entry.ends_in_store =
+        last.kind == fusion::none && writes_memory(last.opcode);
+
+    return entry;
+}
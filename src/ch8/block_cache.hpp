@@ -0,0 +1,58 @@
+#ifndef CH8_BLOCK_CACHE_HPP
+#define CH8_BLOCK_CACHE_HPP
+
+#include "ch8/instruction.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ch8 {
+    class block_cache {
+    public:
+        struct statistics {
+            [[nodiscard]] auto hit_rate() const noexcept -> double;
+
+            std::uint64_t hits;
+            std::uint64_t misses;
+            std::uint64_t invalidations;
+            // Indexed by fusion, counting each fused pair that ran.
+            std::array<std::uint64_t, fusion_kinds> fusions;
+        };
+
+        // In instructions, counting both halves of a fused pair.
+        static constexpr auto max_block_length = std::size_t{64};
+
+        block_cache() noexcept;
+
+        auto run(chip8_system& system, std::size_t instruction_count) -> trap;
+        auto invalidate(std::size_t first, std::size_t last) noexcept -> void;
+        auto clear() noexcept -> void;
+
+        [[nodiscard]] auto stats() const noexcept -> const statistics&;
+
+    private:
+        struct decoded_instruction {
+            instruction op;
+            std::uint16_t opcode;
+            fusion kind;
+        };
+
+        struct block {
+            std::vector<std::uint8_t> source;
+            std::vector<decoded_instruction> code;
+            const instruction_table* table;
+            std::size_t instructions;
+            std::array<std::uint8_t, fusion_kinds> fusions;
+            bool ends_in_store;
+            bool ends_in_skip;
+        };
+
+        auto build(const chip8_system& system, std::size_t start) -> block&;
+
+        std::vector<block> blocks;
+        statistics cache_stats;
+    };
+} // namespace ch8
+
+#endif // CH8_BLOCK_CACHE_HPP
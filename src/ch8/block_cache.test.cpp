@@ -0,0 +1,307 @@
+#include "ch8/block_cache.hpp"
+#include "ch8/system.hpp"
+#include "ch8/system_state.test.hpp"
+#include <algorithm>
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+
+constexpr auto counting_loop = std::array<std::uint8_t, 20>{
+    0x60, 0x00, // 200: LD V0, 0x00
+    0x70, 0x01, // 202: ADD V0, 0x01
+    0x81, 0x04, // 204: ADD V1, V0
+    0x82, 0x16, // 206: SHR V2, V1
+    0x22, 0x10, // 208: CALL 0x210
+    0x30, 0x40, // 20A: SE V0, 0x40
+    0x12, 0x02, // 20C: JP 0x202
+    0x12, 0x0E, // 20E: JP 0x20E
+    0xA3, 0x00, // 210: LD I, 0x300
+    0xF2, 0x33, // 212: LD B, V2
+};
+
+constexpr auto counting_loop_return = std::array<std::uint8_t, 2>{
+    0x00, 0xEE, // 214: RET
+};
+
+TEST_CASE("block_cache::run leaves chip8_data in the same state as step()")
+{
+    const auto instruction_count = GENERATE(1U, 7U, 64U, 500U);
+
+    auto stepped = ch8::chip8_system{};
+    auto cached = ch8::chip8_system{};
+    auto cache = ch8::block_cache{};
+
+    for (auto* system : {&stepped, &cached}) {
+        load(*system, counting_loop);
+        std::copy(
+            counting_loop_return.begin(), counting_loop_return.end(),
+            system->data.ram.begin() + 0x214);
+    }
+
+    for (auto i = 0U; i < instruction_count; ++i) {
+        stepped.step();
+    }
+    cache.run(cached, instruction_count);
+
+    require_same_state(cached.data, stepped.data);
+}
+
+TEST_CASE("block_cache::run executes code written to ram by the host")
+{
+    constexpr auto rom = std::array<std::uint8_t, 4>{
+        0x60, 0x05, // 200: LD V0, 0x05
+        0x12, 0x00, // 202: JP 0x200
+    };
+
+    auto system = ch8::chip8_system{};
+    auto cache = ch8::block_cache{};
+    load(system, rom);
+
+    cache.run(system, 4);
+    REQUIRE(system.data.registers.at(0) == 0x05);
+
+    system.data.ram.at(0x201) = 0x07;
+    cache.run(system, 1);
+
+    REQUIRE(system.data.registers.at(0) == 0x07);
+    REQUIRE(cache.stats().invalidations == 1);
+}
+
+TEST_CASE("block_cache::run executes code rewritten by Fx55")
+{
+    constexpr auto rom = std::array<std::uint8_t, 20>{
+        0x60, 0x60, // 200: LD V0, 0x60
+        0x61, 0x2A, // 202: LD V1, 0x2A
+        0x22, 0x0E, // 204: CALL 0x20E
+        0xA2, 0x0E, // 206: LD I, 0x20E
+        0xF1, 0x55, // 208: LD [I], V1
+        0x22, 0x0E, // 20A: CALL 0x20E
+        0x12, 0x0C, // 20C: JP 0x20C
+        0x63, 0x00, // 20E: LD V3, 0x00
+        0x00, 0xEE, // 210: RET
+    };
+
+    auto stepped = ch8::chip8_system{};
+    auto cached = ch8::chip8_system{};
+    auto cache = ch8::block_cache{};
+    load(stepped, rom);
+    load(cached, rom);
+
+    for (auto i = 0; i < 12; ++i) {
+        stepped.step();
+    }
+    cache.run(cached, 12);
+
+    REQUIRE(cached.data.registers.at(0) == 0x2A);
+    REQUIRE(cache.stats().invalidations > 0);
+    require_same_state(cached.data, stepped.data);
+}
+
+TEST_CASE("block_cache::run executes code rewritten by Fx33")
+{
+    constexpr auto rom = std::array<std::uint8_t, 16>{
+        0x60, 0x03, // 200: LD V0, 0x03
+        0xA2, 0x0E, // 202: LD I, 0x20E
+        0x22, 0x0C, // 204: CALL 0x20C
+        0xF0, 0x33, // 206: LD B, V0
+        0x22, 0x0C, // 208: CALL 0x20C
+        0x12, 0x0A, // 20A: JP 0x20A
+        0x00, 0xEE, // 20C: RET
+        0x00, 0x00, // 20E: data
+    };
+
+    auto stepped = ch8::chip8_system{};
+    auto cached = ch8::chip8_system{};
+    auto cache = ch8::block_cache{};
+    load(stepped, rom);
+    load(cached, rom);
+
+    for (auto i = 0; i < 12; ++i) {
+        stepped.step();
+    }
+    cache.run(cached, 12);
+
+    require_same_state(cached.data, stepped.data);
+}
+
+TEST_CASE("block_cache::run waits on Fx0A the same way as step()")
+{
+    constexpr auto rom = std::array<std::uint8_t, 6>{
+        0xF3, 0x0A, // 200: LD V3, K
+        0x70, 0x01, // 202: ADD V0, 0x01
+        0x12, 0x02, // 204: JP 0x202
+    };
+
+    auto stepped = ch8::chip8_system{};
+    auto cached = ch8::chip8_system{};
+    auto cache = ch8::block_cache{};
+    load(stepped, rom);
+    load(cached, rom);
+
+    for (auto i = 0; i < 5; ++i) {
+        stepped.step();
+    }
+    cache.run(cached, 5);
+    require_same_state(cached.data, stepped.data);
+
+    stepped.data.keypad.set(0x4);
+    cached.data.keypad.set(0x4);
+    stepped.step();
+    cache.run(cached, 1);
+    require_same_state(cached.data, stepped.data);
+
+    stepped.data.keypad.reset();
+    cached.data.keypad.reset();
+    for (auto i = 0; i < 5; ++i) {
+        stepped.step();
+    }
+    cache.run(cached, 5);
+    require_same_state(cached.data, stepped.data);
+}
+
+TEST_CASE("block_cache::stats reports cache hits for a tight loop")
+{
+    constexpr auto rom = std::array<std::uint8_t, 4>{
+        0x70, 0x01, // 200: ADD V0, 0x01
+        0x12, 0x00, // 202: JP 0x200
+    };
+
+    auto system = ch8::chip8_system{};
+    auto cache = ch8::block_cache{};
+    load(system, rom);
+
+    cache.run(system, 200);
+
+    REQUIRE(cache.stats().misses == 1);
+    REQUIRE(cache.stats().hits == 99);
+    REQUIRE(cache.stats().hit_rate() == Approx(0.99));
+}
+
+TEST_CASE("block_cache::statistics::hit_rate is 0 before any lookups")
+{
+    const auto cache = ch8::block_cache{};
+    REQUIRE(cache.stats().hit_rate() == 0.0);
+}
+
+TEST_CASE("block_cache::invalidate drops blocks overlapping the range")
+{
+    constexpr auto rom = std::array<std::uint8_t, 6>{
+        0x70, 0x01, // 200: ADD V0, 0x01
+        0x71, 0x01, // 202: ADD V1, 0x01
+        0x12, 0x00, // 204: JP 0x200
+    };
+
+    auto system = ch8::chip8_system{};
+    auto cache = ch8::block_cache{};
+    load(system, rom);
+
+    cache.run(system, 3);
+    cache.invalidate(0x203, 0x203);
+    cache.run(system, 3);
+
+    REQUIRE(cache.stats().misses == 2);
+    REQUIRE(cache.stats().invalidations == 1);
+}
+
+TEST_CASE("chip8_system::execute uses the block cache for the cached engine")
+{
+    auto system = ch8::chip8_system{};
+    system.engine = ch8::execution_engine::cached;
+    system.updates_per_second = 1000;
+
+    system.execute(std::chrono::milliseconds{1});
+
+    REQUIRE(system.cache_stats().misses == 1);
+    REQUIRE(system.data.program_counter == 0x202);
+}
+
+TEST_CASE("chip8_system::execute does not use the block cache by default")
+{
+    auto system = ch8::chip8_system{};
+    system.updates_per_second = 1000;
+
+    system.execute(std::chrono::milliseconds{1});
+
+    REQUIRE(system.cache_stats().misses == 0);
+    REQUIRE(system.data.program_counter == 0x202);
+}
+
+constexpr auto fusion_workload = std::array<std::uint8_t, 24>{
+    0x60, 0x05, // 200: LD V0, 0x05
+    0x61, 0x03, // 202: LD V1, 0x03
+    0xA0, 0x00, // 204: LD I, 0x000
+    0xD0, 0x15, // 206: DRW V0, V1, 5
+    0x72, 0x01, // 208: ADD V2, 0x01
+    0xA3, 0x00, // 20A: LD I, 0x300
+    0xF2, 0x1E, // 20C: ADD I, V2
+    0xF1, 0x65, // 20E: LD V1, [I]
+    0x42, 0x10, // 210: SNE V2, 0x10
+    0x12, 0x16, // 212: JP 0x216
+    0x12, 0x02, // 214: JP 0x202
+    0x12, 0x00, // 216: JP 0x200
+};
+
+TEST_CASE("block_cache::run fuses common pairs and matches step()")
+{
+    const auto instruction_count = GENERATE(1U, 2U, 3U, 7U, 64U, 5000U);
+    const auto slice = GENERATE(1U, 3U, 64U);
+
+    auto stepped = ch8::chip8_system{};
+    auto cached = ch8::chip8_system{};
+    auto cache = ch8::block_cache{};
+    load(stepped, fusion_workload);
+    load(cached, fusion_workload);
+
+    for (auto i = 0U; i < instruction_count; ++i) {
+        stepped.step();
+    }
+    for (auto done = 0U; done < instruction_count; done += slice) {
+        cache.run(cached, std::min(slice, instruction_count - done));
+    }
+
+    require_same_state(cached.data, stepped.data);
+}
+
+TEST_CASE("block_cache::stats counts each kind of fused pair")
+{
+    auto system = ch8::chip8_system{};
+    auto cache = ch8::block_cache{};
+    load(system, fusion_workload);
+
+    cache.run(system, 5000);
+
+    const auto& fusions = cache.stats().fusions;
+    for (const auto kind :
+         {ch8::fusion::load_and_draw, ch8::fusion::load_pair,
+          ch8::fusion::skip_and_jump, ch8::fusion::add_and_load}) {
+        REQUIRE(fusions.at(static_cast<std::size_t>(kind)) > 0);
+    }
+    REQUIRE(fusions.at(static_cast<std::size_t>(ch8::fusion::none)) == 0);
+}
+
+TEST_CASE("block_cache::run executes a fused pair rewritten by Fx55")
+{
+    constexpr auto rom = std::array<std::uint8_t, 12>{
+        0x61, 0x02, // 200: LD V1, 0x02
+        0x63, 0x07, // 202: LD V3, 0x07
+        0x70, 0x01, // 204: ADD V0, 0x01
+        0xA2, 0x03, // 206: LD I, 0x203
+        0xF0, 0x55, // 208: LD [I], V0
+        0x12, 0x00, // 20A: JP 0x200
+    };
+
+    auto stepped = ch8::chip8_system{};
+    auto cached = ch8::chip8_system{};
+    auto cache = ch8::block_cache{};
+    load(stepped, rom);
+    load(cached, rom);
+
+    for (auto i = 0; i < 600; ++i) {
+        stepped.step();
+    }
+    cache.run(cached, 600);
+
+    REQUIRE(cached.data.registers.at(3) == 99);
+    REQUIRE(cache.stats().invalidations > 0);
+    require_same_state(cached.data, stepped.data);
+}
@@ -0,0 +1,29 @@
+#ifndef CH8_COLOR_HPP
+#define CH8_COLOR_HPP
+
+#include <cstdint>
+
+namespace ch8 {
+    struct color {
+        constexpr auto operator==(const color& other) const noexcept -> bool;
+        constexpr auto operator!=(const color& other) const noexcept -> bool;
+
+        std::uint8_t r;
+        std::uint8_t g;
+        std::uint8_t b;
+        std::uint8_t a;
+    };
+} // namespace ch8
+
+constexpr auto ch8::color::operator==(const color& other) const noexcept -> bool
+{
+    return this->r == other.r && this->g == other.g && this->b == other.b &&
+           this->a == other.a;
+}
+
+constexpr auto ch8::color::operator!=(const color& other) const noexcept -> bool
+{
+    return !(*this == other);
+}
+
+#endif // CH8_COLOR_HPP
@@ -0,0 +1,313 @@
+#include "ch8/executor.hpp"
+#include <algorithm>
+#include <iterator>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+    constexpr auto frames_per_second = std::size_t{60};
+
+    // Lets a job submitted from a worker's callback go on that worker's own
+    // queue instead of a round-robin pick.
+    thread_local const ch8::executor* current_executor = nullptr;
+    thread_local std::size_t current_worker = 0;
+
+    // The CPUs this process may run on, which inside a cpuset or container
+    // is not simply the first hardware_concurrency() of them.
+    auto allowed_cpus() -> std::vector<std::size_t>
+    {
+        auto cpus = std::vector<std::size_t>{};
+#if defined(__linux__)
+        auto allowed = cpu_set_t{};
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+            return cpus;
+        }
+        for (auto cpu = std::size_t{0}; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+#endif
+        return cpus;
+    }
+
+    auto pin_to_cpu(
+        [[maybe_unused]] std::thread& thread, [[maybe_unused]] std::size_t cpu)
+        -> bool
+    {
+#if defined(__linux__)
+        auto cpus = cpu_set_t{};
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        return pthread_setaffinity_np(
+                   thread.native_handle(), sizeof(cpus), &cpus) == 0;
+#else
+        return false;
+#endif
+    }
+} // namespace
+
+ch8::executor::executor(std::size_t worker_count, bool pin)
+    : workers{}
+    , next_worker{0}
+    , queued{0}
+    , unfinished{0}
+    , stopping{false}
+    , pinned_workers{false}
+    , sleep_mutex{}
+    , wake{}
+    , idle{}
+{
+    if (worker_count == 0) {
+        worker_count = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    workers.reserve(worker_count);
+    for (auto i = std::size_t{0}; i < worker_count; ++i) {
+        workers.push_back(std::make_unique<worker>());
+    }
+
+    const auto cpus = pin ? allowed_cpus() : std::vector<std::size_t>{};
+    pinned_workers = !cpus.empty();
+    for (auto i = std::size_t{0}; i < worker_count; ++i) {
+        workers[i]->thread = std::thread{[this, i] { work(i); }};
+        if (!cpus.empty()) {
+            pinned_workers =
+                pin_to_cpu(workers[i]->thread, cpus[i % cpus.size()]) &&
+                pinned_workers;
+        }
+    }
+}
+
+ch8::executor::~executor()
+{
+    {
+        const auto lock = std::lock_guard{sleep_mutex};
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto& w : workers) {
+        w->thread.join();
+    }
+}
+
+auto ch8::executor::submit(job work) -> std::future<result>
+{
+    auto promise = std::make_shared<std::promise<result>>();
+    auto future = promise->get_future();
+    submit(
+        std::move(work),
+        [promise](result done) { promise->set_value(std::move(done)); },
+        [promise](std::exception_ptr error) {
+            promise->set_exception(std::move(error));
+        });
+    return future;
+}
+
+auto ch8::executor::submit(job work, callback done, error_callback failed)
+    -> void
+{
+    const auto index = current_executor == this
+                           ? current_worker
+                           : next_worker++ % workers.size();
+
+    // Counted before the push so a thief never sees more jobs than queued.
+    {
+        const auto lock = std::lock_guard{sleep_mutex};
+        ++queued;
+        ++unfinished;
+    }
+
+    {
+        auto& target = *workers[index];
+        const auto lock = std::lock_guard{target.mutex};
+        target.tasks.push_back(
+            {std::move(work), std::move(done), std::move(failed)});
+    }
+    wake.notify_one();
+}
+
+auto ch8::executor::wait_idle() -> void
+{
+    auto lock = std::unique_lock{sleep_mutex};
+    idle.wait(lock, [this] { return unfinished == 0; });
+}
+
+auto ch8::executor::worker_count() const noexcept -> std::size_t
+{
+    return workers.size();
+}
+
+auto ch8::executor::pinned() const noexcept -> bool
+{
+    return pinned_workers;
+}
+
+// Runs work on system from a clean reset, one 60 Hz frame at a time. Input
+// events split a frame so they land before the instruction they name.
+auto ch8::executor::run(chip8_system& system, const job& work) -> result
+{
+    system.reset();
+    system.updates_per_second = work.updates_per_second;
+    system.accurate_8xyE = work.accurate_8xyE;
+    system.accurate_8xy6 = work.accurate_8xy6;
+    system.skip_idle_loops = work.skip_idle_loops;
+    system.engine = work.engine;
+    system.seed(work.seed, work.random);
+
+    auto outcome = result{};
+    outcome.status = trap::none;
+    outcome.load = load_status::ok;
+    outcome.instructions = 0;
+    outcome.frames = 0;
+
+    const auto max_size = system.data.ram.size() - chip8_data::program_start;
+    if (work.program.size() > max_size) {
+        outcome.load = load_status::file_too_big;
+        outcome.data = system.data;
+        return outcome;
+    }
+    std::copy(
+        work.program.begin(), work.program.end(),
+        std::next(system.data.ram.begin(), chip8_data::program_start));
+
+    const auto updates =
+        static_cast<std::size_t>(std::max(work.updates_per_second, 1));
+    auto input = work.inputs.begin();
+    auto& executed = outcome.instructions;
+
+    while (executed < work.instruction_budget) {
+        const auto full_frame_end =
+            (outcome.frames + 1) * updates / frames_per_second;
+        const auto frame_end =
+            std::min(work.instruction_budget, full_frame_end);
+
+        while (executed < frame_end) {
+            for (; input != work.inputs.end() &&
+                   input->at_instruction <= executed;
+                 ++input) {
+                system.data.keypad.set(input->key & 0xFU, input->pressed);
+            }
+
+            auto slice_end = frame_end;
+            if (input != work.inputs.end()) {
+                slice_end = std::min(slice_end, input->at_instruction);
+            }
+
+            outcome.status = system.run(slice_end - executed);
+            if (outcome.status != trap::none) {
+                outcome.data = system.data;
+                return outcome;
+            }
+            executed = slice_end;
+        }
+
+        if (frame_end < full_frame_end) {
+            break;
+        }
+
+        system.update_timers();
+        ++outcome.frames;
+        if (work.stop_condition && work.stop_condition(system.data)) {
+            break;
+        }
+    }
+
+    outcome.data = system.data;
+    return outcome;
+}
+
+auto ch8::executor::work(const std::size_t index) -> void
+{
+    current_executor = this;
+    current_worker = index;
+
+    auto& self = *workers[index];
+    auto next = task{};
+
+    while (true) {
+        if (pop(index, next) || steal(index, next)) {
+            complete(self.system, next);
+            next = task{};
+            finish();
+            continue;
+        }
+
+        auto lock = std::unique_lock{sleep_mutex};
+        wake.wait(lock, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
+
+// An exception leaving a worker would end the process, and with it any hope
+// of wait_idle() returning, so every one stops here.
+auto ch8::executor::complete(chip8_system& system, task& next) noexcept
+    -> void
+{
+    auto error = std::exception_ptr{};
+    try {
+        next.done(run(system, next.work));
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+
+    if (error && next.failed) {
+        try {
+            next.failed(error);
+        }
+        catch (...) {
+        }
+    }
+}
+
+// The owner takes its newest job, which is the one most likely to still be
+// in cache, while thieves take the oldest.
+auto ch8::executor::pop(const std::size_t index, task& next) -> bool
+{
+    auto& self = *workers[index];
+    const auto lock = std::lock_guard{self.mutex};
+    if (self.tasks.empty()) {
+        return false;
+    }
+
+    next = std::move(self.tasks.back());
+    self.tasks.pop_back();
+    --queued;
+    return true;
+}
+
+auto ch8::executor::steal(const std::size_t index, task& next) -> bool
+{
+    for (auto offset = std::size_t{1}; offset < workers.size(); ++offset) {
+        auto& victim = *workers[(index + offset) % workers.size()];
+        const auto lock = std::lock_guard{victim.mutex};
+        if (victim.tasks.empty()) {
+            continue;
+        }
+
+        next = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        --queued;
+        return true;
+    }
+    return false;
+}
+
+auto ch8::executor::finish() -> void
+{
+    auto now_idle = false;
+    {
+        const auto lock = std::lock_guard{sleep_mutex};
+        now_idle = --unfinished == 0;
+    }
+    if (now_idle) {
+        idle.notify_all();
+    }
+}
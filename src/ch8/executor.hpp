@@ -0,0 +1,120 @@
+#ifndef CH8_EXECUTOR_HPP
+#define CH8_EXECUTOR_HPP
+
+#include "ch8/instruction.hpp"
+#include "ch8/system.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ch8 {
+    // Runs many independent programs on a pool of worker threads. Each worker
+    // keeps its own queue of jobs and steals from the others when it runs
+    // dry, and reuses a single chip8_system for every job it runs.
+    class executor {
+    public:
+        struct input_event {
+            std::size_t at_instruction;
+            std::uint8_t key;
+            bool pressed;
+        };
+
+        struct job {
+            std::vector<std::uint8_t> program;
+            std::size_t instruction_budget{1'000'000};
+            // Sorted by at_instruction.
+            std::vector<input_event> inputs;
+            // Checked after every emulated frame; the job ends once it
+            // returns true.
+            std::function<bool(const chip8_data&)> stop_condition;
+            int updates_per_second{800};
+            bool accurate_8xyE{true};
+            bool accurate_8xy6{true};
+            bool skip_idle_loops{true};
+            execution_engine engine{execution_engine::interpreter};
+            // Every job starts from its own seed, so results don't depend on
+            // which worker ran the job or what it ran before.
+            std::uint64_t seed{0};
+            random_engine random{random_engine::xoshiro};
+        };
+
+        struct result {
+            chip8_data data;
+            trap status;
+            load_status load;
+            // On a trap this stops at the start of the slice that faulted.
+            std::size_t instructions;
+            std::size_t frames;
+        };
+
+        using callback = std::function<void(result)>;
+        using error_callback = std::function<void(std::exception_ptr)>;
+
+        explicit executor(std::size_t worker_count = 0, bool pin = false);
+        executor(const executor&) = delete;
+        executor(executor&&) = delete;
+        ~executor();
+
+        auto operator=(const executor&) -> executor& = delete;
+        auto operator=(executor&&) -> executor& = delete;
+
+        // The future rethrows anything the job threw, such as from its
+        // stop_condition.
+        auto submit(job work) -> std::future<result>;
+        // Anything the job or done throws is passed to failed, or dropped if
+        // there is none. What failed throws is dropped too, so a job can
+        // never take its worker down with it.
+        auto submit(job work, callback done, error_callback failed = {})
+            -> void;
+        auto wait_idle() -> void;
+
+        [[nodiscard]] auto worker_count() const noexcept -> std::size_t;
+        // True only if every worker was pinned to a CPU it is allowed on.
+        [[nodiscard]] auto pinned() const noexcept -> bool;
+
+        [[nodiscard]] static auto
+        run(chip8_system& system, const job& work) -> result;
+
+    private:
+        struct task {
+            job work;
+            callback done;
+            error_callback failed;
+        };
+
+        struct worker {
+            std::mutex mutex;
+            std::deque<task> tasks;
+            chip8_system system;
+            std::thread thread;
+        };
+
+        auto work(std::size_t index) -> void;
+        static auto complete(chip8_system& system, task& next) noexcept
+            -> void;
+        auto pop(std::size_t index, task& next) -> bool;
+        auto steal(std::size_t index, task& next) -> bool;
+        auto finish() -> void;
+
+        std::vector<std::unique_ptr<worker>> workers;
+        std::atomic<std::size_t> next_worker;
+        std::atomic<std::size_t> queued;
+        std::size_t unfinished;
+        bool stopping;
+        bool pinned_workers;
+        std::mutex sleep_mutex;
+        std::condition_variable wake;
+        std::condition_variable idle;
+    };
+} // namespace ch8
+
+#endif // CH8_EXECUTOR_HPP
@@ -0,0 +1,223 @@
+#include "ch8/executor.hpp"
+#include "ch8/system.hpp"
+#include "ch8/system_state.test.hpp"
+#include <array>
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+constexpr auto executor_workload = std::array<std::uint8_t, 18>{
+    0x70, 0x01, // 200: ADD V0, 0x01
+    0x81, 0x04, // 202: ADD V1, V0
+    0xA3, 0x00, // 204: LD I, 0x300
+    0xF1, 0x33, // 206: LD B, V1
+    0xF2, 0x07, // 208: LD V2, DT
+    0x32, 0x00, // 20A: SE V2, 0x00
+    0x12, 0x00, // 20C: JP 0x200
+    0xF0, 0x15, // 20E: LD DT, V0
+    0x12, 0x00, // 210: JP 0x200
+};
+
+auto make_job(std::size_t instruction_budget) -> ch8::executor::job
+{
+    auto work = ch8::executor::job{};
+    work.program.assign(executor_workload.begin(), executor_workload.end());
+    work.instruction_budget = instruction_budget;
+    return work;
+}
+
+TEST_CASE("executor::run matches a chip8_system run frame by frame")
+{
+    const auto budget = GENERATE(1U, 13U, 40U, 1000U);
+
+    auto system = ch8::chip8_system{};
+    load(system, executor_workload);
+    auto executed = 0U;
+    for (auto frame = 1U; frame * 800U / 60U <= budget; ++frame) {
+        system.run(frame * 800U / 60U - executed);
+        system.update_timers();
+        executed = frame * 800U / 60U;
+    }
+    system.run(budget - executed);
+
+    auto scratch = ch8::chip8_system{};
+    const auto result = ch8::executor::run(scratch, make_job(budget));
+
+    REQUIRE(result.status == ch8::trap::none);
+    REQUIRE(result.instructions == budget);
+    require_same_state(result.data, system.data);
+}
+
+TEST_CASE("executor::submit returns results through a future")
+{
+    auto pool = ch8::executor{2};
+
+    auto scratch = ch8::chip8_system{};
+    const auto expected = ch8::executor::run(scratch, make_job(5000));
+
+    auto future = pool.submit(make_job(5000));
+    const auto result = future.get();
+
+    REQUIRE(result.load == ch8::load_status::ok);
+    REQUIRE(result.instructions == 5000);
+    require_same_state(result.data, expected.data);
+}
+
+TEST_CASE("executor runs every submitted job exactly once")
+{
+    auto pool = ch8::executor{4};
+    auto finished = std::atomic<int>{0};
+    auto instructions = std::atomic<std::size_t>{0};
+
+    for (auto i = 0; i < 200; ++i) {
+        pool.submit(
+            make_job(static_cast<std::size_t>(i) * 50U),
+            [&](ch8::executor::result result) {
+                instructions += result.instructions;
+                ++finished;
+            });
+    }
+    pool.wait_idle();
+
+    REQUIRE(finished == 200);
+    REQUIRE(instructions == 199U * 200U / 2U * 50U);
+}
+
+TEST_CASE("executor accepts jobs submitted from a callback")
+{
+    auto pool = ch8::executor{2};
+    auto finished = std::atomic<int>{0};
+
+    pool.submit(make_job(10), [&](const ch8::executor::result&) {
+        for (auto i = 0; i < 10; ++i) {
+            pool.submit(make_job(10), [&](const ch8::executor::result&) {
+                ++finished;
+            });
+        }
+    });
+    pool.wait_idle();
+
+    REQUIRE(finished == 10);
+}
+
+TEST_CASE("executor feeds scripted input to Fx0A")
+{
+    auto work = ch8::executor::job{};
+    work.program = {
+        0xF3, 0x0A, // 200: LD V3, K
+        0x70, 0x01, // 202: ADD V0, 0x01
+        0x12, 0x02, // 204: JP 0x202
+    };
+    work.instruction_budget = 100;
+    work.inputs = {{50, 0x7, true}, {51, 0x7, false}};
+
+    auto scratch = ch8::chip8_system{};
+    const auto result = ch8::executor::run(scratch, work);
+
+    REQUIRE(result.data.registers.at(3) == 0x7);
+    REQUIRE(result.data.registers.at(0) == 24);
+    REQUIRE_FALSE(result.data.keypad.test(0x7));
+}
+
+TEST_CASE("executor stops a job when its stop condition holds")
+{
+    auto work = make_job(1'000'000);
+    work.stop_condition = [](const ch8::chip8_data& data) {
+        return data.registers.at(0) >= 100;
+    };
+
+    auto pool = ch8::executor{1};
+    const auto result = pool.submit(work).get();
+
+    REQUIRE(result.data.registers.at(0) >= 100);
+    REQUIRE(result.instructions < 1'000'000);
+    REQUIRE(result.instructions == result.frames * 800U / 60U);
+}
+
+TEST_CASE("executor reports traps and programs that don't fit")
+{
+    auto pool = ch8::executor{1};
+
+    auto overflow = ch8::executor::job{};
+    overflow.program = {0x22, 0x00}; // 200: CALL 0x200
+    auto too_big = ch8::executor::job{};
+    too_big.program.resize(4096);
+
+    auto overflowed = pool.submit(overflow);
+    auto rejected = pool.submit(too_big);
+
+    REQUIRE(overflowed.get().status == ch8::trap::stack_overflow);
+    REQUIRE(rejected.get().load == ch8::load_status::file_too_big);
+}
+
+TEST_CASE("executor defaults to one worker per hardware thread")
+{
+    const auto pool = ch8::executor{0, true};
+
+    REQUIRE(pool.worker_count() >= 1);
+#if defined(__linux__)
+    REQUIRE(pool.pinned());
+#else
+    REQUIRE_FALSE(pool.pinned());
+#endif
+}
+
+TEST_CASE("executor passes exceptions from a job to its future")
+{
+    auto work = make_job(1000);
+    work.stop_condition = [](const ch8::chip8_data&) -> bool {
+        throw std::runtime_error{"stop condition failed"};
+    };
+
+    auto pool = ch8::executor{1};
+    auto failed = pool.submit(work);
+    auto succeeded = pool.submit(make_job(1000));
+
+    REQUIRE_THROWS_AS(failed.get(), std::runtime_error);
+    REQUIRE(succeeded.get().instructions == 1000);
+    pool.wait_idle();
+}
+
+TEST_CASE("executor passes exceptions from a job or callback to failed")
+{
+    auto work = make_job(1000);
+    work.stop_condition = [](const ch8::chip8_data&) -> bool {
+        throw std::runtime_error{"stop condition failed"};
+    };
+
+    auto pool = ch8::executor{2};
+    auto errors = std::atomic<int>{0};
+    const auto count_error = [&](std::exception_ptr) { ++errors; };
+
+    pool.submit(work, [](const ch8::executor::result&) {}, count_error);
+    pool.submit(
+        make_job(1000),
+        [](const ch8::executor::result&) {
+            throw std::runtime_error{"callback failed"};
+        },
+        count_error);
+    pool.submit(work, [](const ch8::executor::result&) {});
+    pool.submit(work, [](const ch8::executor::result&) {}, [](auto) {
+        throw std::runtime_error{"error callback failed"};
+    });
+    pool.wait_idle();
+
+    REQUIRE(errors == 2);
+}
+
+TEST_CASE("executor pins more workers than allowed CPUs")
+{
+    const auto workers =
+        static_cast<std::size_t>(std::thread::hardware_concurrency()) + 2U;
+    auto pool = ch8::executor{workers, true};
+    auto future = pool.submit(make_job(1000));
+
+    REQUIRE(future.get().instructions == 1000);
+#if defined(__linux__)
+    REQUIRE(pool.pinned());
+#endif
+}
@@ -0,0 +1,23 @@
+#include "ch8/frame_buffer.hpp"
+#include <catch2/catch.hpp>
+
+TEST_CASE("frame_buffer::clear", "[benchmark]")
+{
+    auto rgba = ch8::frame_buffer<64, 32>{};
+    auto packed = ch8::packed_frame_buffer<64, 32>{};
+
+    BENCHMARK("frame_buffer<64, 32>")
+    {
+        rgba.clear({0, 0, 0, 255});
+        return rgba.data().front();
+    };
+
+    // clear() returns early on a blank screen, so each run draws a pixel
+    // first.
+    BENCHMARK("packed_frame_buffer<64, 32>")
+    {
+        packed.pixel(63, 31, true);
+        packed.clear();
+        return packed.data().front();
+    };
+}
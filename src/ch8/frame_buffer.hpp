@@ -1,19 +1,31 @@
 #ifndef CH8_FRAME_BUFFER_HPP
 #define CH8_FRAME_BUFFER_HPP
 
+#include "ch8/color.hpp"
+#include "ch8/rgba_expand.hpp"
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <gsl-lite/gsl-lite.hpp>
 
 namespace ch8 {
-    struct color {
-        constexpr auto operator==(const color& other) const noexcept -> bool;
-        constexpr auto operator!=(const color& other) const noexcept -> bool;
-
-        std::uint8_t r;
-        std::uint8_t g;
-        std::uint8_t b;
-        std::uint8_t a;
+    // A rectangle of pixels, with x and y the top left corner.
+    struct screen_region {
+        [[nodiscard]] constexpr auto empty() const noexcept -> bool;
+        // The smallest region covering both.
+        [[nodiscard]] constexpr auto merge(const screen_region& other) const
+            noexcept -> screen_region;
+
+        constexpr auto operator==(const screen_region& other) const noexcept
+            -> bool;
+        constexpr auto operator!=(const screen_region& other) const noexcept
+            -> bool;
+
+        std::size_t x;
+        std::size_t y;
+        std::size_t width;
+        std::size_t height;
     };
 
     template <std::size_t Width, std::size_t Height>
@@ -35,15 +47,108 @@ namespace ch8 {
     private:
         rgba_array rgba_data;
     };
+
+    // A monochrome screen with one bit per pixel, each row packed into
+    // 64-bit words with the leftmost pixel in the highest bit, and the rows
+    // laid out one after another. Sprites are drawn a row at a time, and
+    // colors only come into it in to_rgba.
+    template <std::size_t Width, std::size_t Height>
+    class packed_frame_buffer {
+    public:
+        static_assert(Width > 0 && Width % 64 == 0);
+
+        static constexpr auto words_per_row = Width / 64;
+        using word_array = std::array<std::uint64_t, words_per_row * Height>;
+
+        [[nodiscard]] constexpr auto width() const noexcept -> std::size_t;
+        [[nodiscard]] constexpr auto height() const noexcept -> std::size_t;
+        [[nodiscard]] constexpr auto data() const noexcept -> const word_array&;
+        [[nodiscard]] constexpr auto pixel(std::size_t x, std::size_t y) const
+            noexcept -> bool;
+        constexpr auto pixel(std::size_t x, std::size_t y, bool on) noexcept
+            -> void;
+        constexpr auto clear() noexcept -> void;
+
+        // Covers every pixel changed since the last mark_clean, possibly
+        // with some that weren't: a sprite row marks all 8 of its columns,
+        // and one wrapping around the right edge marks the whole width.
+        [[nodiscard]] constexpr auto dirty() const noexcept -> screen_region;
+        constexpr auto mark_clean() noexcept -> void;
+
+        // XORs the 8 pixels of sprite onto row y starting at column x, both
+        // wrapping around the screen, and returns whether any pixel was
+        // turned off.
+        constexpr auto
+        draw_row(std::size_t x, std::size_t y, std::uint8_t sprite) noexcept
+            -> bool;
+        // Draws each byte of sprite as a row, going down from row y, and
+        // marks the rows dirty once rather than per row.
+        constexpr auto draw_sprite(
+            std::size_t x, std::size_t y,
+            gsl::span<const std::uint8_t> sprite) noexcept -> bool;
+
+        auto to_rgba(
+            frame_buffer<Width, Height>& rgba, const color& on,
+            const color& off) const -> void;
+        // Only converts the rows region covers.
+        auto to_rgba(
+            frame_buffer<Width, Height>& rgba, const color& on,
+            const color& off, const screen_region& region) const -> void;
+
+        constexpr auto operator==(const packed_frame_buffer& other) const
+            noexcept -> bool;
+        constexpr auto operator!=(const packed_frame_buffer& other) const
+            noexcept -> bool;
+
+    private:
+        constexpr auto
+        xor_row(std::size_t column, std::size_t y, std::uint8_t sprite) noexcept
+            -> bool;
+        constexpr auto mark_dirty(
+            std::size_t left, std::size_t top, std::size_t right,
+            std::size_t bottom) noexcept -> void;
+
+        word_array words{};
+        // Bounds of the dirty region, right and bottom exclusive. Empty when
+        // left isn't less than right.
+        std::size_t dirty_left{Width};
+        std::size_t dirty_top{Height};
+        std::size_t dirty_right{0};
+        std::size_t dirty_bottom{0};
+    };
 } // namespace ch8
 
-constexpr auto ch8::color::operator==(const color& other) const noexcept -> bool
+constexpr auto ch8::screen_region::empty() const noexcept -> bool
 {
-    return this->r == other.r && this->g == other.g && this->b == other.b &&
-           this->a == other.a;
+    return width == 0 || height == 0;
 }
 
-constexpr auto ch8::color::operator!=(const color& other) const noexcept -> bool
+constexpr auto ch8::screen_region::merge(const screen_region& other) const
+    noexcept -> screen_region
+{
+    if (empty()) {
+        return other;
+    }
+    if (other.empty()) {
+        return *this;
+    }
+
+    const auto left = std::min(x, other.x);
+    const auto top = std::min(y, other.y);
+    const auto right = std::max(x + width, other.x + other.width);
+    const auto bottom = std::max(y + height, other.y + other.height);
+    return {left, top, right - left, bottom - top};
+}
+
+constexpr auto ch8::screen_region::operator==(
+    const screen_region& other) const noexcept -> bool
+{
+    return x == other.x && y == other.y && width == other.width &&
+           height == other.height;
+}
+
+constexpr auto ch8::screen_region::operator!=(
+    const screen_region& other) const noexcept -> bool
 {
     return !(*this == other);
 }
@@ -114,4 +219,208 @@ constexpr auto CH8_FRAME_BUFFER::clear(const color& color) noexcept -> void
 
 #undef CH8_FRAME_BUFFER
 
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define CH8_PACKED_FRAME_BUFFER ch8::packed_frame_buffer<Width, Height>
+
+template <std::size_t Width, std::size_t Height>
+constexpr auto CH8_PACKED_FRAME_BUFFER::width() const noexcept -> std::size_t
+{
+    return Width;
+}
+
+template <std::size_t Width, std::size_t Height>
+constexpr auto CH8_PACKED_FRAME_BUFFER::height() const noexcept -> std::size_t
+{
+    return Height;
+}
+
+template <std::size_t Width, std::size_t Height>
+constexpr auto CH8_PACKED_FRAME_BUFFER::data() const noexcept
+    -> const word_array&
+{
+    return words;
+}
+
+template <std::size_t Width, std::size_t Height>
+constexpr auto
+CH8_PACKED_FRAME_BUFFER::pixel(std::size_t x, std::size_t y) const noexcept
+    -> bool
+{
+    gsl_Expects(x < Width);
+    gsl_Expects(y < Height);
+
+    const auto bit = 63U - x % 64U;
+    return ((words[y * words_per_row + x / 64U] >> bit) & 1U) != 0;
+}
+
+template <std::size_t Width, std::size_t Height>
+constexpr auto CH8_PACKED_FRAME_BUFFER::pixel(
+    std::size_t x, std::size_t y, const bool on) noexcept -> void
+{
+    gsl_Expects(x < Width);
+    gsl_Expects(y < Height);
+
+    const auto mask = std::uint64_t{1} << (63U - x % 64U);
+    auto& word = words[y * words_per_row + x / 64U];
+    const auto old_word = word;
+    word = on ? word | mask : word & ~mask;
+    if (word != old_word) {
+        mark_dirty(x, y, x + 1, y + 1);
+    }
+}
+
+template <std::size_t Width, std::size_t Height>
+constexpr auto CH8_PACKED_FRAME_BUFFER::clear() noexcept -> void
+{
+    if (words != word_array{}) {
+        words = {};
+        mark_dirty(0, 0, Width, Height);
+    }
+}
+
+template <std::size_t Width, std::size_t Height>
+constexpr auto CH8_PACKED_FRAME_BUFFER::dirty() const noexcept
+    -> screen_region
+{
+    if (dirty_left >= dirty_right) {
+        return {0, 0, 0, 0};
+    }
+    return {
+        dirty_left,
+        dirty_top,
+        dirty_right - dirty_left,
+        dirty_bottom - dirty_top};
+}
+
+template <std::size_t Width, std::size_t Height>
+constexpr auto CH8_PACKED_FRAME_BUFFER::mark_clean() noexcept -> void
+{
+    dirty_left = Width;
+    dirty_top = Height;
+    dirty_right = 0;
+    dirty_bottom = 0;
+}
+
+template <std::size_t Width, std::size_t Height>
+constexpr auto CH8_PACKED_FRAME_BUFFER::mark_dirty(
+    const std::size_t left, const std::size_t top, const std::size_t right,
+    const std::size_t bottom) noexcept -> void
+{
+    dirty_left = std::min(dirty_left, left);
+    dirty_top = std::min(dirty_top, top);
+    dirty_right = std::max(dirty_right, right);
+    dirty_bottom = std::max(dirty_bottom, bottom);
+}
+
+template <std::size_t Width, std::size_t Height>
+constexpr auto CH8_PACKED_FRAME_BUFFER::draw_row(
+    const std::size_t x, const std::size_t y,
+    const std::uint8_t sprite) noexcept -> bool
+{
+    const auto column = x % Width;
+    const auto row_y = y % Height;
+    const auto collision = xor_row(column, row_y, sprite);
+
+    if (sprite != 0) {
+        const auto wraps = column + 8U > Width;
+        mark_dirty(
+            wraps ? 0 : column, row_y, wraps ? Width : column + 8U, row_y + 1);
+    }
+    return collision;
+}
+
+template <std::size_t Width, std::size_t Height>
+constexpr auto CH8_PACKED_FRAME_BUFFER::draw_sprite(
+    const std::size_t x, const std::size_t y,
+    const gsl::span<const std::uint8_t> sprite) noexcept -> bool
+{
+    const auto column = x % Width;
+    const auto top = y % Height;
+
+    auto collision = false;
+    auto drawn = std::uint8_t{0};
+    auto row_y = top;
+    for (const auto row : sprite) {
+        collision = xor_row(column, row_y, row) || collision;
+        drawn |= row;
+        row_y = row_y + 1 == Height ? 0 : row_y + 1;
+    }
+
+    if (drawn != 0) {
+        const auto wraps_x = column + 8U > Width;
+        const auto wraps_y = top + sprite.size() > Height;
+        mark_dirty(
+            wraps_x ? 0 : column,
+            wraps_y ? 0 : top,
+            wraps_x ? Width : column + 8U,
+            wraps_y ? Height : top + sprite.size());
+    }
+    return collision;
+}
+
+// The sprite lands in the word holding the column, and whatever doesn't fit
+// spills into the next word, which for a single-word row is the same word:
+// a rotate.
+template <std::size_t Width, std::size_t Height>
+constexpr auto CH8_PACKED_FRAME_BUFFER::xor_row(
+    const std::size_t column, const std::size_t y,
+    const std::uint8_t sprite) noexcept -> bool
+{
+    const auto offset = column % 64U;
+    const auto placed = std::uint64_t{sprite} << 56U;
+    const auto head = placed >> offset;
+    const auto tail = offset > 56U ? std::uint64_t{sprite} << (120U - offset)
+                                   : std::uint64_t{0};
+
+    const auto row = y * words_per_row;
+    auto& first = words[row + column / 64U];
+    auto& second = words[row + (column / 64U + 1U) % words_per_row];
+
+    const auto collision = ((first & head) | (second & tail)) != 0;
+    first ^= head;
+    second ^= tail;
+    return collision;
+}
+
+template <std::size_t Width, std::size_t Height>
+auto CH8_PACKED_FRAME_BUFFER::to_rgba(
+    frame_buffer<Width, Height>& rgba, const color& on,
+    const color& off) const -> void
+{
+    to_rgba(rgba, on, off, {0, 0, Width, Height});
+}
+
+template <std::size_t Width, std::size_t Height>
+auto CH8_PACKED_FRAME_BUFFER::to_rgba(
+    frame_buffer<Width, Height>& rgba, const color& on, const color& off,
+    const screen_region& region) const -> void
+{
+    if (region.empty()) {
+        return;
+    }
+
+    const auto bottom = std::min(region.y + region.height, Height);
+    const auto rows = gsl::span<const std::uint64_t>{words}.subspan(
+        region.y * words_per_row, (bottom - region.y) * words_per_row);
+    const auto out = gsl::span<std::uint8_t>{rgba.data()}.subspan(
+        region.y * Width * 4, (bottom - region.y) * Width * 4);
+    expand_to_rgba(rows, on, off, out);
+}
+
+template <std::size_t Width, std::size_t Height>
+constexpr auto CH8_PACKED_FRAME_BUFFER::operator==(
+    const packed_frame_buffer& other) const noexcept -> bool
+{
+    return words == other.words;
+}
+
+template <std::size_t Width, std::size_t Height>
+constexpr auto CH8_PACKED_FRAME_BUFFER::operator!=(
+    const packed_frame_buffer& other) const noexcept -> bool
+{
+    return !(*this == other);
+}
+
+#undef CH8_PACKED_FRAME_BUFFER
+
 #endif // CH8_FRAME_BUFFER_HPP
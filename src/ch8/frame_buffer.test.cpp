@@ -157,3 +157,198 @@ TEST_CASE("color{83, 67, 201, 143} != color{84, 32, 65, 93}")
 {
     REQUIRE(ch8::color{83, 67, 201, 143} != ch8::color{84, 32, 65, 93});
 }
+
+TEST_CASE("packed_frame_buffer constructor turns off each pixel")
+{
+    const auto buffer = ch8::packed_frame_buffer<64, 32>{};
+    for (auto x = std::size_t{0}; x < buffer.width(); ++x) {
+        for (auto y = std::size_t{0}; y < buffer.height(); ++y) {
+            REQUIRE_FALSE(buffer.pixel(x, y));
+        }
+    }
+}
+
+TEST_CASE("packed_frame_buffer<64, 32> takes one bit per pixel")
+{
+    using buffer = ch8::packed_frame_buffer<64, 32>;
+    STATIC_REQUIRE(sizeof(buffer::word_array) == 64 * 32 / 8);
+    STATIC_REQUIRE(ch8::packed_frame_buffer<128, 64>::words_per_row == 2);
+}
+
+TEST_CASE("packed_frame_buffer::pixel returns the pixel set at (x, y)")
+{
+    auto buffer = ch8::packed_frame_buffer<128, 64>{};
+    buffer.pixel(70, 9, true);
+    REQUIRE(buffer.pixel(70, 9));
+    REQUIRE_FALSE(buffer.pixel(69, 9));
+    REQUIRE_FALSE(buffer.pixel(70, 8));
+
+    buffer.pixel(70, 9, false);
+    REQUIRE(buffer == ch8::packed_frame_buffer<128, 64>{});
+}
+
+TEST_CASE("packed_frame_buffer::draw_row XORs the sprite onto the row")
+{
+    auto buffer = ch8::packed_frame_buffer<64, 32>{};
+
+    REQUIRE_FALSE(buffer.draw_row(3, 5, 0b1010'0001));
+    REQUIRE(buffer.pixel(3, 5));
+    REQUIRE_FALSE(buffer.pixel(4, 5));
+    REQUIRE(buffer.pixel(5, 5));
+    REQUIRE(buffer.pixel(10, 5));
+
+    REQUIRE(buffer.draw_row(3, 5, 0b1000'0000));
+    REQUIRE_FALSE(buffer.pixel(3, 5));
+    REQUIRE(buffer.pixel(5, 5));
+
+    REQUIRE_FALSE(buffer.draw_row(4, 5, 0b1000'0000));
+    REQUIRE(buffer.pixel(4, 5));
+}
+
+TEST_CASE("packed_frame_buffer::draw_row wraps around the screen")
+{
+    auto buffer = ch8::packed_frame_buffer<64, 32>{};
+
+    REQUIRE_FALSE(buffer.draw_row(60 + 64, 31 + 32, 0xFF));
+    for (auto x = std::size_t{60}; x < 64; ++x) {
+        REQUIRE(buffer.pixel(x, 31));
+    }
+    for (auto x = std::size_t{0}; x < 4; ++x) {
+        REQUIRE(buffer.pixel(x, 31));
+    }
+    REQUIRE_FALSE(buffer.pixel(4, 31));
+    REQUIRE_FALSE(buffer.pixel(59, 31));
+
+    REQUIRE(buffer.draw_row(0, 31, 0b0001'0000));
+    REQUIRE_FALSE(buffer.draw_row(0, 31, 0b0000'1000));
+}
+
+TEST_CASE("packed_frame_buffer::draw_row spans the words of a wide row")
+{
+    auto buffer = ch8::packed_frame_buffer<128, 64>{};
+
+    REQUIRE_FALSE(buffer.draw_row(60, 0, 0xFF));
+    for (auto x = std::size_t{60}; x < 68; ++x) {
+        REQUIRE(buffer.pixel(x, 0));
+    }
+    REQUIRE_FALSE(buffer.pixel(59, 0));
+    REQUIRE_FALSE(buffer.pixel(68, 0));
+
+    REQUIRE_FALSE(buffer.draw_row(124, 1, 0xFF));
+    REQUIRE(buffer.pixel(127, 1));
+    REQUIRE(buffer.pixel(0, 1));
+    REQUIRE(buffer.pixel(3, 1));
+    REQUIRE_FALSE(buffer.pixel(4, 1));
+
+    REQUIRE(buffer.draw_row(66, 0, 0b1000'0000));
+}
+
+TEST_CASE("packed_frame_buffer::to_rgba writes the on and off colors")
+{
+    constexpr auto on = ch8::color{255, 200, 100, 255};
+    constexpr auto off = ch8::color{1, 2, 3, 4};
+
+    auto buffer = ch8::packed_frame_buffer<64, 32>{};
+    buffer.pixel(0, 0, true);
+    buffer.pixel(63, 31, true);
+    buffer.pixel(17, 4, true);
+
+    auto rgba = ch8::frame_buffer<64, 32>{};
+    buffer.to_rgba(rgba, on, off);
+
+    for (auto x = std::size_t{0}; x < buffer.width(); ++x) {
+        for (auto y = std::size_t{0}; y < buffer.height(); ++y) {
+            REQUIRE(rgba.pixel(x, y) == (buffer.pixel(x, y) ? on : off));
+        }
+    }
+}
+
+TEST_CASE("screen_region::merge covers both regions")
+{
+    constexpr auto a = ch8::screen_region{2, 3, 4, 5};
+    constexpr auto b = ch8::screen_region{10, 1, 2, 2};
+    constexpr auto empty = ch8::screen_region{};
+
+    STATIC_REQUIRE(a.merge(b) == ch8::screen_region{2, 1, 10, 7});
+    STATIC_REQUIRE(b.merge(a) == a.merge(b));
+    STATIC_REQUIRE(a.merge(empty) == a);
+    STATIC_REQUIRE(empty.merge(a) == a);
+    STATIC_REQUIRE(empty.empty());
+}
+
+TEST_CASE("packed_frame_buffer::dirty is empty until a pixel changes")
+{
+    auto buffer = ch8::packed_frame_buffer<64, 32>{};
+    REQUIRE(buffer.dirty().empty());
+
+    buffer.clear();
+    buffer.pixel(4, 4, false);
+    buffer.draw_row(8, 8, 0);
+    REQUIRE(buffer.dirty().empty());
+
+    buffer.pixel(4, 4, true);
+    REQUIRE(buffer.dirty() == ch8::screen_region{4, 4, 1, 1});
+
+    buffer.mark_clean();
+    REQUIRE(buffer.dirty().empty());
+    buffer.pixel(4, 4, true);
+    REQUIRE(buffer.dirty().empty());
+}
+
+TEST_CASE("packed_frame_buffer::dirty covers the rows draw_row changed")
+{
+    auto buffer = ch8::packed_frame_buffer<64, 32>{};
+
+    buffer.draw_row(10, 3, 0b0001'0000);
+    buffer.draw_row(12, 6, 0xFF);
+    REQUIRE(buffer.dirty() == ch8::screen_region{10, 3, 10, 4});
+
+    buffer.mark_clean();
+    buffer.draw_row(60, 30, 0xFF);
+    buffer.draw_row(60, 33, 0xFF);
+    REQUIRE(buffer.dirty() == ch8::screen_region{0, 1, 64, 30});
+}
+
+TEST_CASE("packed_frame_buffer::clear marks the screen dirty if it wasn't off")
+{
+    auto buffer = ch8::packed_frame_buffer<64, 32>{};
+    buffer.pixel(1, 1, true);
+    buffer.mark_clean();
+
+    buffer.clear();
+    REQUIRE(buffer.dirty() == ch8::screen_region{0, 0, 64, 32});
+}
+
+TEST_CASE("packed_frame_buffer::to_rgba only converts the rows in a region")
+{
+    constexpr auto on = ch8::color{255, 255, 255, 255};
+    constexpr auto off = ch8::color{0, 0, 0, 255};
+    constexpr auto untouched = ch8::color{};
+
+    auto buffer = ch8::packed_frame_buffer<64, 32>{};
+    buffer.pixel(5, 2, true);
+    buffer.pixel(5, 6, true);
+
+    auto rgba = ch8::frame_buffer<64, 32>{};
+    buffer.to_rgba(rgba, on, off, {4, 2, 2, 3});
+
+    REQUIRE(rgba.pixel(5, 2) == on);
+    REQUIRE(rgba.pixel(63, 4) == off);
+    REQUIRE(rgba.pixel(5, 1) == untouched);
+    REQUIRE(rgba.pixel(5, 6) == untouched);
+}
+
+TEST_CASE("packed_frame_buffer::draw_sprite draws and marks each row")
+{
+    constexpr auto sprite = std::array<std::uint8_t, 3>{0xF0, 0x00, 0x81};
+
+    auto buffer = ch8::packed_frame_buffer<64, 32>{};
+    REQUIRE_FALSE(buffer.draw_sprite(4, 30, sprite));
+    REQUIRE(buffer.pixel(4, 30));
+    REQUIRE_FALSE(buffer.pixel(4, 31));
+    REQUIRE(buffer.pixel(11, 0));
+    REQUIRE(buffer.dirty() == ch8::screen_region{4, 0, 8, 32});
+
+    REQUIRE(buffer.draw_sprite(4 + 64, 30 + 32, sprite));
+    REQUIRE(buffer == ch8::packed_frame_buffer<64, 32>{});
+}
@@ -0,0 +1,105 @@
+#ifndef CH8_INSTRUCTION_HPP
+#define CH8_INSTRUCTION_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ch8 {
+    class chip8_system;
+
+    // Why execution stopped. The faulting instruction has no effect and the
+    // program counter is left pointing at it.
+    enum class trap {
+        none,
+        stack_overflow,
+        stack_underflow,
+        pc_out_of_range,
+        unknown_opcode
+    };
+
+    using instruction = auto (*)(chip8_system& system, std::uint16_t opcode)
+        -> trap;
+
+    // Indexed by the high nibble and low byte of an opcode.
+    using instruction_table = std::array<std::array<instruction, 256>, 16>;
+
+    // Common pairs of instructions that the block cache runs as one handler.
+    enum class fusion {
+        none,
+        load_and_draw,
+        load_pair,
+        skip_and_jump,
+        add_and_load
+    };
+
+    constexpr auto fusion_kinds = std::size_t{5};
+
+    [[nodiscard]] constexpr auto
+    create_opcode(std::uint8_t byte1, std::uint8_t byte2) noexcept
+        -> std::uint16_t;
+
+    [[nodiscard]] constexpr auto writes_memory(std::uint16_t opcode) noexcept
+        -> bool;
+
+    [[nodiscard]] constexpr auto
+    fusion_of(std::uint16_t first, std::uint16_t second) noexcept -> fusion;
+
+    [[nodiscard]] constexpr auto last_written_address(
+        std::uint16_t i_register, std::uint16_t opcode) noexcept -> std::size_t;
+} // namespace ch8
+
+constexpr auto
+ch8::create_opcode(const std::uint8_t byte1, const std::uint8_t byte2) noexcept
+    -> std::uint16_t
+{
+    auto opcode = std::uint16_t{0x0};
+    opcode |= byte1;
+    opcode <<= 8U;
+    opcode |= byte2;
+
+    return opcode;
+}
+
+constexpr auto ch8::writes_memory(const std::uint16_t opcode) noexcept -> bool
+{
+    return (opcode & 0xF0FFU) == 0xF033 || (opcode & 0xF0FFU) == 0xF055;
+}
+
+// Annn then Dxyn, two 6xkk, 3xkk or 4xkk then 1nnn, and Fx1E then Fx65.
+constexpr auto
+ch8::fusion_of(const std::uint16_t first, const std::uint16_t second) noexcept
+    -> fusion
+{
+    const auto first_row = first & 0xF000U;
+    const auto second_row = second & 0xF000U;
+
+    if (first_row == 0xA000U && second_row == 0xD000U) {
+        return fusion::load_and_draw;
+    }
+    if (first_row == 0x6000U && second_row == 0x6000U) {
+        return fusion::load_pair;
+    }
+    if ((first_row == 0x3000U || first_row == 0x4000U) &&
+        second_row == 0x1000U) {
+        return fusion::skip_and_jump;
+    }
+    if ((first & 0xF0FFU) == 0xF01EU && (second & 0xF0FFU) == 0xF065U) {
+        return fusion::add_and_load;
+    }
+
+    return fusion::none;
+}
+
+constexpr auto ch8::last_written_address(
+    const std::uint16_t i_register, const std::uint16_t opcode) noexcept
+    -> std::size_t
+{
+    if ((opcode & 0x00FFU) == 0x0033) {
+        return i_register + 2U;
+    }
+
+    return i_register + ((opcode & 0x0F00U) >> 8U);
+}
+
+#endif // CH8_INSTRUCTION_HPP
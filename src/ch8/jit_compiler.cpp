@@ -0,0 +1,708 @@
+#include "ch8/jit_compiler.hpp"
+#include "ch8/system.hpp"
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+#if defined(CH8_JIT_COMPILER)
+#include <sys/mman.h>
+#endif
+
+// Compiled blocks follow the System V AMD64 calling convention and take a
+// pointer to chip8_data in rdi. Fields are addressed as [rdi + offset], I is
+// kept in edx while a block runs and the pc is a constant known at compile
+// time. A block returns the next pc in the low half of eax and the number of
+// instructions it executed in the high half.
+enum class compiled { unsupported, straight_line, block_end };
+
+struct data_layout {
+    std::int32_t i_register;
+    std::int32_t delay_timer;
+    std::int32_t sound_timer;
+    std::int32_t stack_pointer;
+    std::int32_t ram;
+    std::int32_t registers;
+    std::int32_t stack;
+};
+
+struct assembler {
+    std::vector<std::uint8_t> code;
+    data_layout layout;
+};
+
+template <typename Member>
+auto offset_in(const ch8::chip8_data& data, const Member& member)
+    -> std::int32_t
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto base = reinterpret_cast<std::uintptr_t>(&data);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto address = reinterpret_cast<std::uintptr_t>(&member);
+
+    return static_cast<std::int32_t>(address - base);
+}
+
+auto layout_of(const ch8::chip8_data& data) -> data_layout
+{
+    return data_layout{
+        offset_in(data, data.i_register),
+        offset_in(data, data.delay_timer),
+        offset_in(data, data.sound_timer),
+        offset_in(data, data.stack_pointer),
+        offset_in(data, data.ram),
+        offset_in(data, data.registers),
+        offset_in(data, data.stack),
+    };
+}
+
+constexpr auto exit_value(const std::size_t pc, const std::size_t executed)
+    -> std::uint32_t
+{
+    return static_cast<std::uint32_t>((pc & 0xFFFFU) | (executed << 16U));
+}
+
+auto emit(assembler& a, std::initializer_list<int> bytes) -> void
+{
+    for (const auto byte : bytes) {
+        a.code.push_back(static_cast<std::uint8_t>(byte));
+    }
+}
+
+auto emit_imm16(assembler& a, const std::uint32_t value) -> void
+{
+    for (auto shift = 0U; shift < 16U; shift += 8U) {
+        a.code.push_back(static_cast<std::uint8_t>(value >> shift));
+    }
+}
+
+auto emit_imm32(assembler& a, const std::uint32_t value) -> void
+{
+    for (auto shift = 0U; shift < 32U; shift += 8U) {
+        a.code.push_back(static_cast<std::uint8_t>(value >> shift));
+    }
+}
+
+// Emits an instruction whose memory operand is [rdi + displacement]. reg is
+// the ModRM reg field: a register number or an opcode extension.
+auto emit_rdi(
+    assembler& a,
+    std::initializer_list<int> opcode,
+    const int reg,
+    const std::int32_t displacement) -> void
+{
+    emit(a, opcode);
+    emit(a, {0x87 | (reg << 3)});
+    emit_imm32(a, static_cast<std::uint32_t>(displacement));
+}
+
+auto emit_exit(assembler& a, const std::uint32_t value) -> void
+{
+    emit_rdi(a, {0x66, 0x89}, 2, a.layout.i_register); // mov [I], dx
+    emit(a, {0xB8});                                   // mov eax, value
+    emit_imm32(a, value);
+    emit(a, {0xC3}); // ret
+}
+
+// Leaves the block with the pc held in eax.
+auto emit_dynamic_exit(assembler& a, const std::size_t executed) -> void
+{
+    emit(a, {0x0D}); // or eax, executed << 16
+    emit_imm32(a, exit_value(0, executed));
+    emit_rdi(a, {0x66, 0x89}, 2, a.layout.i_register); // mov [I], dx
+    emit(a, {0xC3});                                   // ret
+}
+
+auto emit_skip_exit(
+    assembler& a,
+    const int cmov,
+    const std::uint16_t address,
+    const std::size_t executed) -> void
+{
+    emit_rdi(a, {0x66, 0x89}, 2, a.layout.i_register); // mov [I], dx
+    emit(a, {0xB8});                                   // mov eax, next
+    emit_imm32(a, exit_value(address + 2U, executed));
+    emit(a, {0xB9}); // mov ecx, skip
+    emit_imm32(a, exit_value(address + 4U, executed));
+    emit(a, {0x0F, cmov, 0xC1}); // cmovcc eax, ecx
+    emit(a, {0xC3});             // ret
+}
+
+// Leaves the block before the instruction at address if the preceding
+// unsigned comparison was above, so the interpreter can handle it.
+auto emit_bail_if_above(
+    assembler& a, const std::uint16_t address, const std::size_t executed)
+    -> void
+{
+    auto bail = assembler{{}, a.layout};
+    emit_exit(bail, exit_value(address, executed - 1U));
+
+    emit(a, {0x76, static_cast<int>(bail.code.size())}); // jbe past the exit
+    a.code.insert(a.code.end(), bail.code.begin(), bail.code.end());
+}
+
+auto compile_8xyn(
+    assembler& a,
+    const int x,
+    const int y,
+    const int n,
+    const bool accurate_8xy6,
+    const bool accurate_8xyE) -> compiled
+{
+    const auto vx = a.layout.registers + x;
+    const auto vy = a.layout.registers + y;
+    const auto vf = a.layout.registers + 0xF;
+
+    switch (n) {
+    case 0x0:
+        emit_rdi(a, {0x8A}, 0, vy); // mov al, [Vy]
+        emit_rdi(a, {0x88}, 0, vx); // mov [Vx], al
+        break;
+    case 0x1:
+        emit_rdi(a, {0x8A}, 0, vy); // mov al, [Vy]
+        emit_rdi(a, {0x08}, 0, vx); // or [Vx], al
+        break;
+    case 0x2:
+        emit_rdi(a, {0x8A}, 0, vy); // mov al, [Vy]
+        emit_rdi(a, {0x20}, 0, vx); // and [Vx], al
+        break;
+    case 0x3:
+        emit_rdi(a, {0x8A}, 0, vy); // mov al, [Vy]
+        emit_rdi(a, {0x30}, 0, vx); // xor [Vx], al
+        break;
+    case 0x4:
+        emit_rdi(a, {0x8A}, 0, vx);       // mov al, [Vx]
+        emit_rdi(a, {0x02}, 0, vy);       // add al, [Vy]
+        emit(a, {0x41, 0x0F, 0x92, 0xC0}); // setc r8b
+        emit_rdi(a, {0x88}, 0, vx);       // mov [Vx], al
+        emit_rdi(a, {0x44, 0x88}, 0, vf); // mov [VF], r8b
+        break;
+    case 0x5:
+        emit_rdi(a, {0x8A}, 0, vx);       // mov al, [Vx]
+        emit_rdi(a, {0x8A}, 1, vy);       // mov cl, [Vy]
+        emit(a, {0x38, 0xC8});            // cmp al, cl
+        emit(a, {0x41, 0x0F, 0x97, 0xC0}); // seta r8b
+        emit(a, {0x28, 0xC8});            // sub al, cl
+        emit_rdi(a, {0x88}, 0, vx);       // mov [Vx], al
+        emit_rdi(a, {0x44, 0x88}, 0, vf); // mov [VF], r8b
+        break;
+    case 0x6:
+        emit_rdi(a, {0x8A}, 0, accurate_8xy6 ? vy : vx); // mov al, [src]
+        emit(a, {0x88, 0xC1});                           // mov cl, al
+        emit(a, {0x80, 0xE1, 0x01});                     // and cl, 1
+        emit(a, {0xD0, 0xE8});                           // shr al, 1
+        emit_rdi(a, {0x88}, 0, vx);                      // mov [Vx], al
+        emit_rdi(a, {0x88}, 1, vf);                      // mov [VF], cl
+        break;
+    case 0x7:
+        emit_rdi(a, {0x8A}, 0, vx);       // mov al, [Vx]
+        emit_rdi(a, {0x8A}, 1, vy);       // mov cl, [Vy]
+        emit(a, {0x38, 0xC1});            // cmp cl, al
+        emit(a, {0x41, 0x0F, 0x97, 0xC0}); // seta r8b
+        emit(a, {0x28, 0xC1});            // sub cl, al
+        emit_rdi(a, {0x88}, 1, vx);       // mov [Vx], cl
+        emit_rdi(a, {0x44, 0x88}, 0, vf); // mov [VF], r8b
+        break;
+    case 0xE:
+        emit_rdi(a, {0x8A}, 0, accurate_8xyE ? vy : vx); // mov al, [src]
+        emit(a, {0x88, 0xC1});                           // mov cl, al
+        emit(a, {0xC0, 0xE9, 0x07});                     // shr cl, 7
+        emit(a, {0xD0, 0xE0});                           // shl al, 1
+        emit_rdi(a, {0x88}, 0, vx);                      // mov [Vx], al
+        emit_rdi(a, {0x88}, 1, vf);                      // mov [VF], cl
+        break;
+    default:
+        return compiled::unsupported;
+    }
+
+    return compiled::straight_line;
+}
+
+auto compile_Fxkk(assembler& a, const int x, const int kk) -> compiled
+{
+    const auto vx = a.layout.registers + x;
+
+    switch (kk) {
+    case 0x07:
+        emit_rdi(a, {0x8A}, 0, a.layout.delay_timer); // mov al, [DT]
+        emit_rdi(a, {0x88}, 0, vx);                   // mov [Vx], al
+        break;
+    case 0x15:
+        emit_rdi(a, {0x8A}, 0, vx);                   // mov al, [Vx]
+        emit_rdi(a, {0x88}, 0, a.layout.delay_timer); // mov [DT], al
+        break;
+    case 0x18:
+        emit_rdi(a, {0x8A}, 0, vx);                   // mov al, [Vx]
+        emit_rdi(a, {0x88}, 0, a.layout.sound_timer); // mov [ST], al
+        break;
+    case 0x1E:
+        emit_rdi(a, {0x0F, 0xB6}, 0, vx); // movzx eax, byte [Vx]
+        emit(a, {0x01, 0xC2});            // add edx, eax
+        emit(a, {0x0F, 0xB7, 0xD2});      // movzx edx, dx
+        break;
+    case 0x29:
+        emit_rdi(a, {0x0F, 0xB6}, 0, vx); // movzx eax, byte [Vx]
+        emit(a, {0x8D, 0x14, 0x80});      // lea edx, [rax + rax * 4]
+        break;
+    default:
+        return compiled::unsupported;
+    }
+
+    return compiled::straight_line;
+}
+
+auto compile_instruction(
+    assembler& a,
+    const std::uint16_t opcode,
+    const std::uint16_t address,
+    const std::size_t executed,
+    const bool accurate_8xy6,
+    const bool accurate_8xyE) -> compiled
+{
+    const auto x = static_cast<int>((opcode & 0x0F00U) >> 8U);
+    const auto y = static_cast<int>((opcode & 0x00F0U) >> 4U);
+    const auto kk = static_cast<int>(opcode & 0x00FFU);
+    const auto nnn = static_cast<std::uint16_t>(opcode & 0x0FFFU);
+    const auto vx = a.layout.registers + x;
+    const auto vy = a.layout.registers + y;
+
+    switch (opcode & 0xF000U) {
+    case 0x0000:
+        if (opcode != 0x00EE) {
+            return compiled::unsupported;
+        }
+        emit_rdi(a, {0x0F, 0xBE}, 0, a.layout.stack_pointer); // movsx eax, [SP]
+        emit(a, {0x83, 0xF8, 0x0F});                          // cmp eax, 15
+        emit_bail_if_above(a, address, executed);
+        emit(a, {0x0F, 0xB7, 0x84, 0x47}); // movzx eax, [rdi + rax * 2 + stack]
+        emit_imm32(a, static_cast<std::uint32_t>(a.layout.stack));
+        emit_rdi(a, {0xFE}, 1, a.layout.stack_pointer); // dec byte [SP]
+        emit_dynamic_exit(a, executed);
+        return compiled::block_end;
+    case 0x1000:
+        emit_exit(a, exit_value(nnn, executed));
+        return compiled::block_end;
+    case 0x2000:
+        emit_rdi(a, {0x0F, 0xBE}, 0, a.layout.stack_pointer); // movsx eax, [SP]
+        emit(a, {0xFF, 0xC0});                                // inc eax
+        emit(a, {0x83, 0xF8, 0x0F});                          // cmp eax, 15
+        emit_bail_if_above(a, address, executed);
+        emit_rdi(a, {0x88}, 0, a.layout.stack_pointer); // mov [SP], al
+        emit(a, {0x66, 0xC7, 0x84, 0x47}); // mov word [rdi + rax * 2 + stack]
+        emit_imm32(a, static_cast<std::uint32_t>(a.layout.stack));
+        emit_imm16(a, address + 2U);
+        emit_exit(a, exit_value(nnn, executed));
+        return compiled::block_end;
+    case 0x3000:
+        emit_rdi(a, {0x80}, 7, vx); // cmp byte [Vx], kk
+        emit(a, {kk});
+        emit_skip_exit(a, 0x44, address, executed);
+        return compiled::block_end;
+    case 0x4000:
+        emit_rdi(a, {0x80}, 7, vx); // cmp byte [Vx], kk
+        emit(a, {kk});
+        emit_skip_exit(a, 0x45, address, executed);
+        return compiled::block_end;
+    case 0x5000:
+        if ((opcode & 0x000FU) != 0) {
+            return compiled::unsupported;
+        }
+        emit_rdi(a, {0x8A}, 0, vx); // mov al, [Vx]
+        emit_rdi(a, {0x3A}, 0, vy); // cmp al, [Vy]
+        emit_skip_exit(a, 0x44, address, executed);
+        return compiled::block_end;
+    case 0x6000:
+        emit_rdi(a, {0xC6}, 0, vx); // mov byte [Vx], kk
+        emit(a, {kk});
+        return compiled::straight_line;
+    case 0x7000:
+        emit_rdi(a, {0x80}, 0, vx); // add byte [Vx], kk
+        emit(a, {kk});
+        return compiled::straight_line;
+    case 0x8000:
+        return compile_8xyn(
+            a, x, y, static_cast<int>(opcode & 0x000FU), accurate_8xy6,
+            accurate_8xyE);
+    case 0x9000:
+        if ((opcode & 0x000FU) != 0) {
+            return compiled::unsupported;
+        }
+        emit_rdi(a, {0x8A}, 0, vx); // mov al, [Vx]
+        emit_rdi(a, {0x3A}, 0, vy); // cmp al, [Vy]
+        emit_skip_exit(a, 0x45, address, executed);
+        return compiled::block_end;
+    case 0xA000:
+        emit(a, {0xBA}); // mov edx, nnn
+        emit_imm32(a, nnn);
+        return compiled::straight_line;
+    case 0xB000:
+        emit_rdi(a, {0x0F, 0xB6}, 0, a.layout.registers); // movzx eax, [V0]
+        emit(a, {0x05});                                  // add eax, nnn
+        emit_imm32(a, nnn);
+        emit_dynamic_exit(a, executed);
+        return compiled::block_end;
+    case 0xF000:
+        if (kk == 0x65) {
+            emit(a, {0x8D, 0x42, x});    // lea eax, [rdx + x]
+            emit(a, {0x3D});             // cmp eax, 0xFFF
+            emit_imm32(a, 0xFFFU);
+            emit_bail_if_above(a, address, executed);
+            for (auto i = 0; i <= x; ++i) {
+                emit(a, {0x8A, 0x84, 0x17}); // mov al, [rdi + rdx + ram + i]
+                emit_imm32(a, static_cast<std::uint32_t>(a.layout.ram + i));
+                emit_rdi(a, {0x88}, 0, a.layout.registers + i); // mov [Vi], al
+            }
+            return compiled::straight_line;
+        }
+        return compile_Fxkk(a, x, kk);
+    default:
+        return compiled::unsupported;
+    }
+}
+
+auto ch8::jit_compiler::supported() noexcept -> bool
+{
+#if defined(CH8_JIT_COMPILER)
+    return true;
+#else
+    return false;
+#endif
+}
+
+ch8::jit_compiler::jit_compiler() noexcept
+    : blocks{}
+    , heat{}
+    , code_memory{nullptr}
+    , code_used{0}
+    , generation{0}
+    , jit_stats{0, 0, 0, 0}
+{
+}
+
+// Compiled code is only a cache, so a copy starts out cold.
+ch8::jit_compiler::jit_compiler(const jit_compiler& /*other*/) noexcept
+    : jit_compiler{}
+{
+}
+
+ch8::jit_compiler::jit_compiler(jit_compiler&& other) noexcept
+    : blocks{std::move(other.blocks)}
+    , heat{std::move(other.heat)}
+    , code_memory{std::exchange(other.code_memory, nullptr)}
+    , code_used{std::exchange(other.code_used, 0)}
+    , generation{other.generation}
+    , jit_stats{other.jit_stats}
+{
+    other.blocks.clear();
+}
+
+ch8::jit_compiler::~jit_compiler()
+{
+    release();
+}
+
+auto ch8::jit_compiler::operator=(const jit_compiler& other) noexcept
+    -> jit_compiler&
+{
+    if (this != &other) {
+        release();
+        blocks.clear();
+        heat.clear();
+        jit_stats = statistics{0, 0, 0, 0};
+    }
+
+    return *this;
+}
+
+auto ch8::jit_compiler::operator=(jit_compiler&& other) noexcept
+    -> jit_compiler&
+{
+    if (this != &other) {
+        release();
+        blocks = std::move(other.blocks);
+        heat = std::move(other.heat);
+        code_memory = std::exchange(other.code_memory, nullptr);
+        code_used = std::exchange(other.code_used, 0);
+        generation = other.generation;
+        jit_stats = other.jit_stats;
+        other.blocks.clear();
+    }
+
+    return *this;
+}
+
+auto ch8::jit_compiler::run(
+    chip8_system& system, const std::size_t instruction_count) -> trap
+{
+    auto& data = system.data;
+
+    if (!supported()) {
+        for (auto i = std::size_t{0}; i < instruction_count; ++i) {
+            ++jit_stats.interpreted_instructions;
+            const auto result = system.step();
+            if (result != trap::none) {
+                return result;
+            }
+        }
+        return trap::none;
+    }
+
+    if (blocks.empty()) {
+        blocks.resize(data.ram.size());
+        heat.resize(data.ram.size());
+    }
+
+    ++generation;
+
+    auto remaining = instruction_count;
+    while (remaining > 0) {
+        const auto start = std::size_t{data.program_counter};
+
+        if (data.waiting_for_keypress || start + 1U >= data.ram.size()) {
+            const auto result = interpret(system);
+            if (result != trap::none) {
+                return result;
+            }
+            --remaining;
+            continue;
+        }
+
+        // Stores made by the program invalidate blocks as they happen, so a
+        // block only has to be checked against host writes and quirk changes
+        // once per call.
+        auto& entry = blocks[start];
+        if (!entry.source.empty() && entry.verified != generation) {
+            if (entry.accurate_8xy6 == system.accurate_8xy6 &&
+                entry.accurate_8xyE == system.accurate_8xyE &&
+                std::equal(
+                    entry.source.begin(), entry.source.end(),
+                    data.ram.begin() + start)) {
+                entry.verified = generation;
+            }
+            else {
+                entry.source.clear();
+                entry.code = nullptr;
+                ++jit_stats.invalidations;
+            }
+        }
+
+        if (entry.source.empty() && ++heat[start] >= hot_threshold) {
+            compile(system, start);
+        }
+
+        if (entry.code != nullptr && entry.length <= remaining) {
+            const auto result = entry.code(&data);
+            const auto executed = std::size_t{result >> 16U};
+
+            // A block that stops before its first instruction leaves that
+            // instruction to the interpreter.
+            if (executed > 0) {
+                data.program_counter = static_cast<std::uint16_t>(result);
+                jit_stats.native_instructions += executed;
+                remaining -= executed;
+                continue;
+            }
+        }
+
+        const auto result = interpret(system);
+        if (result != trap::none) {
+            return result;
+        }
+        --remaining;
+    }
+
+    return trap::none;
+}
+
+auto ch8::jit_compiler::invalidate(
+    const std::size_t first, const std::size_t last) noexcept -> void
+{
+    if (blocks.empty()) {
+        return;
+    }
+
+    // Stores through I wrap around the end of memory.
+    const auto size = blocks.size();
+    if (first >= size || last >= size) {
+        const auto wrapped_first = first % size;
+        const auto wrapped_last = last % size;
+        if (wrapped_first <= wrapped_last) {
+            invalidate(wrapped_first, wrapped_last);
+        }
+        else {
+            invalidate(wrapped_first, size - 1U);
+            invalidate(0, wrapped_last);
+        }
+        return;
+    }
+
+    const auto reach = max_block_length * 2U - 1U;
+    const auto begin = first > reach ? first - reach : std::size_t{0};
+    const auto end = last + 1U;
+
+    for (auto start = begin; start < end; ++start) {
+        auto& entry = blocks[start];
+        if (!entry.source.empty() && start + entry.source.size() > first) {
+            entry.source.clear();
+            entry.code = nullptr;
+            ++jit_stats.invalidations;
+        }
+    }
+}
+
+auto ch8::jit_compiler::clear() noexcept -> void
+{
+    for (auto& entry : blocks) {
+        entry.source.clear();
+        entry.code = nullptr;
+    }
+    std::fill(heat.begin(), heat.end(), std::uint16_t{0});
+    code_used = 0;
+}
+
+auto ch8::jit_compiler::stats() const noexcept -> const statistics&
+{
+    return jit_stats;
+}
+
+auto ch8::jit_compiler::compile(
+    const chip8_system& system, const std::size_t start) -> void
+{
+    const auto& ram = system.data.ram;
+    auto& entry = blocks[start];
+    entry.source.clear();
+    entry.code = nullptr;
+    entry.length = 0;
+    entry.verified = generation;
+    entry.accurate_8xy6 = system.accurate_8xy6;
+    entry.accurate_8xyE = system.accurate_8xyE;
+
+    auto a = assembler{{}, layout_of(system.data)};
+    emit_rdi(a, {0x0F, 0xB7}, 2, a.layout.i_register); // movzx edx, word [I]
+
+    auto address = start;
+    auto result = compiled::straight_line;
+    while (entry.length < max_block_length && address + 1U < ram.size()) {
+        const auto byte1 = ram[address];
+        const auto byte2 = ram[address + 1U];
+
+        result = compile_instruction(
+            a, create_opcode(byte1, byte2), static_cast<std::uint16_t>(address),
+            entry.length + 1U, entry.accurate_8xy6, entry.accurate_8xyE);
+        if (result == compiled::unsupported) {
+            break;
+        }
+
+        entry.source.push_back(byte1);
+        entry.source.push_back(byte2);
+        ++entry.length;
+        address += 2U;
+
+        if (result == compiled::block_end) {
+            break;
+        }
+    }
+
+    // The first instruction can't be compiled, so remember that and leave
+    // this address to the interpreter until its bytes change.
+    if (entry.length == 0) {
+        entry.source.push_back(ram[start]);
+        entry.source.push_back(ram[start + 1U]);
+        return;
+    }
+
+    if (result != compiled::block_end) {
+        emit_exit(a, exit_value(address, entry.length));
+    }
+
+    // Code space is never reclaimed piecemeal. Once the buffer is full every
+    // other block is dropped and the buffer is reused from the start.
+    if (code_used + a.code.size() > code_capacity) {
+        for (auto& other : blocks) {
+            if (&other != &entry && other.code != nullptr) {
+                other.source.clear();
+                other.code = nullptr;
+            }
+        }
+        code_used = 0;
+    }
+
+    entry.code = install(a.code);
+    if (entry.code != nullptr) {
+        ++jit_stats.compiled_blocks;
+    }
+}
+
+auto ch8::jit_compiler::interpret(chip8_system& system) -> trap
+{
+    auto& data = system.data;
+    const auto pc = std::size_t{data.program_counter};
+    ++jit_stats.interpreted_instructions;
+
+    if (data.waiting_for_keypress || pc + 1U >= data.ram.size()) {
+        return system.step();
+    }
+
+    const auto opcode = create_opcode(data.ram[pc], data.ram[pc + 1U]);
+    if (!writes_memory(opcode)) {
+        return system.step();
+    }
+
+    const auto first = std::size_t{data.i_register};
+    const auto last = last_written_address(data.i_register, opcode);
+    const auto result = system.step();
+    invalidate(first, last);
+
+    return result;
+}
+
+auto ch8::jit_compiler::install(const std::vector<std::uint8_t>& code)
+    -> native_block
+{
+#if defined(CH8_JIT_COMPILER)
+    if (code.size() > code_capacity) {
+        return nullptr;
+    }
+
+    if (code_memory == nullptr) {
+        auto* memory = mmap(
+            nullptr, code_capacity, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            return nullptr;
+        }
+        code_memory = static_cast<std::uint8_t*>(memory);
+        code_used = 0;
+    }
+    else if (mprotect(code_memory, code_capacity, PROT_READ | PROT_WRITE) !=
+             0) {
+        return nullptr;
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    auto* destination = code_memory + code_used;
+    std::memcpy(destination, code.data(), code.size());
+    code_used += code.size();
+
+    if (mprotect(code_memory, code_capacity, PROT_READ | PROT_EXEC) != 0) {
+        return nullptr;
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return reinterpret_cast<native_block>(destination);
+#else
+    static_cast<void>(code);
+    return nullptr;
+#endif
+}
+
+auto ch8::jit_compiler::release() noexcept -> void
+{
+#if defined(CH8_JIT_COMPILER)
+    if (code_memory != nullptr) {
+        munmap(code_memory, code_capacity);
+    }
+#endif
+    code_memory = nullptr;
+    code_used = 0;
+}
@@ -0,0 +1,67 @@
+#ifndef CH8_JIT_COMPILER_HPP
+#define CH8_JIT_COMPILER_HPP
+
+#include "ch8/instruction.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ch8 {
+    struct chip8_data;
+
+    class jit_compiler {
+    public:
+        struct statistics {
+            std::uint64_t compiled_blocks;
+            std::uint64_t native_instructions;
+            std::uint64_t interpreted_instructions;
+            std::uint64_t invalidations;
+        };
+
+        static constexpr auto max_block_length = std::size_t{64};
+        static constexpr auto hot_threshold = std::uint16_t{8};
+        static constexpr auto code_capacity = std::size_t{256 * 1024};
+
+        [[nodiscard]] static auto supported() noexcept -> bool;
+
+        jit_compiler() noexcept;
+        jit_compiler(const jit_compiler& other) noexcept;
+        jit_compiler(jit_compiler&& other) noexcept;
+        ~jit_compiler();
+
+        auto operator=(const jit_compiler& other) noexcept -> jit_compiler&;
+        auto operator=(jit_compiler&& other) noexcept -> jit_compiler&;
+
+        auto run(chip8_system& system, std::size_t instruction_count) -> trap;
+        auto invalidate(std::size_t first, std::size_t last) noexcept -> void;
+        auto clear() noexcept -> void;
+
+        [[nodiscard]] auto stats() const noexcept -> const statistics&;
+
+    private:
+        using native_block = auto (*)(chip8_data* data) -> std::uint32_t;
+
+        struct block {
+            std::vector<std::uint8_t> source;
+            native_block code;
+            std::size_t length;
+            std::uint64_t verified;
+            bool accurate_8xy6;
+            bool accurate_8xyE;
+        };
+
+        auto compile(const chip8_system& system, std::size_t start) -> void;
+        auto interpret(chip8_system& system) -> trap;
+        auto install(const std::vector<std::uint8_t>& code) -> native_block;
+        auto release() noexcept -> void;
+
+        std::vector<block> blocks;
+        std::vector<std::uint16_t> heat;
+        std::uint8_t* code_memory;
+        std::size_t code_used;
+        std::uint64_t generation;
+        statistics jit_stats;
+    };
+} // namespace ch8
+
+#endif // CH8_JIT_COMPILER_HPP
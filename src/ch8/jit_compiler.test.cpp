@@ -0,0 +1,310 @@
+#include "ch8/jit_compiler.hpp"
+#include "ch8/system.hpp"
+#include "ch8/system_state.test.hpp"
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+
+constexpr auto jit_workload = std::array<std::uint8_t, 44>{
+    0x60, 0x00, // 200: LD V0, 0x00
+    0x61, 0x9C, // 202: LD V1, 0x9C
+    0x70, 0x03, // 204: ADD V0, 0x03
+    0x82, 0x04, // 206: ADD V2, V0
+    0x83, 0x15, // 208: SUB V3, V1
+    0x84, 0x27, // 20A: SUBN V4, V2
+    0x85, 0x36, // 20C: SHR V5, V3
+    0x86, 0x4E, // 20E: SHL V6, V4
+    0x87, 0x51, // 210: OR V7, V5
+    0x88, 0x62, // 212: AND V8, V6
+    0x89, 0x73, // 214: XOR V9, V7
+    0xA3, 0x00, // 216: LD I, 0x300
+    0xF0, 0x1E, // 218: ADD I, V0
+    0x9F, 0x20, // 21A: SNE VF, V2
+    0xF5, 0x29, // 21C: LD F, V5
+    0x5F, 0x30, // 21E: SE VF, V3
+    0x22, 0x28, // 220: CALL 0x228
+    0x30, 0x7E, // 222: SE V0, 0x7E
+    0x12, 0x04, // 224: JP 0x204
+    0x12, 0x00, // 226: JP 0x200
+    0xD0, 0x15, // 228: DRW V0, V1, 5
+    0x00, 0xEE, // 22A: RET
+};
+
+TEST_CASE("jit_compiler::run leaves chip8_data in the same state as step()")
+{
+    const auto instruction_count = GENERATE(1U, 9U, 64U, 500U, 5000U);
+    const auto accurate = GENERATE(false, true);
+
+    auto stepped = ch8::chip8_system{};
+    auto compiled = ch8::chip8_system{};
+    auto compiler = ch8::jit_compiler{};
+
+    for (auto* system : {&stepped, &compiled}) {
+        load(*system, jit_workload);
+        system->accurate_8xy6 = accurate;
+        system->accurate_8xyE = accurate;
+    }
+
+    for (auto i = 0U; i < instruction_count; ++i) {
+        stepped.step();
+    }
+    compiler.run(compiled, instruction_count);
+
+    require_same_state(compiled.data, stepped.data);
+}
+
+TEST_CASE("jit_compiler::run matches step() for every register pair")
+{
+    const auto low_nibble =
+        GENERATE(0x0U, 0x1U, 0x2U, 0x3U, 0x4U, 0x5U, 0x6U, 0x7U, 0xEU);
+    const auto accurate = GENERATE(false, true);
+
+    for (auto x = 0U; x < 16U; ++x) {
+        for (auto y = 0U; y < 16U; ++y) {
+            const auto rom = std::array<std::uint8_t, 6>{
+                static_cast<std::uint8_t>(0x80U | x),
+                static_cast<std::uint8_t>((y << 4U) | low_nibble),
+                static_cast<std::uint8_t>(0x70U | y),
+                0x35,       // ADD Vy, 0x35
+                0x12, 0x00, // JP 0x200
+            };
+
+            auto stepped = ch8::chip8_system{};
+            auto compiled = ch8::chip8_system{};
+            auto compiler = ch8::jit_compiler{};
+
+            for (auto* system : {&stepped, &compiled}) {
+                load(*system, rom);
+                system->accurate_8xy6 = accurate;
+                system->accurate_8xyE = accurate;
+                for (auto i = std::size_t{0}; i < 16; ++i) {
+                    system->data.registers.at(i) =
+                        static_cast<std::uint8_t>(i * 37U + 11U);
+                }
+            }
+
+            for (auto i = 0; i < 300; ++i) {
+                stepped.step();
+            }
+            compiler.run(compiled, 300);
+
+            require_same_state(compiled.data, stepped.data);
+        }
+    }
+}
+
+TEST_CASE("jit_compiler::run compiles hot blocks")
+{
+    if (!ch8::jit_compiler::supported()) {
+        return;
+    }
+
+    constexpr auto rom = std::array<std::uint8_t, 4>{
+        0x70, 0x01, // 200: ADD V0, 0x01
+        0x12, 0x00, // 202: JP 0x200
+    };
+
+    auto system = ch8::chip8_system{};
+    auto compiler = ch8::jit_compiler{};
+    load(system, rom);
+
+    compiler.run(system, 200);
+
+    REQUIRE(system.data.registers.at(0) == 100);
+    REQUIRE(compiler.stats().compiled_blocks == 1);
+    REQUIRE(
+        compiler.stats().interpreted_instructions ==
+        (ch8::jit_compiler::hot_threshold - 1U) * 2U);
+    REQUIRE(
+        compiler.stats().native_instructions ==
+        200U - compiler.stats().interpreted_instructions);
+}
+
+TEST_CASE("jit_compiler::run recompiles code written to ram by the host")
+{
+    constexpr auto rom = std::array<std::uint8_t, 4>{
+        0x60, 0x05, // 200: LD V0, 0x05
+        0x12, 0x00, // 202: JP 0x200
+    };
+
+    auto system = ch8::chip8_system{};
+    auto compiler = ch8::jit_compiler{};
+    load(system, rom);
+
+    compiler.run(system, 100);
+    REQUIRE(system.data.registers.at(0) == 0x05);
+
+    system.data.ram.at(0x201) = 0x07;
+    compiler.run(system, 100);
+
+    REQUIRE(system.data.registers.at(0) == 0x07);
+    if (ch8::jit_compiler::supported()) {
+        REQUIRE(compiler.stats().invalidations == 1);
+    }
+}
+
+TEST_CASE("jit_compiler::run executes code rewritten by Fx55")
+{
+    constexpr auto rom = std::array<std::uint8_t, 14>{
+        0x70, 0x01, // 200: ADD V0, 0x01
+        0x71, 0x01, // 202: ADD V1, 0x01
+        0x31, 0x40, // 204: SE V1, 0x40
+        0x12, 0x00, // 206: JP 0x200
+        0xA2, 0x01, // 208: LD I, 0x201
+        0xF0, 0x55, // 20A: LD [I], V0
+        0x12, 0x00, // 20C: JP 0x200
+    };
+
+    auto stepped = ch8::chip8_system{};
+    auto compiled = ch8::chip8_system{};
+    auto compiler = ch8::jit_compiler{};
+    load(stepped, rom);
+    load(compiled, rom);
+
+    for (auto i = 0; i < 2000; ++i) {
+        stepped.step();
+    }
+    compiler.run(compiled, 2000);
+
+    require_same_state(compiled.data, stepped.data);
+}
+
+TEST_CASE("jit_compiler::run traps on stack overflow the same way as step()")
+{
+    constexpr auto rom = std::array<std::uint8_t, 4>{
+        0x70, 0x01, // 200: ADD V0, 0x01
+        0x22, 0x00, // 202: CALL 0x200
+    };
+
+    auto stepped = ch8::chip8_system{};
+    auto compiled = ch8::chip8_system{};
+    auto compiler = ch8::jit_compiler{};
+    load(stepped, rom);
+    load(compiled, rom);
+
+    auto result = ch8::trap::none;
+    for (auto i = 0; i < 100 && result == ch8::trap::none; ++i) {
+        result = stepped.step();
+    }
+
+    REQUIRE(result == ch8::trap::stack_overflow);
+    REQUIRE(compiler.run(compiled, 100) == ch8::trap::stack_overflow);
+    require_same_state(compiled.data, stepped.data);
+}
+
+TEST_CASE("jit_compiler::run wraps reads past ram the same way as step()")
+{
+    constexpr auto rom = std::array<std::uint8_t, 10>{
+        0x65, 0x01, // 200: LD V5, 0x01
+        0xAF, 0xF0, // 202: LD I, 0xFF0
+        0xF3, 0x65, // 204: LD V3, [I]
+        0xF5, 0x1E, // 206: ADD I, V5
+        0x12, 0x04, // 208: JP 0x204
+    };
+
+    auto stepped = ch8::chip8_system{};
+    auto compiled = ch8::chip8_system{};
+    auto compiler = ch8::jit_compiler{};
+    load(stepped, rom);
+    load(compiled, rom);
+
+    for (auto i = 0; i < 300; ++i) {
+        REQUIRE(stepped.step() == ch8::trap::none);
+    }
+    REQUIRE(compiler.run(compiled, 300) == ch8::trap::none);
+
+    require_same_state(compiled.data, stepped.data);
+}
+
+TEST_CASE("jit_compiler::run recompiles when a quirk changes")
+{
+    constexpr auto rom = std::array<std::uint8_t, 6>{
+        0x81, 0x26, // 200: SHR V1, V2
+        0x72, 0x01, // 202: ADD V2, 0x01
+        0x12, 0x00, // 204: JP 0x200
+    };
+
+    auto stepped = ch8::chip8_system{};
+    auto compiled = ch8::chip8_system{};
+    auto compiler = ch8::jit_compiler{};
+    load(stepped, rom);
+    load(compiled, rom);
+
+    for (const auto accurate : {false, true, false}) {
+        stepped.accurate_8xy6 = accurate;
+        compiled.accurate_8xy6 = accurate;
+
+        for (auto i = 0; i < 90; ++i) {
+            stepped.step();
+        }
+        compiler.run(compiled, 90);
+
+        require_same_state(compiled.data, stepped.data);
+    }
+}
+
+TEST_CASE("jit_compiler::run waits on Fx0A the same way as step()")
+{
+    constexpr auto rom = std::array<std::uint8_t, 6>{
+        0xF3, 0x0A, // 200: LD V3, K
+        0x70, 0x01, // 202: ADD V0, 0x01
+        0x12, 0x02, // 204: JP 0x202
+    };
+
+    auto stepped = ch8::chip8_system{};
+    auto compiled = ch8::chip8_system{};
+    auto compiler = ch8::jit_compiler{};
+    load(stepped, rom);
+    load(compiled, rom);
+
+    for (auto i = 0; i < 50; ++i) {
+        stepped.step();
+    }
+    compiler.run(compiled, 50);
+    require_same_state(compiled.data, stepped.data);
+
+    stepped.data.keypad.set(0x4);
+    compiled.data.keypad.set(0x4);
+    stepped.step();
+    compiler.run(compiled, 1);
+    require_same_state(compiled.data, stepped.data);
+
+    stepped.data.keypad.reset();
+    compiled.data.keypad.reset();
+    for (auto i = 0; i < 50; ++i) {
+        stepped.step();
+    }
+    compiler.run(compiled, 50);
+    require_same_state(compiled.data, stepped.data);
+}
+
+TEST_CASE("jit_compiler copies start without compiled code")
+{
+    constexpr auto rom = std::array<std::uint8_t, 4>{
+        0x70, 0x01, // 200: ADD V0, 0x01
+        0x12, 0x00, // 202: JP 0x200
+    };
+
+    auto system = ch8::chip8_system{};
+    auto compiler = ch8::jit_compiler{};
+    load(system, rom);
+    compiler.run(system, 100);
+
+    auto copy = compiler;
+    copy.run(system, 100);
+
+    REQUIRE(system.data.registers.at(0) == 100);
+    REQUIRE(copy.stats().native_instructions < 100);
+}
+
+TEST_CASE("chip8_system::execute uses the JIT compiler for the jit engine")
+{
+    auto system = ch8::chip8_system{};
+    system.engine = ch8::execution_engine::jit;
+    system.updates_per_second = 1000;
+
+    system.execute(std::chrono::milliseconds{1});
+
+    REQUIRE(system.jit_stats().interpreted_instructions == 1);
+    REQUIRE(system.data.program_counter == 0x202);
+}
@@ -0,0 +1,105 @@
+#include "ch8/machine_events.hpp"
+#include "ch8/system.hpp"
+#include <gsl-lite/gsl-lite.hpp>
+
+auto ch8::machine_events::detach(
+    const machine_event event, const observer_handle handle) -> bool
+{
+    auto detached = false;
+    switch (event) {
+    case machine_event::trap:
+        detached = on_trap.detach(handle);
+        break;
+    case machine_event::memory_write:
+        detached = on_memory_write.detach(handle);
+        break;
+    default:
+        detached =
+            on_signal.at(static_cast<std::size_t>(event)).detach(handle);
+        break;
+    }
+
+    update_mask(event);
+    return detached;
+}
+
+auto ch8::machine_events::watch(const memory_range range) noexcept -> void
+{
+    gsl_Expects(range.first <= range.last && range.last <= 0xFFF);
+    watched_range = range;
+}
+
+auto ch8::machine_events::watched() const noexcept -> const memory_range&
+{
+    return watched_range;
+}
+
+// The state is followed whether or not anyone observes it, so attaching an
+// observer doesn't report a change that happened long before.
+auto ch8::machine_events::sync(const chip8_data& data) -> void
+{
+    const auto sound = data.sound_timer > 0;
+    if (sound != sound_playing) {
+        sound_playing = sound;
+        const auto event =
+            sound ? machine_event::sound_start : machine_event::sound_stop;
+        if (observed(event)) {
+            on_signal[static_cast<std::size_t>(event)].notify();
+        }
+    }
+
+    const auto waiting = data.waiting_for_keypress;
+    if (waiting != waiting_for_key) {
+        waiting_for_key = waiting;
+        const auto event = waiting ? machine_event::key_wait_start
+                                   : machine_event::key_wait_end;
+        if (observed(event)) {
+            on_signal[static_cast<std::size_t>(event)].notify();
+        }
+    }
+}
+
+auto ch8::machine_events::update_mask(const machine_event event) -> void
+{
+    auto empty = true;
+    switch (event) {
+    case machine_event::trap:
+        empty = on_trap.empty();
+        break;
+    case machine_event::memory_write:
+        empty = on_memory_write.empty();
+        break;
+    default:
+        empty = on_signal.at(static_cast<std::size_t>(event)).empty();
+        break;
+    }
+
+    observed_mask = empty ? observed_mask & ~bit(event)
+                          : observed_mask | bit(event);
+}
+
+// Addresses wrap around ram like memory_at does, so a write crossing the end
+// is reported as two ranges.
+auto ch8::machine_events::notify_write(
+    const std::size_t first, const std::size_t last) -> void
+{
+    constexpr auto end = std::size_t{0x1000};
+
+    const auto report = [this](const std::size_t from, const std::size_t to) {
+        const auto range = memory_range{
+            static_cast<std::uint16_t>(from), static_cast<std::uint16_t>(to)};
+        if (range.overlaps(watched_range)) {
+            on_memory_write.notify(range);
+        }
+    };
+
+    const auto start = first % end;
+    const auto stop = start + (last - first);
+    if (stop < end) {
+        report(start, stop);
+    }
+    else {
+        report(start, end - 1);
+        report(0, stop - end);
+    }
+}
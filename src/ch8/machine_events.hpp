@@ -0,0 +1,162 @@
+#ifndef CH8_MACHINE_EVENTS_HPP
+#define CH8_MACHINE_EVENTS_HPP
+
+#include "ch8/instruction.hpp"
+#include "ch8/observable.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace ch8 {
+    struct chip8_data;
+
+    // Trap observers get the trap and memory write observers the range that
+    // was written. The rest take no arguments.
+    enum class machine_event {
+        sound_start,
+        sound_stop,
+        key_wait_start,
+        key_wait_end,
+        delay_timer_zero,
+        trap,
+        memory_write
+    };
+
+    // An inclusive range of ram addresses.
+    struct memory_range {
+        std::uint16_t first;
+        std::uint16_t last;
+
+        [[nodiscard]] constexpr auto overlaps(const memory_range& other) const
+            noexcept -> bool;
+    };
+
+    // The signals a host needs to drive audio and input without polling
+    // chip8_data. Each event has a bit in a mask of the events with
+    // observers, so where an event is raised on the hot path, nobody
+    // observing it costs one bit test.
+    //
+    // Sound and the Fx0A key wait are compared with what they were at the
+    // last sync, since every engine changes them its own way. chip8_system
+    // syncs at each timer tick and whenever a run ends.
+    class machine_events {
+    public:
+        template <machine_event Event, typename Callback>
+        auto attach(Callback&& observer) -> observer_handle;
+        // Returns false if the observer was already detached.
+        auto detach(machine_event event, observer_handle handle) -> bool;
+
+        [[nodiscard]] auto observed(machine_event event) const noexcept
+            -> bool;
+
+        // Only writes overlapping range are reported. It starts as the whole
+        // of ram.
+        auto watch(memory_range range) noexcept -> void;
+        [[nodiscard]] auto watched() const noexcept -> const memory_range&;
+
+        auto sync(const chip8_data& data) -> void;
+        auto delay_timer_zero() -> void;
+        auto trapped(trap reason) -> void;
+        auto wrote(std::size_t first, std::size_t last) -> void;
+
+    private:
+        static constexpr auto signals = std::size_t{5};
+
+        [[nodiscard]] static constexpr auto bit(machine_event event) noexcept
+            -> std::uint32_t;
+        auto update_mask(machine_event event) -> void;
+        auto notify_write(std::size_t first, std::size_t last) -> void;
+
+        std::array<observable<>, signals> on_signal;
+        observable<trap> on_trap;
+        observable<const memory_range&> on_memory_write;
+        memory_range watched_range{0x000, 0xFFF};
+        std::uint32_t observed_mask{0};
+        bool sound_playing{false};
+        bool waiting_for_key{false};
+    };
+} // namespace ch8
+
+namespace ch8::detail {
+    // Attaches observer to event, wrapping it to drop the event's arguments
+    // if it takes none.
+    template <typename... Args, typename Callback>
+    auto attach_observer(observable<Args...>& event, Callback&& observer)
+        -> observer_handle
+    {
+        if constexpr (std::is_invocable_v<Callback&, Args...>) {
+            return event.attach(std::forward<Callback>(observer));
+        }
+        else {
+            return event.attach(
+                [observer = std::forward<Callback>(observer)](
+                    Args...) mutable { observer(); });
+        }
+    }
+} // namespace ch8::detail
+
+constexpr auto ch8::memory_range::overlaps(const memory_range& other) const
+    noexcept -> bool
+{
+    return first <= other.last && other.first <= last;
+}
+
+constexpr auto ch8::machine_events::bit(const machine_event event) noexcept
+    -> std::uint32_t
+{
+    return std::uint32_t{1} << static_cast<std::uint32_t>(event);
+}
+
+template <ch8::machine_event Event, typename Callback>
+auto ch8::machine_events::attach(Callback&& observer) -> observer_handle
+{
+    auto handle = observer_handle{0};
+    if constexpr (Event == machine_event::trap) {
+        handle = detail::attach_observer(
+            on_trap, std::forward<Callback>(observer));
+    }
+    else if constexpr (Event == machine_event::memory_write) {
+        handle = detail::attach_observer(
+            on_memory_write, std::forward<Callback>(observer));
+    }
+    else {
+        handle = on_signal[static_cast<std::size_t>(Event)].attach(
+            std::forward<Callback>(observer));
+    }
+
+    update_mask(Event);
+    return handle;
+}
+
+inline auto ch8::machine_events::observed(const machine_event event) const
+    noexcept -> bool
+{
+    return (observed_mask & bit(event)) != 0;
+}
+
+inline auto ch8::machine_events::delay_timer_zero() -> void
+{
+    if (observed(machine_event::delay_timer_zero)) {
+        on_signal[static_cast<std::size_t>(machine_event::delay_timer_zero)]
+            .notify();
+    }
+}
+
+inline auto ch8::machine_events::trapped(const trap reason) -> void
+{
+    if (observed(machine_event::trap)) {
+        on_trap.notify(reason);
+    }
+}
+
+inline auto ch8::machine_events::wrote(
+    const std::size_t first, const std::size_t last) -> void
+{
+    if (observed(machine_event::memory_write)) {
+        notify_write(first, last);
+    }
+}
+
+#endif // CH8_MACHINE_EVENTS_HPP
@@ -0,0 +1,83 @@
+#include "ch8/machine_events.hpp"
+#include "ch8/system.hpp"
+#include <catch2/catch.hpp>
+#include <vector>
+
+TEST_CASE("machine_events::observed follows attaching and detaching")
+{
+    auto events = ch8::machine_events{};
+    REQUIRE_FALSE(events.observed(ch8::machine_event::sound_start));
+
+    const auto handle =
+        events.attach<ch8::machine_event::sound_start>([]() {});
+    REQUIRE(events.observed(ch8::machine_event::sound_start));
+    REQUIRE_FALSE(events.observed(ch8::machine_event::sound_stop));
+
+    REQUIRE(events.detach(ch8::machine_event::sound_start, handle));
+    REQUIRE_FALSE(events.observed(ch8::machine_event::sound_start));
+}
+
+TEST_CASE("machine_events::sync only reports changes")
+{
+    auto events = ch8::machine_events{};
+    auto starts = 0;
+    auto stops = 0;
+    events.attach<ch8::machine_event::sound_start>([&starts]() { ++starts; });
+    events.attach<ch8::machine_event::sound_stop>([&stops]() { ++stops; });
+
+    auto data = ch8::chip8_data{};
+    events.sync(data);
+    data.sound_timer = 5;
+    events.sync(data);
+    data.sound_timer = 4;
+    events.sync(data);
+    data.sound_timer = 0;
+    events.sync(data);
+
+    REQUIRE(starts == 1);
+    REQUIRE(stops == 1);
+}
+
+TEST_CASE("machine_events::wrote only reports writes to the watched range")
+{
+    auto events = ch8::machine_events{};
+    auto writes = std::vector<ch8::memory_range>{};
+    events.attach<ch8::machine_event::memory_write>(
+        [&writes](const ch8::memory_range& range) { writes.push_back(range); });
+    events.watch({0x300, 0x30F});
+
+    events.wrote(0x2F0, 0x2FF);
+    events.wrote(0x2FE, 0x300);
+    events.wrote(0x310, 0x312);
+
+    REQUIRE(writes.size() == 1);
+    REQUIRE(writes[0].first == 0x2FE);
+    REQUIRE(writes[0].last == 0x300);
+}
+
+TEST_CASE("machine_events::wrote splits writes that wrap around ram")
+{
+    auto events = ch8::machine_events{};
+    auto writes = std::vector<ch8::memory_range>{};
+    events.attach<ch8::machine_event::memory_write>(
+        [&writes](const ch8::memory_range& range) { writes.push_back(range); });
+
+    events.wrote(0xFFE, 0x1001);
+    events.wrote(0x1FFF, 0x2000);
+
+    REQUIRE(writes.size() == 4);
+    REQUIRE((writes[0].first == 0xFFE && writes[0].last == 0xFFF));
+    REQUIRE((writes[1].first == 0x000 && writes[1].last == 0x001));
+    REQUIRE((writes[2].first == 0xFFF && writes[2].last == 0xFFF));
+    REQUIRE((writes[3].first == 0x000 && writes[3].last == 0x000));
+}
+
+TEST_CASE("machine_events accepts observers that ignore the arguments")
+{
+    auto events = ch8::machine_events{};
+    auto traps = 0;
+    events.attach<ch8::machine_event::trap>([&traps]() { ++traps; });
+
+    events.trapped(ch8::trap::unknown_opcode);
+    REQUIRE(traps == 1);
+}
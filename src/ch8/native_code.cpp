@@ -0,0 +1,82 @@
+#include "ch8/native_code.hpp"
+#include "ch8/system.hpp"
+#include <algorithm>
+#include <tuple>
+
+ch8::native_code::native_code() noexcept
+    : entries{}, loaded{nullptr, 0, nullptr, 0}, native_stats{0, 0, 0}
+{
+}
+
+// Blocks outside the module's program can't be checked against it, so they
+// are left out and that code is interpreted.
+auto ch8::native_code::load(const native_module& module) -> void
+{
+    clear();
+    loaded = module;
+    entries.assign(std::tuple_size_v<decltype(chip8_data::ram)>, nullptr);
+
+    const auto program_end = chip8_data::program_start + module.program_size;
+    for (auto i = std::size_t{0}; i < module.block_count; ++i) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const auto& block = module.blocks[i];
+        const auto end = std::size_t{block.address} + block.size;
+        if (block.address >= chip8_data::program_start && end <= program_end) {
+            entries[block.address] = &block;
+        }
+    }
+}
+
+auto ch8::native_code::run(
+    chip8_system& system, const std::size_t instruction_count) -> trap
+{
+    auto remaining = instruction_count;
+    while (remaining > 0) {
+        const auto pc = std::size_t{system.data.program_counter};
+        const auto* block = pc < entries.size() ? entries[pc] : nullptr;
+
+        if (block != nullptr && block->instructions <= remaining) {
+            if (matches(system, *block)) {
+                const auto result = block->run(system);
+                if (result != trap::none) {
+                    return result;
+                }
+                remaining -= block->instructions;
+                native_stats.native_instructions += block->instructions;
+                continue;
+            }
+            ++native_stats.stale_blocks;
+        }
+
+        const auto result = system.step();
+        if (result != trap::none) {
+            return result;
+        }
+        --remaining;
+        ++native_stats.interpreted_instructions;
+    }
+
+    return trap::none;
+}
+
+auto ch8::native_code::clear() noexcept -> void
+{
+    entries.clear();
+    loaded = native_module{nullptr, 0, nullptr, 0};
+}
+
+auto ch8::native_code::stats() const noexcept -> const statistics&
+{
+    return native_stats;
+}
+
+auto ch8::native_code::matches(
+    const chip8_system& system, const native_block& block) const noexcept
+    -> bool
+{
+    const auto offset = block.address - chip8_data::program_start;
+    const auto begin = system.data.ram.begin() + block.address;
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    return std::equal(begin, begin + block.size, loaded.program + offset);
+}
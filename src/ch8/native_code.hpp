@@ -0,0 +1,59 @@
+#ifndef CH8_NATIVE_CODE_HPP
+#define CH8_NATIVE_CODE_HPP
+
+#include "ch8/instruction.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ch8 {
+    using native_function = auto (*)(chip8_system& system) -> trap;
+
+    // A basic block translated to C++ ahead of time by chip8-aot. size is in
+    // bytes of program memory.
+    struct native_block {
+        std::uint16_t address;
+        std::uint16_t size;
+        std::uint16_t instructions;
+        native_function run;
+    };
+
+    // Everything chip8-aot emits for one program. The program is kept so
+    // blocks whose code has since been overwritten can be detected.
+    struct native_module {
+        const std::uint8_t* program;
+        std::size_t program_size;
+        const native_block* blocks;
+        std::size_t block_count;
+    };
+
+    // Runs the blocks of a native_module, falling back to the interpreter
+    // wherever there is no block or the block no longer matches ram.
+    class native_code {
+    public:
+        struct statistics {
+            std::uint64_t native_instructions;
+            std::uint64_t interpreted_instructions;
+            std::uint64_t stale_blocks;
+        };
+
+        native_code() noexcept;
+
+        auto load(const native_module& module) -> void;
+        auto run(chip8_system& system, std::size_t instruction_count) -> trap;
+        auto clear() noexcept -> void;
+
+        [[nodiscard]] auto stats() const noexcept -> const statistics&;
+
+    private:
+        [[nodiscard]] auto
+        matches(const chip8_system& system, const native_block& block) const
+            noexcept -> bool;
+
+        std::vector<const native_block*> entries;
+        native_module loaded;
+        statistics native_stats;
+    };
+} // namespace ch8
+
+#endif // CH8_NATIVE_CODE_HPP
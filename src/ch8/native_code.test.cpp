@@ -0,0 +1,133 @@
+#include "ch8/native_code.hpp"
+#include "ch8/system.hpp"
+#include "ch8/system_state.test.hpp"
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+
+constexpr auto native_program = std::array<std::uint8_t, 8>{
+    0x70, 0x01, // 200: ADD V0, 0x01
+    0x81, 0x04, // 202: ADD V1, V0
+    0x12, 0x00, // 204: JP 0x200
+    0x22, 0x06, // 206: CALL 0x206
+};
+
+// What chip8-aot emits for the block at 0x200.
+auto native_block_200(ch8::chip8_system& system) -> ch8::trap
+{
+    auto& v = system.data.registers;
+    v.at(0x0) = static_cast<std::uint8_t>(v.at(0x0) + 0x01);
+    const auto sum = v.at(0x1) + v.at(0x0);
+    v.at(0x1) = static_cast<std::uint8_t>(sum);
+    v.at(0xF) = static_cast<std::uint8_t>(sum > 0xFF);
+    system.data.program_counter = 0x200;
+    return ch8::trap::none;
+}
+
+auto native_block_206(ch8::chip8_system& system) -> ch8::trap
+{
+    system.data.program_counter = 0x206;
+    return system.step();
+}
+
+constexpr auto native_blocks = std::array<ch8::native_block, 2>{{
+    {0x200, 6, 3, native_block_200},
+    {0x206, 2, 1, native_block_206},
+}};
+
+constexpr auto native_test_module = ch8::native_module{
+    native_program.data(), native_program.size(), native_blocks.data(),
+    native_blocks.size()};
+
+TEST_CASE("native_code::run leaves chip8_data in the same state as step()")
+{
+    const auto instruction_count = GENERATE(1U, 2U, 3U, 4U, 100U, 1000U);
+
+    auto stepped = ch8::chip8_system{};
+    auto native = ch8::chip8_system{};
+    auto code = ch8::native_code{};
+    code.load(native_test_module);
+    load(stepped, native_program);
+    load(native, native_program);
+
+    for (auto i = 0U; i < instruction_count; ++i) {
+        stepped.step();
+    }
+    code.run(native, instruction_count);
+
+    require_same_state(native.data, stepped.data);
+    REQUIRE(
+        code.stats().native_instructions +
+            code.stats().interpreted_instructions ==
+        instruction_count);
+    REQUIRE(code.stats().native_instructions == instruction_count / 3U * 3U);
+}
+
+TEST_CASE("native_code::run interprets blocks whose code was overwritten")
+{
+    auto stepped = ch8::chip8_system{};
+    auto native = ch8::chip8_system{};
+    auto code = ch8::native_code{};
+    code.load(native_test_module);
+    load(stepped, native_program);
+    load(native, native_program);
+
+    stepped.data.ram.at(0x201) = 0x05;
+    native.data.ram.at(0x201) = 0x05;
+
+    for (auto i = 0; i < 30; ++i) {
+        stepped.step();
+    }
+    code.run(native, 30);
+
+    require_same_state(native.data, stepped.data);
+    REQUIRE(code.stats().native_instructions == 0);
+    REQUIRE(code.stats().stale_blocks == 10);
+}
+
+TEST_CASE("native_code::run interprets code without a block")
+{
+    static constexpr auto program = std::array<std::uint8_t, 6>{
+        0x60, 0x02, // 200: LD V0, 0x02
+        0xB2, 0x02, // 202: JP V0, 0x202
+        0x12, 0x00, // 204: JP 0x200
+    };
+    constexpr auto module =
+        ch8::native_module{program.data(), program.size(), nullptr, 0};
+
+    auto system = ch8::chip8_system{};
+    auto code = ch8::native_code{};
+    code.load(module);
+    load(system, program);
+
+    REQUIRE(code.run(system, 9) == ch8::trap::none);
+    REQUIRE(system.data.program_counter == 0x200);
+    REQUIRE(code.stats().interpreted_instructions == 9);
+}
+
+TEST_CASE("native_code::run returns traps raised by a block")
+{
+    auto system = ch8::chip8_system{};
+    auto code = ch8::native_code{};
+    code.load(native_test_module);
+    load(system, native_program);
+    system.data.program_counter = 0x206;
+
+    REQUIRE(code.run(system, 100) == ch8::trap::stack_overflow);
+    REQUIRE(system.data.program_counter == 0x206);
+    REQUIRE(system.data.stack_pointer == 15);
+}
+
+TEST_CASE("chip8_system::execute uses native code for the native engine")
+{
+    auto system = ch8::chip8_system{};
+    load(system, native_program);
+    system.load_native(native_test_module);
+    system.engine = ch8::execution_engine::native;
+    system.updates_per_second = 1000;
+
+    system.execute(std::chrono::milliseconds{6});
+
+    REQUIRE(system.native_stats().native_instructions == 6);
+    REQUIRE(system.data.registers.at(0) == 2);
+}
@@ -0,0 +1,99 @@
+#include "ch8/observable.hpp"
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr auto notifications = 1'000;
+
+    // What observable held before it had its own delegate.
+    class function_observable {
+    public:
+        auto attach(std::function<void(int)> observer) -> void
+        {
+            observers.emplace_back(std::move(observer));
+        }
+
+        auto notify(int value) -> void
+        {
+            for (auto& observer : observers) {
+                observer(value);
+            }
+        }
+
+    private:
+        std::vector<std::function<void(int)>> observers;
+    };
+
+    template <typename Observable>
+    auto notify_all(Observable& observable) -> void
+    {
+        for (auto i = 0; i < notifications; ++i) {
+            observable.notify(i);
+        }
+    }
+
+    auto benchmark_runtime(std::size_t observer_count) -> void
+    {
+        auto total = std::int64_t{0};
+        auto functions = function_observable{};
+        auto delegates = ch8::observable<int>{};
+        for (auto i = std::size_t{0}; i < observer_count; ++i) {
+            functions.attach([&total](int value) { total += value; });
+            delegates.attach([&total](int value) { total += value; });
+        }
+
+        const auto suffix = ", " + std::to_string(observer_count) +
+                            " observers, " + std::to_string(notifications) +
+                            " notifications";
+
+        BENCHMARK("std::function" + suffix)
+        {
+            notify_all(functions);
+            return total;
+        };
+
+        BENCHMARK("observable" + suffix)
+        {
+            notify_all(delegates);
+            return total;
+        };
+    }
+} // namespace
+
+TEST_CASE("observable::notify", "[benchmark]")
+{
+    benchmark_runtime(0);
+    benchmark_runtime(1);
+    benchmark_runtime(4);
+}
+
+TEST_CASE("static_observable::notify", "[benchmark]")
+{
+    auto total = std::int64_t{0};
+    const auto add = [&total](int value) { total += value; };
+
+    auto none = ch8::static_observable<>{};
+    auto one = ch8::static_observable{add};
+    auto four = ch8::static_observable{add, add, add, add};
+
+    BENCHMARK("0 observers, 1000 notifications")
+    {
+        notify_all(none);
+        return total;
+    };
+
+    BENCHMARK("1 observers, 1000 notifications")
+    {
+        notify_all(one);
+        return total;
+    };
+
+    BENCHMARK("4 observers, 1000 notifications")
+    {
+        notify_all(four);
+        return total;
+    };
+}
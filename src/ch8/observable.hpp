@@ -2,29 +2,430 @@
 #define CH8_OBSERVABLE_HPP
 
 #include <algorithm>
-#include <functional>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <gsl-lite/gsl-lite.hpp>
+#include <new>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace ch8 {
+    template <typename Signature>
+    class delegate;
+
+    // A copyable callable like std::function, except that callables of up to
+    // three pointers, such as lambdas capturing a few references, are kept
+    // inline instead of on the heap.
+    template <typename... Args>
+    class delegate<void(Args...)> {
+    public:
+        static constexpr auto capacity = 3 * sizeof(void*);
+
+        delegate() noexcept = default;
+        template <
+            typename Callable,
+            typename = std::enable_if_t<
+                !std::is_same_v<std::decay_t<Callable>, delegate>>>
+        explicit delegate(Callable&& callable);
+        delegate(const delegate& other);
+        delegate(delegate&& other) noexcept;
+        ~delegate();
+
+        auto operator=(const delegate& other) -> delegate&;
+        auto operator=(delegate&& other) noexcept -> delegate&;
+
+        explicit operator bool() const noexcept;
+        auto operator()(Args... args) -> void;
+
+    private:
+        struct operations {
+            void (*invoke)(void* target, Args... args);
+            void (*copy)(const void* from, void* to);
+            void (*move)(void* from, void* to) noexcept;
+            void (*destroy)(void* target) noexcept;
+        };
+
+        template <typename Callable>
+        static constexpr auto fits_inline() noexcept -> bool;
+        template <typename Callable>
+        struct inline_target;
+        template <typename Callable>
+        struct heap_target;
+        template <typename Callable>
+        static constexpr auto operations_for() noexcept -> operations;
+
+        auto reset() noexcept -> void;
+
+        alignas(void*) std::array<std::byte, capacity> storage{};
+        const operations* ops{nullptr};
+    };
+
+    // Identifies an attached observer until it is detached. Handles stay
+    // valid while other observers come and go.
+    struct observer_handle {
+        std::uint32_t id;
+    };
+
     template <typename... Args>
     class observable {
     public:
-        auto attach(std::function<void(Args...)> observer) -> void
-        {
-            observers.emplace_back(std::move(observer));
-        }
+        template <typename Callback>
+        auto attach(Callback&& observer) -> observer_handle;
+        // Returns false if the observer was already detached. Observers may
+        // detach themselves, or each other, while being notified.
+        auto detach(observer_handle handle) noexcept -> bool;
+        auto notify(Args... args) -> void;
 
-        auto notify(Args... args) -> void
-        {
-            for (auto& observer : observers) {
-                observer(args...);
-            }
-        }
+        [[nodiscard]] auto size() const noexcept -> std::size_t;
+        [[nodiscard]] auto empty() const noexcept -> bool;
 
     private:
-        std::vector<std::function<void(Args...)>> observers;
+        struct entry {
+            std::uint32_t id;
+            delegate<void(Args...)> observer;
+        };
+
+        auto end_notify() noexcept -> void;
+
+        std::vector<entry> entries;
+        std::uint32_t last_id{0};
+        std::size_t detached{0};
+        int notifying{0};
+    };
+
+    // Observers fixed at compile time. notify calls each of them directly,
+    // so they are inlined into the code doing the notifying, and with no
+    // observers it compiles to nothing.
+    template <typename... Observers>
+    class static_observable {
+    public:
+        constexpr static_observable() = default;
+        template <
+            typename... Callbacks,
+            typename = std::enable_if_t<
+                sizeof...(Callbacks) == sizeof...(Observers) &&
+                sizeof...(Callbacks) != 0 &&
+                (!std::is_same_v<std::decay_t<Callbacks>, static_observable> &&
+                 ...)>>
+        constexpr explicit static_observable(Callbacks&&... callbacks);
+
+        template <typename... Args>
+        constexpr auto notify(const Args&... args) -> void;
+
+        template <std::size_t Index>
+        [[nodiscard]] constexpr auto get() noexcept -> auto&;
+        template <std::size_t Index>
+        [[nodiscard]] constexpr auto get() const noexcept -> const auto&;
+
+        [[nodiscard]] static constexpr auto size() noexcept -> std::size_t;
+
+    private:
+        std::tuple<Observers...> observers;
     };
+
+    template <typename... Observers>
+    static_observable(Observers...) -> static_observable<Observers...>;
 } // namespace ch8
 
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define CH8_DELEGATE ch8::delegate<void(Args...)>
+
+template <typename... Args>
+template <typename Callable>
+struct CH8_DELEGATE::inline_target {
+    static auto invoke(void* target, Args... args) -> void
+    {
+        (*static_cast<Callable*>(target))(std::forward<Args>(args)...);
+    }
+
+    static auto copy(const void* from, void* to) -> void
+    {
+        new (to) Callable(*static_cast<const Callable*>(from));
+    }
+
+    static auto move(void* from, void* to) noexcept -> void
+    {
+        new (to) Callable(std::move(*static_cast<Callable*>(from)));
+        static_cast<Callable*>(from)->~Callable();
+    }
+
+    static auto destroy(void* target) noexcept -> void
+    {
+        static_cast<Callable*>(target)->~Callable();
+    }
+};
+
+// The storage holds a pointer to the callable.
+template <typename... Args>
+template <typename Callable>
+struct CH8_DELEGATE::heap_target {
+    static auto get(void* target) noexcept -> Callable*
+    {
+        return *static_cast<Callable**>(target);
+    }
+
+    static auto invoke(void* target, Args... args) -> void
+    {
+        (*get(target))(std::forward<Args>(args)...);
+    }
+
+    static auto copy(const void* from, void* to) -> void
+    {
+        const auto* const callable = *static_cast<Callable* const*>(from);
+        new (to) Callable*(new Callable(*callable));
+    }
+
+    static auto move(void* from, void* to) noexcept -> void
+    {
+        new (to) Callable*(get(from));
+    }
+
+    static auto destroy(void* target) noexcept -> void
+    {
+        delete get(target);
+    }
+};
+
+template <typename... Args>
+template <typename Callable>
+constexpr auto CH8_DELEGATE::fits_inline() noexcept -> bool
+{
+    return sizeof(Callable) <= capacity &&
+           alignof(Callable) <= alignof(void*) &&
+           std::is_nothrow_move_constructible_v<Callable>;
+}
+
+template <typename... Args>
+template <typename Callable>
+constexpr auto CH8_DELEGATE::operations_for() noexcept -> operations
+{
+    using target = std::conditional_t<
+        fits_inline<Callable>(), inline_target<Callable>,
+        heap_target<Callable>>;
+    return {&target::invoke, &target::copy, &target::move, &target::destroy};
+}
+
+template <typename... Args>
+template <typename Callable, typename>
+CH8_DELEGATE::delegate(Callable&& callable)
+{
+    using target = std::decay_t<Callable>;
+    static constexpr auto target_ops = operations_for<target>();
+
+    if constexpr (fits_inline<target>()) {
+        new (storage.data()) target(std::forward<Callable>(callable));
+    }
+    else {
+        auto* const on_heap = new target(std::forward<Callable>(callable));
+        new (storage.data()) target*(on_heap);
+    }
+    ops = &target_ops;
+}
+
+template <typename... Args>
+CH8_DELEGATE::delegate(const delegate& other) : ops{other.ops}
+{
+    if (ops != nullptr) {
+        ops->copy(other.storage.data(), storage.data());
+    }
+}
+
+template <typename... Args>
+CH8_DELEGATE::delegate(delegate&& other) noexcept : ops{other.ops}
+{
+    if (ops != nullptr) {
+        ops->move(other.storage.data(), storage.data());
+        other.ops = nullptr;
+    }
+}
+
+template <typename... Args>
+CH8_DELEGATE::~delegate()
+{
+    reset();
+}
+
+template <typename... Args>
+auto CH8_DELEGATE::operator=(const delegate& other) -> delegate&
+{
+    if (this != &other) {
+        *this = delegate{other};
+    }
+    return *this;
+}
+
+template <typename... Args>
+auto CH8_DELEGATE::operator=(delegate&& other) noexcept -> delegate&
+{
+    if (this != &other) {
+        reset();
+        ops = other.ops;
+        if (ops != nullptr) {
+            ops->move(other.storage.data(), storage.data());
+            other.ops = nullptr;
+        }
+    }
+    return *this;
+}
+
+template <typename... Args>
+CH8_DELEGATE::operator bool() const noexcept
+{
+    return ops != nullptr;
+}
+
+template <typename... Args>
+auto CH8_DELEGATE::operator()(Args... args) -> void
+{
+    gsl_Expects(ops != nullptr);
+    ops->invoke(storage.data(), std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+auto CH8_DELEGATE::reset() noexcept -> void
+{
+    if (ops != nullptr) {
+        ops->destroy(storage.data());
+        ops = nullptr;
+    }
+}
+
+#undef CH8_DELEGATE
+
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define CH8_OBSERVABLE ch8::observable<Args...>
+
+// Attaching while notifying could move the observer being called, so it
+// isn't allowed.
+template <typename... Args>
+template <typename Callback>
+auto CH8_OBSERVABLE::attach(Callback&& observer) -> observer_handle
+{
+    gsl_Expects(notifying == 0);
+
+    const auto id = ++last_id;
+    entries.push_back(
+        {id, delegate<void(Args...)>{std::forward<Callback>(observer)}});
+    return {id};
+}
+
+// Observers detached while notifying are only marked, and removed once
+// every notify has returned, since one of them may be the one running.
+template <typename... Args>
+auto CH8_OBSERVABLE::detach(const observer_handle handle) noexcept -> bool
+{
+    const auto found = std::find_if(
+        entries.begin(), entries.end(), [handle](const entry& e) {
+            return e.id == handle.id && e.id != 0;
+        });
+    if (found == entries.end()) {
+        return false;
+    }
+
+    if (notifying > 0) {
+        found->id = 0;
+        ++detached;
+    }
+    else {
+        entries.erase(found);
+    }
+    return true;
+}
+
+template <typename... Args>
+auto CH8_OBSERVABLE::notify(Args... args) -> void
+{
+    if (entries.empty()) {
+        return;
+    }
+
+    ++notifying;
+    try {
+        for (auto& e : entries) {
+            if (e.id != 0) {
+                e.observer(args...);
+            }
+        }
+    }
+    catch (...) {
+        end_notify();
+        throw;
+    }
+    end_notify();
+}
+
+// Also runs when an observer throws, so the observable can still be attached
+// to afterwards.
+template <typename... Args>
+auto CH8_OBSERVABLE::end_notify() noexcept -> void
+{
+    --notifying;
+    if (notifying == 0 && detached > 0) {
+        entries.erase(
+            std::remove_if(
+                entries.begin(), entries.end(),
+                [](const entry& e) { return e.id == 0; }),
+            entries.end());
+        detached = 0;
+    }
+}
+
+template <typename... Args>
+auto CH8_OBSERVABLE::size() const noexcept -> std::size_t
+{
+    return entries.size() - detached;
+}
+
+template <typename... Args>
+auto CH8_OBSERVABLE::empty() const noexcept -> bool
+{
+    return size() == 0;
+}
+
+#undef CH8_OBSERVABLE
+
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define CH8_STATIC_OBSERVABLE ch8::static_observable<Observers...>
+
+template <typename... Observers>
+template <typename... Callbacks, typename>
+constexpr CH8_STATIC_OBSERVABLE::static_observable(Callbacks&&... callbacks)
+    : observers{std::forward<Callbacks>(callbacks)...}
+{
+}
+
+template <typename... Observers>
+template <typename... Args>
+constexpr auto CH8_STATIC_OBSERVABLE::notify(const Args&... args) -> void
+{
+    std::apply(
+        [&args...](auto&... observer) { (observer(args...), ...); },
+        observers);
+}
+
+template <typename... Observers>
+template <std::size_t Index>
+constexpr auto CH8_STATIC_OBSERVABLE::get() noexcept -> auto&
+{
+    return std::get<Index>(observers);
+}
+
+template <typename... Observers>
+template <std::size_t Index>
+constexpr auto CH8_STATIC_OBSERVABLE::get() const noexcept -> const auto&
+{
+    return std::get<Index>(observers);
+}
+
+template <typename... Observers>
+constexpr auto CH8_STATIC_OBSERVABLE::size() noexcept -> std::size_t
+{
+    return sizeof...(Observers);
+}
+
+#undef CH8_STATIC_OBSERVABLE
+
 #endif // CH8_OBSERVABLE_HPP
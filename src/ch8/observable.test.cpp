@@ -1,5 +1,8 @@
 #include "ch8/observable.hpp"
+#include <array>
 #include <catch2/catch.hpp>
+#include <stdexcept>
+#include <vector>
 
 void observer_function()
 {
@@ -70,3 +73,140 @@ TEST_CASE("Notify forwards arguments to observers")
     observable.notify(5);
     REQUIRE(counter == 10);
 }
+
+TEST_CASE("Detached observers are no longer notified")
+{
+    auto observable = ch8::observable<>{};
+    auto first_calls = 0;
+    auto second_calls = 0;
+
+    const auto first = observable.attach([&first_calls]() { ++first_calls; });
+    observable.attach([&second_calls]() { ++second_calls; });
+
+    REQUIRE(observable.detach(first));
+    observable.notify();
+    REQUIRE(first_calls == 0);
+    REQUIRE(second_calls == 1);
+    REQUIRE(observable.size() == 1);
+}
+
+TEST_CASE("Detaching the same observer twice fails the second time")
+{
+    auto observable = ch8::observable<>{};
+    const auto handle = observable.attach([]() {});
+
+    REQUIRE(observable.detach(handle));
+    REQUIRE_FALSE(observable.detach(handle));
+    REQUIRE(observable.empty());
+}
+
+TEST_CASE("Handles stay valid when other observers are detached")
+{
+    auto observable = ch8::observable<>{};
+    auto calls = 0;
+
+    const auto first = observable.attach([]() {});
+    const auto second = observable.attach([&calls]() { ++calls; });
+    const auto third = observable.attach([]() {});
+    observable.detach(first);
+    observable.detach(third);
+    observable.attach([]() {});
+
+    REQUIRE(observable.detach(second));
+    observable.notify();
+    REQUIRE(calls == 0);
+}
+
+TEST_CASE("Observers can detach themselves while being notified")
+{
+    auto observable = ch8::observable<>{};
+    auto calls = 0;
+    auto handle = ch8::observer_handle{0};
+
+    handle = observable.attach([&]() {
+        ++calls;
+        observable.detach(handle);
+    });
+    observable.attach([&calls]() { ++calls; });
+
+    observable.notify();
+    observable.notify();
+    REQUIRE(calls == 3);
+    REQUIRE(observable.size() == 1);
+}
+
+TEST_CASE("Observers can be attached after an observer throws")
+{
+    auto observable = ch8::observable<>{};
+    auto handle = ch8::observer_handle{0};
+
+    handle = observable.attach([&]() {
+        observable.detach(handle);
+        throw std::runtime_error{"observer failed"};
+    });
+
+    REQUIRE_THROWS_AS(observable.notify(), std::runtime_error);
+    REQUIRE(observable.empty());
+
+    auto calls = 0;
+    observable.attach([&calls]() { ++calls; });
+    observable.notify();
+    REQUIRE(calls == 1);
+}
+
+TEST_CASE("Observers too big to be stored inline can be attached")
+{
+    auto observable = ch8::observable<int>{};
+    auto big = std::array<int, 16>{};
+    big[15] = 2;
+    auto total = 0;
+
+    observable.attach([big, &total](int i) { total += big[15] * i; });
+    auto copy = observable;
+    observable.notify(3);
+    copy.notify(1);
+    REQUIRE(total == 8);
+}
+
+TEST_CASE("Copies of an observable notify copies of its observers")
+{
+    auto observable = ch8::observable<>{};
+    auto calls = 0;
+    observable.attach([counter = 0, &calls]() mutable { calls = ++counter; });
+
+    observable.notify();
+    auto copy = observable;
+    copy.notify();
+    REQUIRE(calls == 2);
+    observable.notify();
+    REQUIRE(calls == 2);
+}
+
+TEST_CASE("static_observable::notify calls every observer in order")
+{
+    auto calls = std::vector<int>{};
+    auto observable = ch8::static_observable{
+        [&calls](int i) { calls.push_back(i); },
+        [&calls](int i) { calls.push_back(i * 10); }};
+
+    observable.notify(4);
+    REQUIRE(calls == std::vector<int>{4, 40});
+    REQUIRE(observable.size() == 2);
+}
+
+TEST_CASE("static_observable without observers does nothing")
+{
+    auto observable = ch8::static_observable<>{};
+    observable.notify(1, 2.0, "three");
+    STATIC_REQUIRE(decltype(observable)::size() == 0);
+}
+
+TEST_CASE("static_observable copies its observers")
+{
+    auto calls = 0;
+    auto observable = ch8::static_observable{[&calls]() { ++calls; }};
+    auto copy{observable};
+
+    copy.notify();
+    REQUIRE(calls == 1);
+}
@@ -0,0 +1,33 @@
+#include "ch8/presenter.hpp"
+
+auto ch8::frame_presenter::draw(
+    const screen_type& screen, const screen_region& changed) -> void
+{
+    frame.changed = frame.changed.merge(changed);
+    ++frame.draws;
+
+    if (mode == presentation_mode::immediate) {
+        on_draw.notify(screen, changed);
+    }
+}
+
+auto ch8::frame_presenter::present(const screen_type& screen) -> void
+{
+    if (frame.draws == 0) {
+        return;
+    }
+
+    const auto presented = frame;
+    frame = {};
+    on_frame.notify(screen, presented);
+}
+
+auto ch8::frame_presenter::discard() noexcept -> void
+{
+    frame = {};
+}
+
+auto ch8::frame_presenter::pending() const noexcept -> const frame_info&
+{
+    return frame;
+}
@@ -0,0 +1,78 @@
+#ifndef CH8_PRESENTER_HPP
+#define CH8_PRESENTER_HPP
+
+#include "ch8/frame_buffer.hpp"
+#include "ch8/observable.hpp"
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace ch8 {
+    // immediate notifies draw observers after every 00E0 and Dxyn.
+    // per_frame only notifies frame observers, once per presented frame.
+    enum class presentation_mode { immediate, per_frame };
+
+    struct frame_info {
+        // Covers everything the merged draws changed.
+        screen_region changed;
+        std::size_t draws;
+    };
+
+    // Collects the draws of the instructions between two frames. Frames are
+    // presented at every 60 Hz vblank and when an execute() call ends, and
+    // only reach frame observers if something was drawn since the last one.
+    class frame_presenter {
+    public:
+        using screen_type = packed_frame_buffer<64, 32>;
+        using draw_event =
+            observable<const screen_type&, const screen_region&>;
+        using frame_event = observable<const screen_type&, const frame_info&>;
+
+        auto draw(const screen_type& screen, const screen_region& changed)
+            -> void;
+        auto present(const screen_type& screen) -> void;
+        // Forgets the draws waiting to be presented.
+        auto discard() noexcept -> void;
+
+        [[nodiscard]] auto pending() const noexcept -> const frame_info&;
+
+        // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+        presentation_mode mode{presentation_mode::immediate};
+        // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+        draw_event on_draw;
+        // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+        frame_event on_frame;
+
+    private:
+        frame_info frame{};
+    };
+} // namespace ch8
+
+namespace ch8::detail {
+    // Attaches observer to event, which passes a screen and some Info about
+    // it. Observers that only take the screen are wrapped to drop the Info.
+    template <typename Info, typename Callback>
+    auto attach_screen_observer(
+        observable<const frame_presenter::screen_type&, const Info&>& event,
+        Callback&& observer) -> observer_handle
+    {
+        using screen_type = frame_presenter::screen_type;
+        if constexpr (std::is_invocable_v<
+                          Callback&, const screen_type&, const Info&>) {
+            return event.attach(std::forward<Callback>(observer));
+        }
+        else {
+            static_assert(
+                std::is_invocable_v<Callback&, const screen_type&>,
+                "observers take the screen, optionally followed by the "
+                "event's Info");
+            return event.attach(
+                [observer = std::forward<Callback>(observer)](
+                    const screen_type& screen, const Info&) mutable {
+                    observer(screen);
+                });
+        }
+    }
+} // namespace ch8::detail
+
+#endif // CH8_PRESENTER_HPP
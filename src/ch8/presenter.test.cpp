@@ -0,0 +1,60 @@
+#include "ch8/presenter.hpp"
+#include <catch2/catch.hpp>
+
+TEST_CASE("frame_presenter::present merges the draws since the last frame")
+{
+    auto presenter = ch8::frame_presenter{};
+    auto screen = ch8::frame_presenter::screen_type{};
+
+    auto frames = std::size_t{0};
+    auto info = ch8::frame_info{};
+    presenter.on_frame.attach(
+        [&](const auto&, const ch8::frame_info& presented) {
+            ++frames;
+            info = presented;
+        });
+
+    presenter.draw(screen, {2, 2, 8, 1});
+    presenter.draw(screen, {});
+    presenter.draw(screen, {20, 10, 8, 4});
+    REQUIRE(frames == 0);
+    REQUIRE(presenter.pending().draws == 3);
+
+    presenter.present(screen);
+    REQUIRE(frames == 1);
+    REQUIRE(info.draws == 3);
+    REQUIRE(info.changed == ch8::screen_region{2, 2, 26, 12});
+    REQUIRE(presenter.pending().draws == 0);
+}
+
+TEST_CASE("frame_presenter::present skips frames without draws")
+{
+    auto presenter = ch8::frame_presenter{};
+    auto screen = ch8::frame_presenter::screen_type{};
+
+    auto frames = std::size_t{0};
+    presenter.on_frame.attach([&](const auto&, const auto&) { ++frames; });
+
+    presenter.present(screen);
+    presenter.draw(screen, {});
+    presenter.discard();
+    presenter.present(screen);
+    REQUIRE(frames == 0);
+}
+
+TEST_CASE("frame_presenter::draw only notifies draw observers when immediate")
+{
+    auto presenter = ch8::frame_presenter{};
+    auto screen = ch8::frame_presenter::screen_type{};
+
+    auto draws = std::size_t{0};
+    presenter.on_draw.attach([&](const auto&, const auto&) { ++draws; });
+
+    presenter.draw(screen, {});
+    REQUIRE(draws == 1);
+
+    presenter.mode = ch8::presentation_mode::per_frame;
+    presenter.draw(screen, {});
+    REQUIRE(draws == 1);
+    REQUIRE(presenter.pending().draws == 2);
+}
@@ -0,0 +1,138 @@
+#include "ch8/profiler.hpp"
+#include <iomanip>
+#include <ostream>
+
+namespace {
+    // In the order of opcode_class.
+    constexpr auto class_names =
+        std::array<std::string_view, ch8::opcode_classes>{
+            "00E0", "00EE", "0nnn", "1nnn", "2nnn", "3xkk", "4xkk",
+            "5xy0", "6xkk", "7xkk", "8xy0", "8xy1", "8xy2", "8xy3",
+            "8xy4", "8xy5", "8xy6", "8xy7", "8xyE", "9xy0", "Annn",
+            "Bnnn", "Cxkk", "Dxyn", "Ex9E", "ExA1", "Fx07", "Fx0A",
+            "Fx15", "Fx18", "Fx1E", "Fx29", "Fx33", "Fx55", "Fx65",
+            "unknown"};
+
+    auto write_address(std::ostream& out, const std::size_t address) -> void
+    {
+        const auto flags = out.flags();
+        out << "0x" << std::hex << std::uppercase << std::setfill('0')
+            << std::setw(3) << address;
+        out.flags(flags);
+    }
+} // namespace
+
+auto ch8::name(const opcode_class kind) noexcept -> std::string_view
+{
+    return class_names.at(static_cast<std::size_t>(kind));
+}
+
+ch8::profiler::profiler(const std::uint32_t sample_interval) noexcept
+    : classes{}
+    , addresses{}
+    , total{0}
+    , interval{sample_interval}
+    , countdown{sample_interval}
+{
+}
+
+auto ch8::profiler::sample(
+    const std::uint16_t opcode, const clock::duration elapsed) noexcept
+    -> void
+{
+    auto& stats = classes.at(static_cast<std::size_t>(classify(opcode)));
+    ++stats.samples;
+    stats.sampled_time +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+}
+
+auto ch8::profiler::merge(const profiler& other) noexcept -> void
+{
+    for (auto i = std::size_t{0}; i < classes.size(); ++i) {
+        classes.at(i).executions += other.classes.at(i).executions;
+        classes.at(i).samples += other.classes.at(i).samples;
+        classes.at(i).sampled_time += other.classes.at(i).sampled_time;
+    }
+    for (auto i = std::size_t{0}; i < addresses.size(); ++i) {
+        addresses.at(i) += other.addresses.at(i);
+    }
+    total += other.total;
+}
+
+auto ch8::profiler::clear() noexcept -> void
+{
+    classes = {};
+    addresses = {};
+    total = 0;
+    countdown = interval;
+}
+
+auto ch8::profiler::instructions() const noexcept -> std::uint64_t
+{
+    return total;
+}
+
+auto ch8::profiler::statistics(const opcode_class kind) const noexcept
+    -> const class_statistics&
+{
+    return classes.at(static_cast<std::size_t>(kind));
+}
+
+auto ch8::profiler::executions_at(const std::size_t address) const noexcept
+    -> std::uint64_t
+{
+    return addresses.at(address & 0xFFFU);
+}
+
+auto ch8::profiler::sample_interval() const noexcept -> std::uint32_t
+{
+    return interval;
+}
+
+auto ch8::profiler::write_csv(std::ostream& out) const -> void
+{
+    out << "kind,key,executions,samples,sampled_ns\n";
+    for (auto i = std::size_t{0}; i < classes.size(); ++i) {
+        const auto& stats = classes.at(i);
+        out << "class," << class_names.at(i) << ',' << stats.executions << ','
+            << stats.samples << ',' << stats.sampled_time.count() << '\n';
+    }
+
+    for (auto address = std::size_t{0}; address < addresses.size();
+         ++address) {
+        if (addresses.at(address) != 0) {
+            out << "address,";
+            write_address(out, address);
+            out << ',' << addresses.at(address) << ",0,0\n";
+        }
+    }
+}
+
+// Addresses that never ran are left out, so a profile of a small ROM stays
+// small.
+auto ch8::profiler::write_json(std::ostream& out) const -> void
+{
+    out << "{\n  \"instructions\": " << total
+        << ",\n  \"sample_interval\": " << interval
+        << ",\n  \"classes\": [";
+    for (auto i = std::size_t{0}; i < classes.size(); ++i) {
+        const auto& stats = classes.at(i);
+        out << (i == 0 ? "\n" : ",\n") << "    {\"class\": \""
+            << class_names.at(i) << "\", \"executions\": " << stats.executions
+            << ", \"samples\": " << stats.samples
+            << ", \"sampled_ns\": " << stats.sampled_time.count() << '}';
+    }
+
+    out << "\n  ],\n  \"addresses\": [";
+    auto first = true;
+    for (auto address = std::size_t{0}; address < addresses.size();
+         ++address) {
+        if (addresses.at(address) != 0) {
+            out << (first ? "\n" : ",\n") << "    {\"address\": \"";
+            write_address(out, address);
+            out << "\", \"executions\": " << addresses.at(address) << '}';
+            first = false;
+        }
+    }
+    out << "\n  ]\n}\n";
+}
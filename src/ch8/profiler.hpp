@@ -0,0 +1,197 @@
+#ifndef CH8_PROFILER_HPP
+#define CH8_PROFILER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+
+namespace ch8 {
+    enum class opcode_class {
+        op_00E0,
+        op_00EE,
+        op_0nnn,
+        op_1nnn,
+        op_2nnn,
+        op_3xkk,
+        op_4xkk,
+        op_5xy0,
+        op_6xkk,
+        op_7xkk,
+        op_8xy0,
+        op_8xy1,
+        op_8xy2,
+        op_8xy3,
+        op_8xy4,
+        op_8xy5,
+        op_8xy6,
+        op_8xy7,
+        op_8xyE,
+        op_9xy0,
+        op_Annn,
+        op_Bnnn,
+        op_Cxkk,
+        op_Dxyn,
+        op_Ex9E,
+        op_ExA1,
+        op_Fx07,
+        op_Fx0A,
+        op_Fx15,
+        op_Fx18,
+        op_Fx1E,
+        op_Fx29,
+        op_Fx33,
+        op_Fx55,
+        op_Fx65,
+        unknown
+    };
+
+    constexpr auto opcode_classes = std::size_t{36};
+
+    // Decodes like the interpreter: unknown is exactly the opcodes that trap
+    // with trap::unknown_opcode.
+    [[nodiscard]] constexpr auto classify(std::uint16_t opcode) noexcept
+        -> opcode_class;
+    // The opcode pattern, such as "8xy4".
+    [[nodiscard]] auto name(opcode_class kind) noexcept -> std::string_view;
+
+    // Counts how often each class of opcode and each address in ram is
+    // executed. Every sample_interval-th instruction is also timed, clock
+    // reads included, so times are for comparing classes with each other
+    // rather than for adding up to wall time.
+    class profiler {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        struct class_statistics {
+            std::uint64_t executions;
+            std::uint64_t samples;
+            std::chrono::nanoseconds sampled_time;
+        };
+
+        // An interval of 0 turns timing off. The default is prime so that
+        // loops shorter than it have every instruction sampled in turn.
+        explicit profiler(std::uint32_t sample_interval = 61) noexcept;
+
+        // Returns true if this instruction is to be timed.
+        auto count(std::uint16_t address, std::uint16_t opcode) noexcept
+            -> bool;
+        auto sample(std::uint16_t opcode, clock::duration elapsed) noexcept
+            -> void;
+
+        // Adds other's counts to these, such as to total a corpus of ROMs.
+        auto merge(const profiler& other) noexcept -> void;
+        auto clear() noexcept -> void;
+
+        [[nodiscard]] auto instructions() const noexcept -> std::uint64_t;
+        [[nodiscard]] auto statistics(opcode_class kind) const noexcept
+            -> const class_statistics&;
+        [[nodiscard]] auto executions_at(std::size_t address) const noexcept
+            -> std::uint64_t;
+        [[nodiscard]] auto sample_interval() const noexcept -> std::uint32_t;
+
+        // One row per class and per executed address:
+        // kind,key,executions,samples,sampled_ns
+        auto write_csv(std::ostream& out) const -> void;
+        auto write_json(std::ostream& out) const -> void;
+
+    private:
+        std::array<class_statistics, opcode_classes> classes;
+        std::array<std::uint64_t, 4096> addresses;
+        std::uint64_t total;
+        std::uint32_t interval;
+        std::uint32_t countdown;
+    };
+} // namespace ch8
+
+constexpr auto ch8::classify(const std::uint16_t opcode) noexcept
+    -> opcode_class
+{
+    const auto low_byte = opcode & 0x00FFU;
+    const auto low_nibble = opcode & 0x000FU;
+
+    switch (opcode >> 12U) {
+    case 0x0:
+        return opcode == 0x00E0   ? opcode_class::op_00E0
+               : opcode == 0x00EE ? opcode_class::op_00EE
+                                  : opcode_class::op_0nnn;
+    case 0x1:
+        return opcode_class::op_1nnn;
+    case 0x2:
+        return opcode_class::op_2nnn;
+    case 0x3:
+        return opcode_class::op_3xkk;
+    case 0x4:
+        return opcode_class::op_4xkk;
+    case 0x5:
+        return low_nibble == 0 ? opcode_class::op_5xy0 : opcode_class::unknown;
+    case 0x6:
+        return opcode_class::op_6xkk;
+    case 0x7:
+        return opcode_class::op_7xkk;
+    case 0x8:
+        if (low_nibble <= 0x7) {
+            return static_cast<opcode_class>(
+                static_cast<std::size_t>(opcode_class::op_8xy0) + low_nibble);
+        }
+        return low_nibble == 0xE ? opcode_class::op_8xyE
+                                 : opcode_class::unknown;
+    case 0x9:
+        return low_nibble == 0 ? opcode_class::op_9xy0 : opcode_class::unknown;
+    case 0xA:
+        return opcode_class::op_Annn;
+    case 0xB:
+        return opcode_class::op_Bnnn;
+    case 0xC:
+        return opcode_class::op_Cxkk;
+    case 0xD:
+        return opcode_class::op_Dxyn;
+    case 0xE:
+        return low_byte == 0x9E   ? opcode_class::op_Ex9E
+               : low_byte == 0xA1 ? opcode_class::op_ExA1
+                                  : opcode_class::unknown;
+    default:
+        switch (low_byte) {
+        case 0x07:
+            return opcode_class::op_Fx07;
+        case 0x0A:
+            return opcode_class::op_Fx0A;
+        case 0x15:
+            return opcode_class::op_Fx15;
+        case 0x18:
+            return opcode_class::op_Fx18;
+        case 0x1E:
+            return opcode_class::op_Fx1E;
+        case 0x29:
+            return opcode_class::op_Fx29;
+        case 0x33:
+            return opcode_class::op_Fx33;
+        case 0x55:
+            return opcode_class::op_Fx55;
+        case 0x65:
+            return opcode_class::op_Fx65;
+        default:
+            return opcode_class::unknown;
+        }
+    }
+}
+
+inline auto ch8::profiler::count(
+    const std::uint16_t address, const std::uint16_t opcode) noexcept -> bool
+{
+    ++total;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    ++addresses[address & 0xFFFU];
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    ++classes[static_cast<std::size_t>(classify(opcode))].executions;
+
+    if (interval == 0 || --countdown != 0) {
+        return false;
+    }
+    countdown = interval;
+    return true;
+}
+
+#endif // CH8_PROFILER_HPP
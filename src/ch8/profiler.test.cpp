@@ -0,0 +1,138 @@
+#include "ch8/profiler.hpp"
+#include "ch8/system.hpp"
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <string>
+
+TEST_CASE("classify puts opcodes in their class")
+{
+    REQUIRE(ch8::classify(0x00E0) == ch8::opcode_class::op_00E0);
+    REQUIRE(ch8::classify(0x00EE) == ch8::opcode_class::op_00EE);
+    REQUIRE(ch8::classify(0x0123) == ch8::opcode_class::op_0nnn);
+    REQUIRE(ch8::classify(0x1234) == ch8::opcode_class::op_1nnn);
+    REQUIRE(ch8::classify(0x5120) == ch8::opcode_class::op_5xy0);
+    REQUIRE(ch8::classify(0x5121) == ch8::opcode_class::unknown);
+    REQUIRE(ch8::classify(0x8124) == ch8::opcode_class::op_8xy4);
+    REQUIRE(ch8::classify(0x8127) == ch8::opcode_class::op_8xy7);
+    REQUIRE(ch8::classify(0x812E) == ch8::opcode_class::op_8xyE);
+    REQUIRE(ch8::classify(0x8128) == ch8::opcode_class::unknown);
+    REQUIRE(ch8::classify(0xD125) == ch8::opcode_class::op_Dxyn);
+    REQUIRE(ch8::classify(0xE1A1) == ch8::opcode_class::op_ExA1);
+    REQUIRE(ch8::classify(0xF133) == ch8::opcode_class::op_Fx33);
+    REQUIRE(ch8::classify(0xF199) == ch8::opcode_class::unknown);
+}
+
+TEST_CASE("classify finds unknown exactly the opcodes step() traps on")
+{
+    auto system = ch8::chip8_system{};
+
+    for (auto opcode = 0U; opcode <= 0xFFFFU; ++opcode) {
+        system.data.program_counter = ch8::chip8_data::program_start;
+        system.data.stack_pointer = -1;
+        system.data.ram.at(ch8::chip8_data::program_start) =
+            static_cast<std::uint8_t>(opcode >> 8U);
+        system.data.ram.at(ch8::chip8_data::program_start + 1) =
+            static_cast<std::uint8_t>(opcode & 0xFFU);
+
+        const auto unknown =
+            ch8::classify(static_cast<std::uint16_t>(opcode)) ==
+            ch8::opcode_class::unknown;
+        INFO("opcode " << opcode);
+        REQUIRE((system.step() == ch8::trap::unknown_opcode) == unknown);
+    }
+}
+
+TEST_CASE("Opcode classes are named after their pattern")
+{
+    REQUIRE(ch8::name(ch8::opcode_class::op_00E0) == "00E0");
+    REQUIRE(ch8::name(ch8::opcode_class::op_8xyE) == "8xyE");
+    REQUIRE(ch8::name(ch8::opcode_class::op_Fx65) == "Fx65");
+    REQUIRE(ch8::name(ch8::opcode_class::unknown) == "unknown");
+}
+
+TEST_CASE("profiler counts executions per class and address")
+{
+    auto profiler = ch8::profiler{0};
+    profiler.count(0x200, 0x6005);
+    profiler.count(0x202, 0x7001);
+    profiler.count(0x202, 0x7001);
+    profiler.count(0x204, 0x1202);
+
+    REQUIRE(profiler.instructions() == 4);
+    REQUIRE(profiler.statistics(ch8::opcode_class::op_7xkk).executions == 2);
+    REQUIRE(profiler.statistics(ch8::opcode_class::op_6xkk).executions == 1);
+    REQUIRE(profiler.executions_at(0x202) == 2);
+    REQUIRE(profiler.executions_at(0x206) == 0);
+}
+
+TEST_CASE("profiler asks for every sample_interval-th instruction to be timed")
+{
+    auto profiler = ch8::profiler{4};
+    auto sampled = 0;
+    for (auto i = 0; i < 12; ++i) {
+        sampled += profiler.count(0x200, 0x6005) ? 1 : 0;
+    }
+    REQUIRE(sampled == 3);
+
+    profiler.sample(0x6005, std::chrono::nanoseconds{30});
+    profiler.sample(0x6105, std::chrono::nanoseconds{20});
+    const auto& stats = profiler.statistics(ch8::opcode_class::op_6xkk);
+    REQUIRE(stats.samples == 2);
+    REQUIRE(stats.sampled_time == std::chrono::nanoseconds{50});
+
+    auto untimed = ch8::profiler{0};
+    REQUIRE_FALSE(untimed.count(0x200, 0x6005));
+}
+
+TEST_CASE("profiler::merge adds up two profiles")
+{
+    auto first = ch8::profiler{0};
+    first.count(0x200, 0xA300);
+    auto second = ch8::profiler{0};
+    second.count(0x200, 0xA300);
+    second.count(0x300, 0xD125);
+
+    first.merge(second);
+    REQUIRE(first.instructions() == 3);
+    REQUIRE(first.executions_at(0x200) == 2);
+    REQUIRE(first.executions_at(0x300) == 1);
+    REQUIRE(first.statistics(ch8::opcode_class::op_Annn).executions == 2);
+
+    first.clear();
+    REQUIRE(first.instructions() == 0);
+    REQUIRE(first.executions_at(0x200) == 0);
+}
+
+TEST_CASE("profiler writes a row for each class and executed address")
+{
+    auto profiler = ch8::profiler{0};
+    profiler.count(0x2FE, 0x8124);
+
+    auto csv = std::ostringstream{};
+    profiler.write_csv(csv);
+    const auto text = csv.str();
+    REQUIRE(text.find("kind,key,executions,samples,sampled_ns\n") == 0);
+    REQUIRE(text.find("class,8xy4,1,0,0\n") != std::string::npos);
+    REQUIRE(text.find("class,8xy5,0,0,0\n") != std::string::npos);
+    REQUIRE(text.find("address,0x2FE,1,0,0\n") != std::string::npos);
+    REQUIRE(text.find("address,0x200") == std::string::npos);
+}
+
+TEST_CASE("profiler writes JSON with only the executed addresses")
+{
+    auto profiler = ch8::profiler{0};
+    profiler.count(0x200, 0x00E0);
+    profiler.count(0x202, 0x00E0);
+
+    auto json = std::ostringstream{};
+    profiler.write_json(json);
+    const auto text = json.str();
+    REQUIRE(text.find("\"instructions\": 2") != std::string::npos);
+    REQUIRE(
+        text.find("{\"class\": \"00E0\", \"executions\": 2") !=
+        std::string::npos);
+    REQUIRE(
+        text.find("{\"address\": \"0x202\", \"executions\": 1}") !=
+        std::string::npos);
+    REQUIRE(text.find("0x204") == std::string::npos);
+}
@@ -0,0 +1,615 @@
+#include "ch8/program_map.hpp"
+#include "ch8/instruction.hpp"
+#include "ch8/system.hpp"
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
+namespace {
+    constexpr auto ram_size = std::tuple_size_v<decltype(ch8::chip8_data::ram)>;
+    constexpr auto map_magic = std::array<std::uint8_t, 4>{'C', '8', 'M', 'P'};
+    constexpr auto map_version = std::uint8_t{1};
+
+    // Stands for a register whose value isn't known.
+    constexpr auto unknown = std::numeric_limits<std::size_t>::max();
+
+    // A Bnnn table can't hold more entries than V0 can index.
+    constexpr auto max_table_entries = std::size_t{128};
+
+    enum class flow { next, jump, call, skip, ret, indirect, stop };
+
+    [[nodiscard]] auto flow_of(const std::uint16_t opcode) noexcept -> flow
+    {
+        const auto low = opcode & 0x00FFU;
+        const auto row_8_op = opcode & 0x000FU;
+
+        switch (opcode >> 12U) {
+        case 0x0:
+            return opcode == 0x00EE ? flow::ret : flow::next;
+        case 0x1:
+            return flow::jump;
+        case 0x2:
+            return flow::call;
+        case 0x3:
+        case 0x4:
+            return flow::skip;
+        case 0x5:
+        case 0x9:
+            return (opcode & 0x000FU) == 0 ? flow::skip : flow::stop;
+        case 0x8:
+            return row_8_op <= 0x7 || row_8_op == 0xE ? flow::next : flow::stop;
+        case 0xB:
+            return flow::indirect;
+        case 0xE:
+            return low == 0x9E || low == 0xA1 ? flow::skip : flow::stop;
+        case 0xF:
+            switch (low) {
+            case 0x07:
+            case 0x0A:
+            case 0x15:
+            case 0x18:
+            case 0x1E:
+            case 0x29:
+            case 0x33:
+            case 0x55:
+            case 0x65:
+                return flow::next;
+            default:
+                return flow::stop;
+            }
+        default:
+            return flow::next;
+        }
+    }
+
+    // Whether opcode can change V0, which decides where Bnnn goes.
+    [[nodiscard]] auto writes_v0(const std::uint16_t opcode) noexcept -> bool
+    {
+        const auto x = (opcode & 0x0F00U) >> 8U;
+        const auto low = opcode & 0x00FFU;
+
+        switch (opcode >> 12U) {
+        case 0x6:
+        case 0x7:
+        case 0x8:
+        case 0xC:
+            return x == 0;
+        case 0xF:
+            return low == 0x65 || (x == 0 && (low == 0x07 || low == 0x0A));
+        default:
+            return false;
+        }
+    }
+
+    auto put_u8(std::vector<std::uint8_t>& bytes, const std::size_t value)
+        -> void
+    {
+        bytes.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    auto put_u16(std::vector<std::uint8_t>& bytes, const std::size_t value)
+        -> void
+    {
+        bytes.push_back(static_cast<std::uint8_t>(value & 0xFFU));
+        bytes.push_back(static_cast<std::uint8_t>((value >> 8U) & 0xFFU));
+    }
+
+    class reader {
+    public:
+        explicit reader(const std::vector<std::uint8_t>& bytes) noexcept
+            : source{bytes}, position{0}, failed{false}
+        {
+        }
+
+        auto u8() noexcept -> std::uint8_t
+        {
+            if (position >= source.size()) {
+                failed = true;
+                return 0;
+            }
+            return source[position++];
+        }
+
+        auto u16() noexcept -> std::uint16_t
+        {
+            const auto low = u8();
+            const auto high = u8();
+            return static_cast<std::uint16_t>(low | (high << 8U));
+        }
+
+        [[nodiscard]] auto ok() const noexcept -> bool
+        {
+            return !failed;
+        }
+
+        [[nodiscard]] auto at_end() const noexcept -> bool
+        {
+            return position == source.size();
+        }
+
+    private:
+        const std::vector<std::uint8_t>& source;
+        std::size_t position;
+        bool failed;
+    };
+} // namespace
+
+ch8::program_map::program_map() noexcept
+    : address_flags(ram_size, 0)
+    , block_list{}
+    , call_list{}
+    , function_list{}
+    , sprite_list{}
+    , jump_table_list{}
+    , block_index(ram_size, -1)
+{
+}
+
+auto ch8::program_map::flags(const std::size_t address) const noexcept
+    -> std::uint8_t
+{
+    return address < address_flags.size() ? address_flags[address] : 0;
+}
+
+auto ch8::program_map::is_code(const std::size_t address) const noexcept
+    -> bool
+{
+    return (flags(address) & (instruction | operand)) != 0;
+}
+
+auto ch8::program_map::block_at(const std::size_t address) const noexcept
+    -> const basic_block*
+{
+    if (address >= block_index.size() || block_index[address] < 0) {
+        return nullptr;
+    }
+    return &block_list[static_cast<std::size_t>(block_index[address])];
+}
+
+auto ch8::program_map::blocks() const noexcept
+    -> const std::vector<basic_block>&
+{
+    return block_list;
+}
+
+auto ch8::program_map::calls() const noexcept -> const std::vector<call>&
+{
+    return call_list;
+}
+
+auto ch8::program_map::functions() const noexcept
+    -> const std::vector<function>&
+{
+    return function_list;
+}
+
+auto ch8::program_map::sprites() const noexcept
+    -> const std::vector<sprite_region>&
+{
+    return sprite_list;
+}
+
+auto ch8::program_map::jump_tables() const noexcept
+    -> const std::vector<indirect_jump>&
+{
+    return jump_table_list;
+}
+
+auto ch8::program_map::serialize() const -> std::vector<std::uint8_t>
+{
+    auto bytes = std::vector<std::uint8_t>(map_magic.begin(), map_magic.end());
+    put_u8(bytes, map_version);
+    put_u16(bytes, function_list.empty() ? 0 : function_list.front().entry);
+
+    for (auto address = std::size_t{0}; address < address_flags.size();) {
+        const auto value = address_flags[address];
+        auto run = std::size_t{1};
+        while (address + run < address_flags.size() &&
+               address_flags[address + run] == value && run < 0xFFFF) {
+            ++run;
+        }
+        put_u8(bytes, value);
+        put_u16(bytes, run);
+        address += run;
+    }
+
+    put_u16(bytes, block_list.size());
+    for (const auto& block : block_list) {
+        put_u16(bytes, block.address);
+        put_u16(bytes, block.instructions);
+        put_u8(bytes, block.returns ? 1 : 0);
+        put_u8(bytes, block.successors.size());
+        for (const auto successor : block.successors) {
+            put_u16(bytes, successor);
+        }
+    }
+
+    put_u16(bytes, call_list.size());
+    for (const auto& c : call_list) {
+        put_u16(bytes, c.site);
+        put_u16(bytes, c.target);
+    }
+
+    put_u16(bytes, sprite_list.size());
+    for (const auto& region : sprite_list) {
+        put_u16(bytes, region.address);
+        put_u8(bytes, region.rows);
+    }
+
+    put_u16(bytes, jump_table_list.size());
+    for (const auto& table : jump_table_list) {
+        put_u16(bytes, table.site);
+        put_u16(bytes, table.base);
+        put_u8(bytes, table.targets.size());
+        for (const auto target : table.targets) {
+            put_u16(bytes, target);
+        }
+    }
+
+    return bytes;
+}
+
+auto ch8::program_map::deserialize(const std::vector<std::uint8_t>& bytes)
+    -> std::optional<program_map>
+{
+    auto in = reader{bytes};
+    for (const auto expected : map_magic) {
+        if (in.u8() != expected) {
+            return std::nullopt;
+        }
+    }
+    if (in.u8() != map_version) {
+        return std::nullopt;
+    }
+
+    auto map = program_map{};
+    map.function_list.push_back({in.u16(), {}, false});
+
+    for (auto address = std::size_t{0}; address < ram_size && in.ok();) {
+        const auto value = in.u8();
+        const auto run = std::size_t{in.u16()};
+        if (run == 0 || address + run > ram_size) {
+            return std::nullopt;
+        }
+        std::fill_n(&map.address_flags[address], run, value);
+        address += run;
+    }
+
+    const auto valid = [](std::size_t address) { return address < ram_size; };
+
+    auto count = std::size_t{in.u16()};
+    for (auto i = std::size_t{0}; i < count && in.ok(); ++i) {
+        auto block = basic_block{in.u16(), in.u16(), {}, false};
+        block.returns = in.u8() != 0;
+        block.successors.resize(in.u8());
+        for (auto& successor : block.successors) {
+            successor = in.u16();
+        }
+        if (block.instructions == 0 ||
+            !valid(block.address + block.instructions * 2U - 1U)) {
+            return std::nullopt;
+        }
+        map.block_list.push_back(std::move(block));
+    }
+
+    count = in.u16();
+    for (auto i = std::size_t{0}; i < count && in.ok(); ++i) {
+        const auto site = in.u16();
+        const auto target = in.u16();
+        map.call_list.push_back({site, target});
+    }
+
+    count = in.u16();
+    for (auto i = std::size_t{0}; i < count && in.ok(); ++i) {
+        const auto address = in.u16();
+        const auto rows = in.u8();
+        map.sprite_list.push_back({address, rows});
+    }
+
+    count = in.u16();
+    for (auto i = std::size_t{0}; i < count && in.ok(); ++i) {
+        const auto site = in.u16();
+        const auto base = in.u16();
+        auto table = indirect_jump{site, base, {}};
+        table.targets.resize(in.u8());
+        for (auto& target : table.targets) {
+            target = in.u16();
+        }
+        map.jump_table_list.push_back(std::move(table));
+    }
+
+    if (!in.ok() || !in.at_end()) {
+        return std::nullopt;
+    }
+
+    map.link();
+    return map;
+}
+
+auto ch8::program_map::analyze(const chip8_data& data) -> program_map
+{
+    return analyze(data, chip8_data::program_start);
+}
+
+// Every reachable instruction is visited once. Leaders are collected while
+// walking and the blocks are cut from them afterwards, since a later jump
+// can land in the middle of code that was already walked.
+auto ch8::program_map::analyze(const chip8_data& data, std::uint16_t entry)
+    -> program_map
+{
+    auto map = program_map{};
+    auto& flags = map.address_flags;
+    auto leaders = std::vector<bool>(ram_size, false);
+    auto pending = std::vector<std::size_t>{};
+
+    const auto opcode_at = [&data](std::size_t address) {
+        return create_opcode(data.ram[address], data.ram[address + 1U]);
+    };
+    const auto add_leader = [&](std::size_t address) {
+        if (address + 1U < ram_size) {
+            leaders[address] = true;
+            pending.push_back(address);
+        }
+    };
+    const auto mark = [&flags](std::size_t address, std::size_t size,
+                               std::uint8_t flag) {
+        for (auto i = std::size_t{0}; i < size; ++i) {
+            flags[(address + i) % ram_size] |= flag;
+        }
+    };
+
+    add_leader(entry);
+    while (!pending.empty()) {
+        auto address = pending.back();
+        pending.pop_back();
+
+        // What I and V0 hold is only tracked along straight-line code.
+        auto index = unknown;
+        auto v0 = unknown;
+
+        while (address + 1U < ram_size) {
+            if ((flags[address] & instruction) != 0) {
+                leaders[address] = true;
+                break;
+            }
+            flags[address] |= instruction;
+            flags[address + 1U] |= operand;
+
+            const auto opcode = opcode_at(address);
+            const auto x = std::size_t{(opcode & 0x0F00U) >> 8U};
+            const auto nnn = std::size_t{opcode & 0x0FFFU};
+            const auto low = opcode & 0x00FFU;
+            const auto kind = flow_of(opcode);
+
+            if (writes_v0(opcode)) {
+                v0 = unknown;
+            }
+
+            if (kind == flow::jump) {
+                add_leader(nnn);
+                break;
+            }
+            if (kind == flow::call) {
+                map.call_list.push_back(
+                    {static_cast<std::uint16_t>(address),
+                     static_cast<std::uint16_t>(nnn)});
+                flags[nnn] |= call_target;
+                add_leader(nnn);
+                add_leader(address + 2U);
+                break;
+            }
+            if (kind == flow::skip) {
+                add_leader(address + 2U);
+                add_leader(address + 4U);
+                break;
+            }
+            if (kind == flow::indirect) {
+                auto table = indirect_jump{
+                    static_cast<std::uint16_t>(address),
+                    static_cast<std::uint16_t>(nnn),
+                    {}};
+                if (v0 != unknown && nnn + v0 + 1U < ram_size) {
+                    table.targets.push_back(
+                        static_cast<std::uint16_t>(nnn + v0));
+                }
+                else {
+                    for (auto entry_address = nnn;
+                         entry_address + 1U < ram_size &&
+                         table.targets.size() < max_table_entries &&
+                         (opcode_at(entry_address) >> 12U) == 0x1;
+                         entry_address += 2U) {
+                        table.targets.push_back(
+                            static_cast<std::uint16_t>(entry_address));
+                    }
+                }
+                if (table.targets.empty() && v0 == unknown) {
+                    table.targets.push_back(static_cast<std::uint16_t>(nnn));
+                }
+                for (const auto target : table.targets) {
+                    flags[target] |= jump_table;
+                    add_leader(target);
+                }
+                map.jump_table_list.push_back(std::move(table));
+                break;
+            }
+            if (kind == flow::ret || kind == flow::stop) {
+                break;
+            }
+
+            if ((opcode >> 12U) == 0x6 && x == 0) {
+                v0 = low;
+            }
+            else if ((opcode >> 12U) == 0xA) {
+                index = nnn;
+            }
+            else if ((opcode >> 12U) == 0xD && index != unknown) {
+                const auto rows = std::size_t{opcode & 0x000FU};
+                if (rows > 0) {
+                    map.sprite_list.push_back(
+                        {static_cast<std::uint16_t>(index),
+                         static_cast<std::uint8_t>(rows)});
+                    mark(index, rows, sprite);
+                }
+            }
+            else if ((opcode >> 12U) == 0xF) {
+                if (low == 0x1E || low == 0x29) {
+                    index = unknown;
+                }
+                else if (index != unknown && low == 0x33) {
+                    mark(index, 3, data_access);
+                }
+                else if (index != unknown && (low == 0x55 || low == 0x65)) {
+                    mark(index, x + 1U, data_access);
+                }
+            }
+
+            address += 2U;
+            if (address < ram_size && leaders[address]) {
+                break;
+            }
+        }
+    }
+
+    for (auto leader = std::size_t{0}; leader < ram_size; ++leader) {
+        if (!leaders[leader] || (flags[leader] & instruction) == 0) {
+            continue;
+        }
+        flags[leader] |= block_start;
+
+        auto block =
+            basic_block{static_cast<std::uint16_t>(leader), 0, {}, false};
+        auto address = leader;
+        while (address + 1U < ram_size &&
+               (flags[address] & instruction) != 0) {
+            const auto opcode = opcode_at(address);
+            const auto nnn = static_cast<std::uint16_t>(opcode & 0x0FFFU);
+            const auto next = static_cast<std::uint16_t>(address + 2U);
+            ++block.instructions;
+
+            const auto kind = flow_of(opcode);
+            if (kind == flow::jump) {
+                block.successors = {nnn};
+                break;
+            }
+            if (kind == flow::call) {
+                block.successors = {nnn, next};
+                break;
+            }
+            if (kind == flow::skip) {
+                block.successors = {
+                    next, static_cast<std::uint16_t>(address + 4U)};
+                break;
+            }
+            if (kind == flow::indirect) {
+                const auto table = std::find_if(
+                    map.jump_table_list.begin(), map.jump_table_list.end(),
+                    [address](const auto& t) { return t.site == address; });
+                block.successors = table->targets;
+                break;
+            }
+            if (kind == flow::ret || kind == flow::stop) {
+                block.returns = kind == flow::ret;
+                break;
+            }
+
+            address = next;
+            if (address < ram_size && leaders[address]) {
+                block.successors = {next};
+                break;
+            }
+        }
+
+        map.block_list.push_back(std::move(block));
+    }
+
+    auto& sprites = map.sprite_list;
+    std::sort(sprites.begin(), sprites.end(), [](const auto& a, const auto& b) {
+        return std::tie(a.address, a.rows) < std::tie(b.address, b.rows);
+    });
+    sprites.erase(
+        std::unique(
+            sprites.begin(), sprites.end(),
+            [](const auto& a, const auto& b) {
+                return a.address == b.address && a.rows == b.rows;
+            }),
+        sprites.end());
+
+    std::sort(
+        map.call_list.begin(), map.call_list.end(),
+        [](const auto& a, const auto& b) { return a.site < b.site; });
+    std::sort(
+        map.jump_table_list.begin(), map.jump_table_list.end(),
+        [](const auto& a, const auto& b) { return a.site < b.site; });
+
+    map.function_list.push_back({entry, {}, false});
+    map.link();
+    return map;
+}
+
+// Rebuilds block_index and the call graph from the blocks and calls.
+auto ch8::program_map::link() -> void
+{
+    std::fill(block_index.begin(), block_index.end(), std::int16_t{-1});
+    for (auto i = std::size_t{0}; i < block_list.size(); ++i) {
+        const auto& block = block_list[i];
+        const auto end = block.address + block.instructions * 2U;
+        for (auto address = std::size_t{block.address};
+             address < end && address < block_index.size(); ++address) {
+            block_index[address] = static_cast<std::int16_t>(i);
+        }
+    }
+
+    auto entries = std::vector<std::uint16_t>{};
+    if (!function_list.empty()) {
+        entries.push_back(function_list.front().entry);
+    }
+    for (const auto& c : call_list) {
+        if (std::find(entries.begin(), entries.end(), c.target) ==
+            entries.end()) {
+            entries.push_back(c.target);
+        }
+    }
+
+    function_list.clear();
+    auto visited = std::vector<bool>(block_list.size(), false);
+    for (const auto entry : entries) {
+        auto current = function{entry, {}, false};
+        auto pending = std::vector<std::uint16_t>{entry};
+        std::fill(visited.begin(), visited.end(), false);
+
+        while (!pending.empty()) {
+            const auto address = pending.back();
+            pending.pop_back();
+            const auto* block = block_at(address);
+            if (block == nullptr || block->address != address) {
+                continue;
+            }
+            const auto i = static_cast<std::size_t>(block - block_list.data());
+            if (visited[i]) {
+                continue;
+            }
+            visited[i] = true;
+            current.returns = current.returns || block->returns;
+
+            const auto last = block->address + (block->instructions - 1U) * 2U;
+            const auto site = std::find_if(
+                call_list.begin(), call_list.end(),
+                [last](const auto& c) { return c.site == last; });
+
+            if (site == call_list.end()) {
+                pending.insert(
+                    pending.end(), block->successors.begin(),
+                    block->successors.end());
+                continue;
+            }
+            if (std::find(
+                    current.callees.begin(), current.callees.end(),
+                    site->target) == current.callees.end()) {
+                current.callees.push_back(site->target);
+            }
+            pending.push_back(static_cast<std::uint16_t>(last + 2U));
+        }
+
+        function_list.push_back(std::move(current));
+    }
+}
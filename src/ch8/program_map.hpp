@@ -0,0 +1,105 @@
+#ifndef CH8_PROGRAM_MAP_HPP
+#define CH8_PROGRAM_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace ch8 {
+    struct chip8_data;
+
+    // What static analysis found out about every address in ram: which bytes
+    // are reachable code, where basic blocks start, who calls whom and which
+    // bytes Dxyn draws from. Bnnn is followed through tables of 1nnn jumps at
+    // nnn, or through nnn + V0 when V0 was just loaded with 6xkk.
+    class program_map {
+    public:
+        static constexpr auto instruction = std::uint8_t{1U << 0U};
+        static constexpr auto operand = std::uint8_t{1U << 1U};
+        static constexpr auto block_start = std::uint8_t{1U << 2U};
+        static constexpr auto call_target = std::uint8_t{1U << 3U};
+        static constexpr auto jump_table = std::uint8_t{1U << 4U};
+        static constexpr auto sprite = std::uint8_t{1U << 5U};
+        static constexpr auto data_access = std::uint8_t{1U << 6U};
+
+        // Successors include the targets of jumps, calls and skips, and the
+        // return address of a call. returns is set when the block ends in
+        // 00EE.
+        struct basic_block {
+            std::uint16_t address;
+            std::uint16_t instructions;
+            std::vector<std::uint16_t> successors;
+            bool returns;
+        };
+
+        struct call {
+            std::uint16_t site;
+            std::uint16_t target;
+        };
+
+        // Made of the blocks reachable from entry without entering a call.
+        struct function {
+            std::uint16_t entry;
+            std::vector<std::uint16_t> callees;
+            bool returns;
+        };
+
+        struct sprite_region {
+            std::uint16_t address;
+            std::uint8_t rows;
+        };
+
+        struct indirect_jump {
+            std::uint16_t site;
+            std::uint16_t base;
+            std::vector<std::uint16_t> targets;
+        };
+
+        program_map() noexcept;
+
+        [[nodiscard]] auto flags(std::size_t address) const noexcept
+            -> std::uint8_t;
+        [[nodiscard]] auto is_code(std::size_t address) const noexcept -> bool;
+        [[nodiscard]] auto block_at(std::size_t address) const noexcept
+            -> const basic_block*;
+
+        [[nodiscard]] auto blocks() const noexcept
+            -> const std::vector<basic_block>&;
+        [[nodiscard]] auto calls() const noexcept -> const std::vector<call>&;
+        [[nodiscard]] auto functions() const noexcept
+            -> const std::vector<function>&;
+        [[nodiscard]] auto sprites() const noexcept
+            -> const std::vector<sprite_region>&;
+        [[nodiscard]] auto jump_tables() const noexcept
+            -> const std::vector<indirect_jump>&;
+
+        // A compact form for tools: run-length encoded flags followed by the
+        // blocks, calls, sprites and jump tables. Functions are rebuilt on
+        // load.
+        [[nodiscard]] auto serialize() const -> std::vector<std::uint8_t>;
+        [[nodiscard]] static auto
+        deserialize(const std::vector<std::uint8_t>& bytes)
+            -> std::optional<program_map>;
+
+        // Follows every path from entry, or from chip8_data::program_start,
+        // through data.ram without running it.
+        [[nodiscard]] static auto analyze(const chip8_data& data)
+            -> program_map;
+        [[nodiscard]] static auto
+        analyze(const chip8_data& data, std::uint16_t entry) -> program_map;
+
+    private:
+        auto link() -> void;
+
+        std::vector<std::uint8_t> address_flags;
+        std::vector<basic_block> block_list;
+        std::vector<call> call_list;
+        std::vector<function> function_list;
+        std::vector<sprite_region> sprite_list;
+        std::vector<indirect_jump> jump_table_list;
+        std::vector<std::int16_t> block_index;
+    };
+} // namespace ch8
+
+#endif // CH8_PROGRAM_MAP_HPP
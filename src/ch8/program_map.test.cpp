@@ -0,0 +1,217 @@
+#include "ch8/program_map.hpp"
+#include "ch8/system.hpp"
+#include "ch8/system_state.test.hpp"
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace {
+    constexpr auto analyzed_program = std::array<std::uint8_t, 30>{
+        0xA2, 0x18, // 200: LD I, 0x218
+        0x60, 0x00, // 202: LD V0, 0x00
+        0x22, 0x10, // 204: CALL 0x210
+        0x30, 0x05, // 206: SE V0, 0x05
+        0x12, 0x04, // 208: JP 0x204
+        0x12, 0x0A, // 20A: JP 0x20A
+        0xFF, 0xFF, // 20C: data
+        0xFF, 0xFF, // 20E: data
+        0xD0, 0x13, // 210: DRW V0, V1, 3
+        0x70, 0x01, // 212: ADD V0, 0x01
+        0x00, 0xEE, // 214: RET
+        0x00, 0x00, // 216: padding
+        0x18, 0x24, // 218: sprite
+        0x42, 0x00, // 21A: sprite, padding
+        0x00, 0x00, // 21C: padding
+    };
+
+    auto analyzed_system() -> ch8::chip8_system
+    {
+        auto system = ch8::chip8_system{};
+        load(system, analyzed_program);
+        return system;
+    }
+} // namespace
+
+TEST_CASE("program_map::analyze marks reachable code and nothing else")
+{
+    const auto system = analyzed_system();
+    const auto map = ch8::program_map::analyze(system.data);
+
+    for (auto address = std::size_t{0x200}; address <= 0x20A; address += 2) {
+        REQUIRE(map.flags(address) & ch8::program_map::instruction);
+        REQUIRE(map.flags(address + 1U) & ch8::program_map::operand);
+    }
+    REQUIRE(map.is_code(0x210));
+    REQUIRE(map.is_code(0x215));
+    REQUIRE_FALSE(map.is_code(0x20C));
+    REQUIRE_FALSE(map.is_code(0x20E));
+    REQUIRE_FALSE(map.is_code(0x216));
+    REQUIRE_FALSE(map.is_code(0x218));
+}
+
+TEST_CASE("program_map::analyze splits code into basic blocks")
+{
+    const auto system = analyzed_system();
+    const auto map = ch8::program_map::analyze(system.data);
+
+    REQUIRE(map.blocks().size() == 6);
+
+    const auto* entry = map.block_at(0x202);
+    REQUIRE(entry != nullptr);
+    REQUIRE(entry->address == 0x200);
+    REQUIRE(entry->instructions == 2);
+    REQUIRE(entry->successors == std::vector<std::uint16_t>{0x204});
+
+    const auto* call = map.block_at(0x204);
+    REQUIRE(call->instructions == 1);
+    REQUIRE(call->successors == std::vector<std::uint16_t>{0x210, 0x206});
+
+    const auto* skip = map.block_at(0x206);
+    REQUIRE(skip->successors == std::vector<std::uint16_t>{0x208, 0x20A});
+
+    const auto* subroutine = map.block_at(0x214);
+    REQUIRE(subroutine->address == 0x210);
+    REQUIRE(subroutine->instructions == 3);
+    REQUIRE(subroutine->returns);
+    REQUIRE(subroutine->successors.empty());
+
+    REQUIRE(map.flags(0x204) & ch8::program_map::block_start);
+    REQUIRE_FALSE(map.flags(0x202) & ch8::program_map::block_start);
+    REQUIRE(map.block_at(0x20C) == nullptr);
+}
+
+TEST_CASE("program_map::analyze builds the call graph")
+{
+    const auto system = analyzed_system();
+    const auto map = ch8::program_map::analyze(system.data);
+
+    REQUIRE(map.calls().size() == 1);
+    REQUIRE(map.calls().front().site == 0x204);
+    REQUIRE(map.calls().front().target == 0x210);
+    REQUIRE(map.flags(0x210) & ch8::program_map::call_target);
+
+    REQUIRE(map.functions().size() == 2);
+    const auto& main = map.functions().at(0);
+    REQUIRE(main.entry == 0x200);
+    REQUIRE(main.callees == std::vector<std::uint16_t>{0x210});
+    REQUIRE_FALSE(main.returns);
+
+    const auto& subroutine = map.functions().at(1);
+    REQUIRE(subroutine.entry == 0x210);
+    REQUIRE(subroutine.callees.empty());
+    REQUIRE(subroutine.returns);
+}
+
+TEST_CASE("program_map::analyze finds the sprites Dxyn draws")
+{
+    const auto system = analyzed_system();
+    const auto map = ch8::program_map::analyze(system.data);
+
+    // I is only known along straight-line code, so the draw in the
+    // subroutine can't be attributed.
+    REQUIRE(map.sprites().empty());
+
+    static constexpr auto program = std::array<std::uint8_t, 8>{
+        0xA2, 0x06, // 200: LD I, 0x206
+        0xD0, 0x12, // 202: DRW V0, V1, 2
+        0x12, 0x04, // 204: JP 0x204
+        0x3C, 0x3C, // 206: sprite
+    };
+    auto drawing = ch8::chip8_system{};
+    load(drawing, program);
+    const auto drawing_map = ch8::program_map::analyze(drawing.data);
+
+    REQUIRE(drawing_map.sprites().size() == 1);
+    REQUIRE(drawing_map.sprites().front().address == 0x206);
+    REQUIRE(drawing_map.sprites().front().rows == 2);
+    REQUIRE(drawing_map.flags(0x206) & ch8::program_map::sprite);
+    REQUIRE(drawing_map.flags(0x207) & ch8::program_map::sprite);
+    REQUIRE_FALSE(drawing_map.is_code(0x206));
+}
+
+TEST_CASE("program_map::analyze follows Bnnn through jump tables")
+{
+    static constexpr auto program = std::array<std::uint8_t, 14>{
+        0xB2, 0x02, // 200: JP V0, 0x202
+        0x12, 0x08, // 202: JP 0x208
+        0x12, 0x0A, // 204: JP 0x20A
+        0x12, 0x0C, // 206: JP 0x20C
+        0x12, 0x08, // 208: JP 0x208
+        0x12, 0x0A, // 20A: JP 0x20A
+        0x12, 0x0C, // 20C: JP 0x20C
+    };
+    auto system = ch8::chip8_system{};
+    load(system, program);
+    const auto map = ch8::program_map::analyze(system.data);
+
+    REQUIRE(map.jump_tables().size() == 1);
+    const auto& table = map.jump_tables().front();
+    REQUIRE(table.site == 0x200);
+    REQUIRE(table.base == 0x202);
+    REQUIRE(table.targets.size() == 6);
+    REQUIRE(map.flags(0x204) & ch8::program_map::jump_table);
+    REQUIRE(map.block_at(0x200)->successors == table.targets);
+}
+
+TEST_CASE("program_map::analyze resolves Bnnn when V0 is known")
+{
+    static constexpr auto program = std::array<std::uint8_t, 10>{
+        0x60, 0x04, // 200: LD V0, 0x04
+        0xB2, 0x04, // 202: JP V0, 0x204
+        0xFF, 0xFF, // 204: data
+        0xFF, 0xFF, // 206: data
+        0x12, 0x08, // 208: JP 0x208
+    };
+    auto system = ch8::chip8_system{};
+    load(system, program);
+    const auto map = ch8::program_map::analyze(system.data);
+
+    REQUIRE(map.jump_tables().front().targets ==
+            std::vector<std::uint16_t>{0x208});
+    REQUIRE_FALSE(map.is_code(0x204));
+    REQUIRE(map.is_code(0x208));
+}
+
+TEST_CASE("program_map::deserialize reads what serialize wrote")
+{
+    const auto system = analyzed_system();
+    const auto map = ch8::program_map::analyze(system.data);
+    const auto bytes = map.serialize();
+    const auto loaded = ch8::program_map::deserialize(bytes);
+
+    REQUIRE(loaded.has_value());
+    for (auto address = std::size_t{0}; address < system.data.ram.size();
+         ++address) {
+        REQUIRE(loaded->flags(address) == map.flags(address));
+    }
+    REQUIRE(loaded->blocks().size() == map.blocks().size());
+    REQUIRE(loaded->block_at(0x214)->address == 0x210);
+    REQUIRE(loaded->calls().size() == map.calls().size());
+    REQUIRE(loaded->functions().size() == map.functions().size());
+    REQUIRE(loaded->functions().at(1).returns);
+    REQUIRE(loaded->serialize() == bytes);
+}
+
+TEST_CASE("program_map::deserialize rejects malformed maps")
+{
+    const auto system = analyzed_system();
+    auto bytes = ch8::program_map::analyze(system.data).serialize();
+
+    SECTION("bad magic")
+    {
+        bytes.front() = 'X';
+    }
+
+    SECTION("truncated")
+    {
+        bytes.pop_back();
+    }
+
+    SECTION("trailing bytes")
+    {
+        bytes.push_back(0);
+    }
+
+    REQUIRE_FALSE(ch8::program_map::deserialize(bytes).has_value());
+}
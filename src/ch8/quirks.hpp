@@ -0,0 +1,37 @@
+#ifndef CH8_QUIRKS_HPP
+#define CH8_QUIRKS_HPP
+
+namespace ch8 {
+    // Behaviour that differs between CHIP-8 interpreters, fixed at compile
+    // time so the instruction handlers don't branch on it.
+    template <bool Accurate8xy6, bool Accurate8xyE>
+    struct quirks {
+        static constexpr auto accurate_8xy6 = Accurate8xy6;
+        static constexpr auto accurate_8xyE = Accurate8xyE;
+    };
+
+    template <typename Function>
+    constexpr auto
+    with_quirks(bool accurate_8xy6, bool accurate_8xyE, Function&& function)
+        -> decltype(function(quirks<false, false>{}));
+} // namespace ch8
+
+// Calls function with the quirks instantiation matching the runtime flags.
+template <typename Function>
+constexpr auto ch8::with_quirks(
+    const bool accurate_8xy6, const bool accurate_8xyE, Function&& function)
+    -> decltype(function(quirks<false, false>{}))
+{
+    if (accurate_8xy6) {
+        if (accurate_8xyE) {
+            return function(quirks<true, true>{});
+        }
+        return function(quirks<true, false>{});
+    }
+    if (accurate_8xyE) {
+        return function(quirks<false, true>{});
+    }
+    return function(quirks<false, false>{});
+}
+
+#endif // CH8_QUIRKS_HPP
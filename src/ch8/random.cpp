@@ -0,0 +1,120 @@
+#include "ch8/random.hpp"
+#include <atomic>
+#include <utility>
+
+namespace {
+    [[nodiscard]] auto process_seed() -> std::uint64_t
+    {
+        static const auto seed = [] {
+            auto device = std::random_device{};
+            const auto high = std::uint64_t{device()};
+            return (high << 32U) | device();
+        }();
+        return seed;
+    }
+
+    [[nodiscard]] auto unique_seed() noexcept -> std::uint64_t
+    {
+        static auto instances = std::atomic<std::uint64_t>{0};
+        auto state =
+            process_seed() + instances.fetch_add(1, std::memory_order_relaxed);
+        return ch8::detail::splitmix64(state);
+    }
+
+    [[nodiscard]] auto make_mersenne(const std::uint64_t value)
+        -> std::unique_ptr<std::mt19937>
+    {
+        auto seed_seq = std::seed_seq{
+            static_cast<std::uint32_t>(value),
+            static_cast<std::uint32_t>(value >> 32U)};
+        return std::make_unique<std::mt19937>(seed_seq);
+    }
+} // namespace
+
+// process_seed can only throw if std::random_device is unusable, in which
+// case there is nothing better to do than terminate.
+ch8::random_generator::random_generator() noexcept
+    : random_generator{unique_seed()}
+{
+}
+
+ch8::random_generator::random_generator(
+    const std::uint64_t value, const random_engine kind)
+    : selected{kind}
+    , seeded_with{value}
+    , xoshiro{value}
+    , mersenne{
+          kind == random_engine::mersenne_twister ? make_mersenne(value)
+                                                  : nullptr}
+{
+}
+
+ch8::random_generator::random_generator(const random_generator& other)
+    : selected{other.selected}
+    , seeded_with{other.seeded_with}
+    , xoshiro{other.xoshiro}
+    , mersenne{
+          other.mersenne ? std::make_unique<std::mt19937>(*other.mersenne)
+                         : nullptr}
+{
+}
+
+// The moved-from generator has no std::mt19937 left, so it falls back to
+// xoshiro.
+ch8::random_generator::random_generator(random_generator&& other) noexcept
+    : selected{std::exchange(other.selected, random_engine::xoshiro)}
+    , seeded_with{other.seeded_with}
+    , xoshiro{other.xoshiro}
+    , mersenne{std::move(other.mersenne)}
+{
+}
+
+ch8::random_generator::~random_generator() = default;
+
+auto ch8::random_generator::operator=(const random_generator& other)
+    -> random_generator&
+{
+    if (this != &other) {
+        *this = random_generator{other};
+    }
+    return *this;
+}
+
+auto ch8::random_generator::operator=(random_generator&& other) noexcept
+    -> random_generator&
+{
+    selected = std::exchange(other.selected, random_engine::xoshiro);
+    seeded_with = other.seeded_with;
+    xoshiro = other.xoshiro;
+    mersenne = std::move(other.mersenne);
+    return *this;
+}
+
+auto ch8::random_generator::seed(const std::uint64_t value) -> void
+{
+    seed(value, selected);
+}
+
+auto ch8::random_generator::seed(
+    const std::uint64_t value, const random_engine kind) -> void
+{
+    selected = kind;
+    seeded_with = value;
+    if (selected == random_engine::xoshiro) {
+        xoshiro.seed(value);
+        mersenne.reset();
+    }
+    else {
+        mersenne = make_mersenne(value);
+    }
+}
+
+auto ch8::random_generator::engine() const noexcept -> random_engine
+{
+    return selected;
+}
+
+auto ch8::random_generator::last_seed() const noexcept -> std::uint64_t
+{
+    return seeded_with;
+}
@@ -0,0 +1,141 @@
+#ifndef CH8_RANDOM_HPP
+#define CH8_RANDOM_HPP
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+
+namespace ch8 {
+    // xoshiro128++ by Blackman and Vigna: 16 bytes of state and a few
+    // instructions per number. Seeds are expanded with splitmix64, so any
+    // 64-bit value, including 0, gives a good state.
+    class xoshiro128 {
+    public:
+        using result_type = std::uint32_t;
+
+        constexpr xoshiro128() noexcept;
+        constexpr explicit xoshiro128(std::uint64_t value) noexcept;
+
+        constexpr auto seed(std::uint64_t value) noexcept -> void;
+        constexpr auto operator()() noexcept -> result_type;
+
+        [[nodiscard]] static constexpr auto min() noexcept -> result_type;
+        [[nodiscard]] static constexpr auto max() noexcept -> result_type;
+
+    private:
+        std::array<std::uint32_t, 4> state;
+    };
+
+    enum class random_engine { xoshiro, mersenne_twister };
+
+    // The generator behind Cxkk. mersenne_twister is kept for runs that need
+    // std::mt19937; its 5 KB of state is only allocated when it is selected.
+    class random_generator {
+    public:
+        // Seeds from a per-process random value and a counter, so
+        // construction never touches std::random_device after the first.
+        random_generator() noexcept;
+        explicit random_generator(
+            std::uint64_t value, random_engine kind = random_engine::xoshiro);
+        random_generator(const random_generator& other);
+        random_generator(random_generator&& other) noexcept;
+        ~random_generator();
+
+        auto operator=(const random_generator& other) -> random_generator&;
+        auto operator=(random_generator&& other) noexcept
+            -> random_generator&;
+
+        auto seed(std::uint64_t value) -> void;
+        auto seed(std::uint64_t value, random_engine kind) -> void;
+
+        [[nodiscard]] auto engine() const noexcept -> random_engine;
+        [[nodiscard]] auto last_seed() const noexcept -> std::uint64_t;
+
+        auto next_byte() noexcept -> std::uint8_t;
+
+    private:
+        random_engine selected;
+        std::uint64_t seeded_with;
+        xoshiro128 xoshiro;
+        std::unique_ptr<std::mt19937> mersenne;
+    };
+} // namespace ch8
+
+namespace ch8::detail {
+    [[nodiscard]] constexpr auto splitmix64(std::uint64_t& state) noexcept
+        -> std::uint64_t
+    {
+        state += 0x9E3779B97F4A7C15U;
+        auto z = state;
+        z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9U;
+        z = (z ^ (z >> 27U)) * 0x94D049BB133111EBU;
+        return z ^ (z >> 31U);
+    }
+
+    [[nodiscard]] constexpr auto
+    rotate_left(const std::uint32_t x, const unsigned k) noexcept
+        -> std::uint32_t
+    {
+        return (x << k) | (x >> (32U - k));
+    }
+} // namespace ch8::detail
+
+constexpr ch8::xoshiro128::xoshiro128() noexcept : xoshiro128{0}
+{
+}
+
+constexpr ch8::xoshiro128::xoshiro128(const std::uint64_t value) noexcept
+    : state{}
+{
+    seed(value);
+}
+
+constexpr auto ch8::xoshiro128::seed(std::uint64_t value) noexcept -> void
+{
+    const auto first = detail::splitmix64(value);
+    const auto second = detail::splitmix64(value);
+    state[0] = static_cast<std::uint32_t>(first);
+    state[1] = static_cast<std::uint32_t>(first >> 32U);
+    state[2] = static_cast<std::uint32_t>(second);
+    state[3] = static_cast<std::uint32_t>(second >> 32U);
+}
+
+constexpr auto ch8::xoshiro128::operator()() noexcept -> result_type
+{
+    const auto result =
+        detail::rotate_left(state[0] + state[3], 7U) + state[0];
+    const auto t = state[1] << 9U;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = detail::rotate_left(state[3], 11U);
+
+    return result;
+}
+
+constexpr auto ch8::xoshiro128::min() noexcept -> result_type
+{
+    return std::numeric_limits<result_type>::min();
+}
+
+constexpr auto ch8::xoshiro128::max() noexcept -> result_type
+{
+    return std::numeric_limits<result_type>::max();
+}
+
+// The top byte is used since the low bits of most generators are the
+// weakest.
+inline auto ch8::random_generator::next_byte() noexcept -> std::uint8_t
+{
+    if (selected == random_engine::xoshiro) {
+        return static_cast<std::uint8_t>(xoshiro() >> 24U);
+    }
+    return static_cast<std::uint8_t>((*mersenne)() >> 24U);
+}
+
+#endif // CH8_RANDOM_HPP
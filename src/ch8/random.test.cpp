@@ -0,0 +1,118 @@
+#include "ch8/random.hpp"
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <random>
+#include <utility>
+
+TEST_CASE("splitmix64 matches the reference implementation")
+{
+    auto state = std::uint64_t{0};
+    REQUIRE(ch8::detail::splitmix64(state) == 0xE220A8397B1DCDAFU);
+    REQUIRE(ch8::detail::splitmix64(state) == 0x6E789E6AA1B965F4U);
+}
+
+TEST_CASE("xoshiro128 repeats its sequence for the same seed")
+{
+    const auto seed = GENERATE(0U, 1U, 0xDEADBEEFU);
+    auto a = ch8::xoshiro128{seed};
+    auto b = ch8::xoshiro128{seed};
+    auto c = ch8::xoshiro128{seed + 1U};
+
+    auto differs = false;
+    for (auto i = 0; i < 100; ++i) {
+        const auto value = a();
+        REQUIRE(value == b());
+        differs = differs || value != c();
+    }
+    REQUIRE(differs);
+}
+
+TEST_CASE("xoshiro128 can be seeded at compile time")
+{
+    constexpr auto first = [] {
+        auto generator = ch8::xoshiro128{42};
+        return generator();
+    }();
+
+    auto generator = ch8::xoshiro128{42};
+    REQUIRE(generator() == first);
+}
+
+TEST_CASE("random_generator::next_byte covers every byte value")
+{
+    auto generator = ch8::random_generator{7};
+    auto counts = std::array<int, 256>{};
+    for (auto i = 0; i < 256 * 64; ++i) {
+        ++counts.at(generator.next_byte());
+    }
+
+    for (const auto count : counts) {
+        REQUIRE(count > 16);
+        REQUIRE(count < 128);
+    }
+}
+
+TEST_CASE("random_generator uses std::mt19937 in mersenne_twister mode")
+{
+    auto generator =
+        ch8::random_generator{5, ch8::random_engine::mersenne_twister};
+    auto seed_seq = std::seed_seq{5U, 0U};
+    auto reference = std::mt19937{seed_seq};
+
+    REQUIRE(generator.engine() == ch8::random_engine::mersenne_twister);
+    for (auto i = 0; i < 100; ++i) {
+        REQUIRE(generator.next_byte() == reference() >> 24U);
+    }
+}
+
+TEST_CASE("random_generator copies continue the same sequence")
+{
+    const auto kind = GENERATE(
+        ch8::random_engine::xoshiro, ch8::random_engine::mersenne_twister);
+    auto generator = ch8::random_generator{3, kind};
+    generator.next_byte();
+
+    auto copy = generator;
+    for (auto i = 0; i < 100; ++i) {
+        REQUIRE(copy.next_byte() == generator.next_byte());
+    }
+}
+
+TEST_CASE("Moved-from random_generators fall back to xoshiro")
+{
+    auto generator =
+        ch8::random_generator{3, ch8::random_engine::mersenne_twister};
+    auto constructed = std::move(generator);
+    auto assigned = ch8::random_generator{};
+    assigned = std::move(constructed);
+
+    REQUIRE(assigned.engine() == ch8::random_engine::mersenne_twister);
+    // NOLINTNEXTLINE(bugprone-use-after-move)
+    REQUIRE(generator.engine() == ch8::random_engine::xoshiro);
+    // NOLINTNEXTLINE(bugprone-use-after-move)
+    REQUIRE(constructed.engine() == ch8::random_engine::xoshiro);
+    generator.next_byte();
+    constructed.next_byte();
+}
+
+TEST_CASE("random_generator::seed restarts the sequence")
+{
+    auto generator = ch8::random_generator{};
+    generator.seed(11, ch8::random_engine::mersenne_twister);
+    const auto first = generator.next_byte();
+    generator.next_byte();
+
+    generator.seed(11);
+    REQUIRE(generator.engine() == ch8::random_engine::mersenne_twister);
+    REQUIRE(generator.last_seed() == 11);
+    REQUIRE(generator.next_byte() == first);
+}
+
+TEST_CASE("random_generator gives every default-constructed instance its own seed")
+{
+    const auto a = ch8::random_generator{};
+    const auto b = ch8::random_generator{};
+    REQUIRE(a.last_seed() != b.last_seed());
+    REQUIRE(a.engine() == ch8::random_engine::xoshiro);
+}
@@ -0,0 +1,80 @@
+#include "ch8/rgba_expand.hpp"
+#include "ch8/random.hpp"
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr auto bench_palette = ch8::palette{{
+        {0, 0, 0, 255},
+        {255, 255, 255, 255},
+        {170, 170, 170, 255},
+        {85, 85, 85, 255},
+        {255, 0, 0, 255},
+        {0, 255, 0, 255},
+        {0, 0, 255, 255},
+        {255, 255, 0, 255},
+        {0, 255, 255, 255},
+        {255, 0, 255, 255},
+        {128, 0, 0, 255},
+        {0, 128, 0, 255},
+        {0, 0, 128, 255},
+        {128, 128, 0, 255},
+        {0, 128, 128, 255},
+        {128, 0, 128, 255},
+    }};
+
+    auto kernel_name(ch8::expand_kernel kernel) -> std::string
+    {
+        switch (kernel) {
+        case ch8::expand_kernel::sse2:
+            return "sse2";
+        case ch8::expand_kernel::avx2:
+            return "avx2";
+        default:
+            return "scalar";
+        }
+    }
+
+    // Benchmarks every supported kernel on a frame of plane_count random
+    // planes, each of words words.
+    auto benchmark_frame(
+        const std::string& frame, std::size_t words, std::size_t plane_count)
+        -> void
+    {
+        auto rng = ch8::xoshiro128{1};
+        auto storage = std::vector<std::vector<std::uint64_t>>(plane_count);
+        auto planes = std::vector<gsl::span<const std::uint64_t>>{};
+        for (auto& plane : storage) {
+            plane.resize(words);
+            for (auto& word : plane) {
+                word = (std::uint64_t{rng()} << 32U) | rng();
+            }
+            planes.emplace_back(plane);
+        }
+        auto rgba = std::vector<std::uint8_t>(words * 64 * 4);
+
+        for (const auto kernel :
+             {ch8::expand_kernel::scalar,
+              ch8::expand_kernel::sse2,
+              ch8::expand_kernel::avx2}) {
+            if (!ch8::supports(kernel)) {
+                continue;
+            }
+            BENCHMARK(frame + ", " + kernel_name(kernel))
+            {
+                ch8::expand_to_rgba(planes, bench_palette, rgba, kernel);
+                return rgba.front();
+            };
+        }
+    }
+} // namespace
+
+TEST_CASE("expand_to_rgba", "[benchmark]")
+{
+    benchmark_frame("64x32", 64 * 32 / 64, 1);
+    benchmark_frame("128x64", 128 * 64 / 64, 1);
+    benchmark_frame("128x64, 4 planes", 128 * 64 / 64, 4);
+}
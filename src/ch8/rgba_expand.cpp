@@ -0,0 +1,226 @@
+#include "ch8/rgba_expand.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#if defined(CH8_SIMD_EXPANSION)
+#    include <immintrin.h>
+#endif
+
+namespace {
+    using color_table = std::array<std::uint32_t, 16>;
+
+    // Packed so that storing the word writes r, g, b, a in that order
+    // whatever the byte order.
+    [[nodiscard]] auto pack(const ch8::color& c) noexcept -> std::uint32_t
+    {
+        const auto bytes = std::array<std::uint8_t, 4>{c.r, c.g, c.b, c.a};
+        auto packed = std::uint32_t{0};
+        std::memcpy(&packed, bytes.data(), sizeof(packed));
+        return packed;
+    }
+
+    [[nodiscard]] auto pack(const ch8::palette& colors) noexcept
+        -> color_table
+    {
+        auto table = color_table{};
+        for (auto i = std::size_t{0}; i < table.size(); ++i) {
+            table[i] = pack(colors[i]);
+        }
+        return table;
+    }
+
+    using planes_type = gsl::span<const gsl::span<const std::uint64_t>>;
+
+    auto expand_scalar(
+        const planes_type planes,
+        const color_table& table,
+        std::uint8_t* out) noexcept -> void
+    {
+        const auto words = planes[0].size();
+        for (auto word = std::size_t{0}; word < words; ++word) {
+            for (auto bit = 64U; bit-- > 0;) {
+                auto value = std::size_t{0};
+                for (auto plane = std::size_t{0}; plane < planes.size();
+                     ++plane) {
+                    value |= ((planes[plane][word] >> bit) & 1U) << plane;
+                }
+                std::memcpy(out, &table[value], sizeof(std::uint32_t));
+                out += sizeof(std::uint32_t);
+            }
+        }
+    }
+
+#if defined(CH8_SIMD_EXPANSION)
+    // Each byte of the plane is broadcast to 4 lanes, and each lane tests
+    // its own bit to pick between the two colors.
+    auto expand_sse2(
+        const gsl::span<const std::uint64_t> plane,
+        const color_table& table,
+        std::uint8_t* out) noexcept -> void
+    {
+        const auto off = _mm_set1_epi32(static_cast<int>(table[0]));
+        const auto on = _mm_set1_epi32(static_cast<int>(table[1]));
+        const auto high_bits = _mm_set_epi32(0x10, 0x20, 0x40, 0x80);
+        const auto low_bits = _mm_set_epi32(0x01, 0x02, 0x04, 0x08);
+
+        const auto select = [&](__m128i byte, __m128i bits) {
+            const auto set = _mm_cmpeq_epi32(_mm_and_si128(byte, bits), bits);
+            return _mm_or_si128(
+                _mm_and_si128(set, on), _mm_andnot_si128(set, off));
+        };
+
+        for (const auto word : plane) {
+            for (auto shift = 64U; shift > 0;) {
+                shift -= 8U;
+                const auto byte =
+                    _mm_set1_epi32(static_cast<int>((word >> shift) & 0xFFU));
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+                auto* const lanes = reinterpret_cast<__m128i*>(out);
+                _mm_storeu_si128(lanes, select(byte, high_bits));
+                _mm_storeu_si128(lanes + 1, select(byte, low_bits));
+                out += 32;
+            }
+        }
+    }
+
+    // Each lane shifts its own bit of every plane into place to build the
+    // pixel value, which indexes the palette with a permute. Values past 7
+    // come from a second permute of the upper half of the palette.
+    __attribute__((target("avx2"))) auto expand_avx2(
+        const planes_type planes,
+        const color_table& table,
+        std::uint8_t* out) noexcept -> void
+    {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        const auto* const halves = reinterpret_cast<const __m256i*>(&table);
+        const auto lower = _mm256_loadu_si256(halves);
+        const auto upper = _mm256_loadu_si256(halves + 1);
+        const auto lane_shifts = _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const auto one = _mm256_set1_epi32(1);
+        const auto seven = _mm256_set1_epi32(7);
+        const auto needs_upper = planes.size() > 3;
+
+        const auto words = planes[0].size();
+        for (auto word = std::size_t{0}; word < words; ++word) {
+            for (auto shift = 64U; shift > 0;) {
+                shift -= 8U;
+                auto value = _mm256_setzero_si256();
+                for (auto plane = std::size_t{0}; plane < planes.size();
+                     ++plane) {
+                    const auto byte = _mm256_set1_epi32(static_cast<int>(
+                        (planes[plane][word] >> shift) & 0xFFU));
+                    const auto bit = _mm256_and_si256(
+                        _mm256_srlv_epi32(byte, lane_shifts), one);
+                    value = _mm256_or_si256(
+                        value,
+                        _mm256_sllv_epi32(
+                            bit, _mm256_set1_epi32(static_cast<int>(plane))));
+                }
+
+                auto pixels = _mm256_permutevar8x32_epi32(lower, value);
+                if (needs_upper) {
+                    pixels = _mm256_blendv_epi8(
+                        pixels,
+                        _mm256_permutevar8x32_epi32(upper, value),
+                        _mm256_cmpgt_epi32(value, seven));
+                }
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), pixels);
+                out += 32;
+            }
+        }
+    }
+
+    [[nodiscard]] auto detect_kernel() noexcept -> ch8::expand_kernel
+    {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return ch8::expand_kernel::avx2;
+        }
+        return ch8::expand_kernel::sse2;
+    }
+#else
+    [[nodiscard]] auto detect_kernel() noexcept -> ch8::expand_kernel
+    {
+        return ch8::expand_kernel::scalar;
+    }
+#endif
+} // namespace
+
+auto ch8::best_expand_kernel(const std::size_t plane_count) noexcept
+    -> expand_kernel
+{
+    static const auto widest = detect_kernel();
+    if (widest == expand_kernel::avx2 && plane_count == 1) {
+        return expand_kernel::sse2;
+    }
+    return widest;
+}
+
+auto ch8::supports(const expand_kernel kernel) noexcept -> bool
+{
+    const auto widest = best_expand_kernel(4);
+    switch (kernel) {
+    case expand_kernel::scalar:
+        return true;
+    case expand_kernel::sse2:
+        return widest != expand_kernel::scalar;
+    case expand_kernel::avx2:
+        return widest == expand_kernel::avx2;
+    default:
+        return false;
+    }
+}
+
+auto ch8::expand_to_rgba(
+    const gsl::span<const gsl::span<const std::uint64_t>> planes,
+    const palette& colors,
+    const gsl::span<std::uint8_t> rgba) -> void
+{
+    expand_to_rgba(planes, colors, rgba, best_expand_kernel(planes.size()));
+}
+
+auto ch8::expand_to_rgba(
+    const gsl::span<const gsl::span<const std::uint64_t>> planes,
+    const palette& colors,
+    const gsl::span<std::uint8_t> rgba,
+    const expand_kernel kernel) -> void
+{
+    gsl_Expects(!planes.empty() && planes.size() <= 4);
+    gsl_Expects(supports(kernel));
+    gsl_Expects(std::all_of(
+        planes.begin(), planes.end(), [&planes](const auto& plane) {
+            return plane.size() == planes[0].size();
+        }));
+    gsl_Expects(rgba.size() >= planes[0].size() * 64 * 4);
+
+    const auto table = pack(colors);
+
+#if defined(CH8_SIMD_EXPANSION)
+    if (kernel == expand_kernel::avx2) {
+        expand_avx2(planes, table, rgba.data());
+        return;
+    }
+    if (kernel == expand_kernel::sse2 && planes.size() == 1) {
+        expand_sse2(planes[0], table, rgba.data());
+        return;
+    }
+#endif
+
+    expand_scalar(planes, table, rgba.data());
+}
+
+auto ch8::expand_to_rgba(
+    const gsl::span<const std::uint64_t> plane,
+    const color& on,
+    const color& off,
+    const gsl::span<std::uint8_t> rgba,
+    const expand_kernel kernel) -> void
+{
+    auto colors = palette{};
+    colors[0] = off;
+    colors[1] = on;
+    const auto planes = std::array<gsl::span<const std::uint64_t>, 1>{plane};
+    expand_to_rgba(planes, colors, rgba, kernel);
+}
@@ -0,0 +1,47 @@
+#ifndef CH8_RGBA_EXPAND_HPP
+#define CH8_RGBA_EXPAND_HPP
+
+#include "ch8/color.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <gsl-lite/gsl-lite.hpp>
+
+namespace ch8 {
+    // The color of each pixel value, where bit p of a value is the pixel's
+    // bit in plane p. A single plane only uses the first two entries.
+    using palette = std::array<color, 16>;
+
+    // sse2 only speeds up single-plane frames and falls back to scalar for
+    // the rest. Neither SIMD kernel exists outside x86-64 GCC and Clang.
+    enum class expand_kernel { scalar, sse2, avx2 };
+
+    // The fastest kernel this CPU supports for frames of plane_count planes,
+    // detected on the first call. Single planes go to sse2 even where avx2
+    // exists, as it has less to set up for the 64x32 frames they mostly are.
+    [[nodiscard]] auto best_expand_kernel(std::size_t plane_count) noexcept
+        -> expand_kernel;
+    [[nodiscard]] auto supports(expand_kernel kernel) noexcept -> bool;
+
+    // Writes the palette color of every pixel of planes into rgba, 4 bytes
+    // per pixel. There are 1 to 4 planes of the same size, holding 64 pixels
+    // per word with the leftmost in the highest bit. Without a kernel, uses
+    // best_expand_kernel(planes.size()).
+    auto expand_to_rgba(
+        gsl::span<const gsl::span<const std::uint64_t>> planes,
+        const palette& colors,
+        gsl::span<std::uint8_t> rgba) -> void;
+    auto expand_to_rgba(
+        gsl::span<const gsl::span<const std::uint64_t>> planes,
+        const palette& colors,
+        gsl::span<std::uint8_t> rgba,
+        expand_kernel kernel) -> void;
+    auto expand_to_rgba(
+        gsl::span<const std::uint64_t> plane,
+        const color& on,
+        const color& off,
+        gsl::span<std::uint8_t> rgba,
+        expand_kernel kernel = best_expand_kernel(1)) -> void;
+} // namespace ch8
+
+#endif // CH8_RGBA_EXPAND_HPP
@@ -0,0 +1,142 @@
+#include "ch8/rgba_expand.hpp"
+#include "ch8/random.hpp"
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace {
+    constexpr auto test_palette = ch8::palette{{
+        {0, 0, 0, 255},
+        {255, 255, 255, 255},
+        {255, 0, 0, 255},
+        {0, 255, 0, 255},
+        {0, 0, 255, 255},
+        {1, 2, 3, 4},
+        {5, 6, 7, 8},
+        {9, 10, 11, 12},
+        {13, 14, 15, 16},
+        {17, 18, 19, 20},
+        {21, 22, 23, 24},
+        {25, 26, 27, 28},
+        {29, 30, 31, 32},
+        {33, 34, 35, 36},
+        {37, 38, 39, 40},
+        {41, 42, 43, 44},
+    }};
+
+    auto random_plane(ch8::xoshiro128& rng, std::size_t words)
+        -> std::vector<std::uint64_t>
+    {
+        auto plane = std::vector<std::uint64_t>(words);
+        for (auto& word : plane) {
+            word = (std::uint64_t{rng()} << 32U) | rng();
+        }
+        return plane;
+    }
+
+    auto color_at(const std::vector<std::uint8_t>& rgba, std::size_t pixel)
+        -> ch8::color
+    {
+        return {
+            rgba.at(pixel * 4),
+            rgba.at(pixel * 4 + 1),
+            rgba.at(pixel * 4 + 2),
+            rgba.at(pixel * 4 + 3)};
+    }
+} // namespace
+
+TEST_CASE("expand_to_rgba writes the leftmost pixel first")
+{
+    constexpr auto on = ch8::color{10, 20, 30, 40};
+    constexpr auto off = ch8::color{50, 60, 70, 80};
+    const auto kernel = GENERATE(
+        ch8::expand_kernel::scalar,
+        ch8::expand_kernel::sse2,
+        ch8::expand_kernel::avx2);
+    if (!ch8::supports(kernel)) {
+        return;
+    }
+
+    const auto plane = std::array<std::uint64_t, 2>{
+        0x8000'0000'0000'0001U, 0x0F00'0000'0000'0000U};
+    auto rgba = std::vector<std::uint8_t>(128 * 4);
+    ch8::expand_to_rgba(plane, on, off, rgba, kernel);
+
+    REQUIRE(color_at(rgba, 0) == on);
+    REQUIRE(color_at(rgba, 1) == off);
+    REQUIRE(color_at(rgba, 62) == off);
+    REQUIRE(color_at(rgba, 63) == on);
+    REQUIRE(color_at(rgba, 67) == off);
+    REQUIRE(color_at(rgba, 68) == on);
+    REQUIRE(color_at(rgba, 71) == on);
+    REQUIRE(color_at(rgba, 72) == off);
+}
+
+TEST_CASE("expand_to_rgba indexes the palette with one bit from each plane")
+{
+    const auto plane_0 = std::array<std::uint64_t, 1>{0xA000'0000'0000'0000U};
+    const auto plane_1 = std::array<std::uint64_t, 1>{0xC000'0000'0000'0000U};
+    const auto plane_3 = std::array<std::uint64_t, 1>{0x1000'0000'0000'0000U};
+    const auto none = std::array<std::uint64_t, 1>{};
+    const auto planes = std::array<gsl::span<const std::uint64_t>, 4>{
+        plane_0, plane_1, none, plane_3};
+
+    auto rgba = std::vector<std::uint8_t>(64 * 4);
+    ch8::expand_to_rgba(planes, test_palette, rgba);
+
+    REQUIRE(color_at(rgba, 0) == test_palette[3]);
+    REQUIRE(color_at(rgba, 1) == test_palette[2]);
+    REQUIRE(color_at(rgba, 2) == test_palette[1]);
+    REQUIRE(color_at(rgba, 3) == test_palette[8]);
+    REQUIRE(color_at(rgba, 4) == test_palette[0]);
+}
+
+TEST_CASE("Every expand_kernel produces the same pixels as scalar")
+{
+    const auto plane_count = GENERATE(1, 2, 3, 4);
+    const auto kernel =
+        GENERATE(ch8::expand_kernel::sse2, ch8::expand_kernel::avx2);
+    if (!ch8::supports(kernel)) {
+        return;
+    }
+
+    constexpr auto words = std::size_t{128};
+    auto rng = ch8::xoshiro128{7};
+    auto storage = std::vector<std::vector<std::uint64_t>>{};
+    auto planes = std::vector<gsl::span<const std::uint64_t>>{};
+    for (auto i = 0; i < plane_count; ++i) {
+        storage.push_back(random_plane(rng, words));
+    }
+    for (const auto& plane : storage) {
+        planes.emplace_back(plane);
+    }
+
+    auto expected = std::vector<std::uint8_t>(words * 64 * 4);
+    auto actual = std::vector<std::uint8_t>(words * 64 * 4);
+    ch8::expand_to_rgba(
+        planes, test_palette, expected, ch8::expand_kernel::scalar);
+    ch8::expand_to_rgba(planes, test_palette, actual, kernel);
+
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("best_expand_kernel is supported")
+{
+    const auto plane_count = GENERATE(1U, 2U, 3U, 4U);
+
+    REQUIRE(ch8::supports(ch8::best_expand_kernel(plane_count)));
+    REQUIRE(ch8::supports(ch8::expand_kernel::scalar));
+}
+
+TEST_CASE("best_expand_kernel picks sse2 for one plane and avx2 for more")
+{
+    if (ch8::supports(ch8::expand_kernel::sse2)) {
+        REQUIRE(ch8::best_expand_kernel(1) == ch8::expand_kernel::sse2);
+    }
+    if (ch8::supports(ch8::expand_kernel::avx2)) {
+        const auto plane_count = GENERATE(2U, 3U, 4U);
+        REQUIRE(
+            ch8::best_expand_kernel(plane_count) == ch8::expand_kernel::avx2);
+    }
+}
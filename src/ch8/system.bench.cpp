@@ -0,0 +1,346 @@
+#include "ch8/system.hpp"
+#include <algorithm>
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// A loop touching every instruction group except Dxyn, so the measurement is
+// dominated by fetch and decode rather than by drawing.
+constexpr auto mixed_opcode_program = std::array<std::uint8_t, 48>{
+    0x6A, 0x05, // 200: LD VA, 0x05
+    0x7A, 0x01, // 202: ADD VA, 0x01
+    0x8A, 0xB4, // 204: ADD VA, VB
+    0x8B, 0xA6, // 206: SHR VB, VA
+    0x8C, 0xAE, // 208: SHL VC, VA
+    0x3A, 0x00, // 20A: SE VA, 0x00
+    0x4B, 0x01, // 20C: SNE VB, 0x01
+    0x5A, 0xB0, // 20E: SE VA, VB
+    0xA3, 0x00, // 210: LD I, 0x300
+    0xF0, 0x1E, // 212: ADD I, V0
+    0xF1, 0x65, // 214: LD V1, [I]
+    0xC0, 0xFF, // 216: RND V0, 0xFF
+    0xF2, 0x07, // 218: LD V2, DT
+    0xE2, 0xA1, // 21A: SKNP V2
+    0x8D, 0xE3, // 21C: XOR VD, VE
+    0x22, 0x28, // 21E: CALL 0x228
+    0x9D, 0xE0, // 220: SNE VD, VE
+    0xF3, 0x29, // 222: LD F, V3
+    0x12, 0x00, // 224: JP 0x200
+    0x00, 0x00, // 226: padding
+    0x8E, 0x15, // 228: SUB VE, V1
+    0x8F, 0x07, // 22A: SUBN VF, V0
+    0x00, 0xEE, // 22C: RET
+    0x00, 0x00, // 22E: padding
+};
+
+// Draws 15 rows of the font at a position that walks over the screen, so
+// most sprites straddle a byte boundary and some wrap.
+constexpr auto drawing_program = std::array<std::uint8_t, 10>{
+    0xA0, 0x00, // 200: LD I, 0x000
+    0xD0, 0x1F, // 202: DRW V0, V1, 15
+    0x70, 0x03, // 204: ADD V0, 0x03
+    0x71, 0x05, // 206: ADD V1, 0x05
+    0x12, 0x02, // 208: JP 0x202
+};
+
+// 8xy_ arithmetic in a tight loop.
+constexpr auto alu_program = std::array<std::uint8_t, 26>{
+    0x60, 0x05, // 200: LD V0, 0x05
+    0x61, 0x03, // 202: LD V1, 0x03
+    0x70, 0x07, // 204: ADD V0, 0x07
+    0x80, 0x11, // 206: OR V0, V1
+    0x80, 0x12, // 208: AND V0, V1
+    0x80, 0x13, // 20A: XOR V0, V1
+    0x80, 0x14, // 20C: ADD V0, V1
+    0x80, 0x15, // 20E: SUB V0, V1
+    0x80, 0x16, // 210: SHR V0, V1
+    0x80, 0x17, // 212: SUBN V0, V1
+    0x80, 0x1E, // 214: SHL V0, V1
+    0x82, 0x00, // 216: LD V2, V0
+    0x12, 0x04, // 218: JP 0x204
+};
+
+// Skips, some taken and some not, and a call.
+constexpr auto branch_program = std::array<std::uint8_t, 24>{
+    0x60, 0x01, // 200: LD V0, 0x01
+    0x30, 0x01, // 202: SE V0, 0x01
+    0x00, 0x00, // 204: skipped
+    0x40, 0x01, // 206: SNE V0, 0x01
+    0x51, 0x00, // 208: SE V1, V0
+    0x90, 0x10, // 20A: SNE V0, V1
+    0x00, 0x00, // 20C: skipped
+    0x22, 0x14, // 20E: CALL 0x214
+    0x12, 0x02, // 210: JP 0x202
+    0x00, 0x00, // 212: padding
+    0x3F, 0x01, // 214: SE VF, 0x01
+    0x00, 0xEE, // 216: RET
+};
+
+// The Fx instructions that go through I.
+constexpr auto memory_program = std::array<std::uint8_t, 16>{
+    0xA3, 0x00, // 200: LD I, 0x300
+    0x60, 0x7B, // 202: LD V0, 0x7B
+    0xF0, 0x33, // 204: LD B, V0
+    0xF2, 0x65, // 206: LD V2, [I]
+    0xF0, 0x1E, // 208: ADD I, V0
+    0xF3, 0x55, // 20A: LD [I], V3
+    0xF1, 0x29, // 20C: LD F, V1
+    0x12, 0x00, // 20E: JP 0x200
+};
+
+template <std::size_t Size>
+auto load(ch8::chip8_system& system, const std::array<std::uint8_t, Size>& rom)
+    -> void
+{
+    std::copy(
+        rom.begin(), rom.end(),
+        system.data.ram.begin() + ch8::chip8_data::program_start);
+}
+
+TEST_CASE("chip8_system::step on a mixed-opcode program", "[benchmark]")
+{
+    constexpr auto steps = 10'000;
+
+    auto system = ch8::chip8_system{};
+    std::copy(
+        mixed_opcode_program.begin(), mixed_opcode_program.end(),
+        system.data.ram.begin() + ch8::chip8_data::program_start);
+
+    BENCHMARK("10'000 instructions")
+    {
+        for (auto i = 0; i < steps; ++i) {
+            system.step();
+        }
+        return system.data.program_counter;
+    };
+}
+
+TEST_CASE("chip8_system::step on a drawing program", "[benchmark]")
+{
+    constexpr auto steps = 10'000;
+
+    auto system = ch8::chip8_system{};
+    std::copy(
+        drawing_program.begin(), drawing_program.end(),
+        system.data.ram.begin() + ch8::chip8_data::program_start);
+
+    BENCHMARK("10'000 instructions")
+    {
+        for (auto i = 0; i < steps; ++i) {
+            system.step();
+        }
+        return system.data.screen.pixel(0, 0);
+    };
+}
+
+TEST_CASE("chip8_system::step on opcode mixes", "[benchmark]")
+{
+    constexpr auto steps = 10'000;
+
+    auto alu = ch8::chip8_system{};
+    load(alu, alu_program);
+    auto branch = ch8::chip8_system{};
+    load(branch, branch_program);
+    auto memory = ch8::chip8_system{};
+    load(memory, memory_program);
+
+    BENCHMARK("alu, 10'000 instructions")
+    {
+        for (auto i = 0; i < steps; ++i) {
+            alu.step();
+        }
+        return alu.data.registers[2];
+    };
+
+    BENCHMARK("branch, 10'000 instructions")
+    {
+        for (auto i = 0; i < steps; ++i) {
+            branch.step();
+        }
+        return branch.data.program_counter;
+    };
+
+    BENCHMARK("memory, 10'000 instructions")
+    {
+        for (auto i = 0; i < steps; ++i) {
+            memory.step();
+        }
+        return memory.data.ram[0x37B];
+    };
+}
+
+// The same Dxyn over and over, drawing the font from address 0. Without wrap
+// the sprite straddles a byte boundary; with it, it wraps around both the
+// right and the bottom edge.
+TEST_CASE("Dxyn by sprite height", "[benchmark]")
+{
+    constexpr auto draws = std::size_t{1'000};
+
+    for (auto height = 1U; height <= 15U; ++height) {
+        for (const auto wrap : {false, true}) {
+            auto system = ch8::chip8_system{};
+            const auto opcode = 0xD010U | height;
+            for (auto i = std::size_t{0}; i < draws; ++i) {
+                const auto address = ch8::chip8_data::program_start + i * 2;
+                system.data.ram[address] =
+                    static_cast<std::uint8_t>(opcode >> 8U);
+                system.data.ram[address + 1] =
+                    static_cast<std::uint8_t>(opcode & 0xFFU);
+            }
+            system.data.registers[0] = wrap ? 60 : 13;
+            system.data.registers[1] = wrap ? 31 : 2;
+            system.data.i_register = 0;
+
+            const auto edges = wrap ? ", wrap" : ", no wrap";
+            BENCHMARK(
+                "height " + std::to_string(height) + edges + ", 1'000 draws")
+            {
+                system.data.program_counter = ch8::chip8_data::program_start;
+                for (auto i = std::size_t{0}; i < draws; ++i) {
+                    system.step();
+                }
+                return system.data.registers[0xF];
+            };
+        }
+    }
+}
+
+TEST_CASE("chip8_system::run on a mixed-opcode program", "[benchmark]")
+{
+    constexpr auto steps = std::size_t{10'000};
+
+    auto system = ch8::chip8_system{};
+    std::copy(
+        mixed_opcode_program.begin(), mixed_opcode_program.end(),
+        system.data.ram.begin() + ch8::chip8_data::program_start);
+
+    BENCHMARK("interpreter, 10'000 instructions")
+    {
+        system.engine = ch8::execution_engine::interpreter;
+        system.run(steps);
+        return system.data.program_counter;
+    };
+
+    BENCHMARK("cached, 10'000 instructions")
+    {
+        system.engine = ch8::execution_engine::cached;
+        system.run(steps);
+        return system.data.program_counter;
+    };
+
+    BENCHMARK("threaded, 10'000 instructions")
+    {
+        system.engine = ch8::execution_engine::threaded;
+        system.run(steps);
+        return system.data.program_counter;
+    };
+
+    BENCHMARK("jit, 10'000 instructions")
+    {
+        system.engine = ch8::execution_engine::jit;
+        system.run(steps);
+        return system.data.program_counter;
+    };
+}
+
+TEST_CASE("chip8_system::execute with cosmac_vip timing", "[benchmark]")
+{
+    auto system = ch8::chip8_system{};
+    std::copy(
+        mixed_opcode_program.begin(), mixed_opcode_program.end(),
+        system.data.ram.begin() + ch8::chip8_data::program_start);
+    system.timing = ch8::timing_model::cosmac_vip;
+    system.max_updates_per_execute = 1'000'000;
+
+    BENCHMARK("one emulated second")
+    {
+        system.execute(std::chrono::seconds{1});
+        return system.data.program_counter;
+    };
+}
+
+// Each observer call converts the whole screen, standing in for a texture
+// upload.
+TEST_CASE("chip8_system::execute on a drawing program", "[benchmark]")
+{
+    auto system = ch8::chip8_system{};
+    std::copy(
+        drawing_program.begin(), drawing_program.end(),
+        system.data.ram.begin() + ch8::chip8_data::program_start);
+    system.updates_per_second = 1'000;
+
+    auto rgba = ch8::frame_buffer<64, 32>{};
+    const auto upload = [&rgba](const auto& screen) {
+        screen.to_rgba(rgba, {255, 255, 255, 255}, {0, 0, 0, 255});
+    };
+    system.observe_event(ch8::chip8_system::observable_event::draw, upload);
+    system.observe_event(ch8::chip8_system::observable_event::frame, upload);
+
+    BENCHMARK("immediate, one emulated second")
+    {
+        system.presentation(ch8::presentation_mode::immediate);
+        system.execute(std::chrono::seconds{1});
+        return rgba.data().front();
+    };
+
+    BENCHMARK("per_frame, one emulated second")
+    {
+        system.presentation(ch8::presentation_mode::per_frame);
+        system.execute(std::chrono::seconds{1});
+        return rgba.data().front();
+    };
+}
+
+TEST_CASE("chip8_system construction", "[benchmark]")
+{
+    BENCHMARK("default")
+    {
+        return ch8::chip8_system{}.data.program_counter;
+    };
+
+    BENCHMARK("seeded, mersenne_twister")
+    {
+        auto system = ch8::chip8_system{};
+        system.seed(1, ch8::random_engine::mersenne_twister);
+        return system.data.program_counter;
+    };
+}
+
+TEST_CASE("chip8_system::reset", "[benchmark]")
+{
+    auto system = ch8::chip8_system{};
+    load(system, mixed_opcode_program);
+    system.run(1'000);
+
+    BENCHMARK("after running a program")
+    {
+        system.reset();
+        return system.data.program_counter;
+    };
+}
+
+TEST_CASE("chip8_system::load_program", "[benchmark]")
+{
+    const auto path =
+        std::filesystem::temp_directory_path() / "ch8_load_program.ch8";
+    {
+        auto file = std::ofstream{path, std::ios::binary};
+        for (auto i = 0; i < 64; ++i) {
+            file.write(
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+                reinterpret_cast<const char*>(mixed_opcode_program.data()),
+                mixed_opcode_program.size());
+        }
+    }
+
+    auto system = ch8::chip8_system{};
+    BENCHMARK("3 KB program")
+    {
+        return system.load_program(path);
+    };
+
+    std::filesystem::remove(path);
+}
@@ -1,17 +1,16 @@
 #include "ch8/system.hpp"
+#include <algorithm>
 #include <cstdint>
 #include <fstream>
-
-[[nodiscard]] constexpr auto
-create_opcode(std::uint8_t byte1, std::uint8_t byte2) noexcept -> std::uint16_t;
+#include <iterator>
 
 auto op_00E0(
-    ch8::chip8_data& data,
-    ch8::observable<const ch8::frame_buffer<64, 32>&>& on_draw) -> void;
-constexpr auto op_00EE(ch8::chip8_data& data) -> void;
+    ch8::chip8_data& data, ch8::frame_presenter& presenter) -> void;
+constexpr auto op_00EE(ch8::chip8_data& data) noexcept -> ch8::trap;
 constexpr auto op_1nnn(ch8::chip8_data& data, std::uint16_t opcode) noexcept
     -> void;
-constexpr auto op_2nnn(ch8::chip8_data& data, std::uint16_t opcode) -> void;
+constexpr auto op_2nnn(ch8::chip8_data& data, std::uint16_t opcode) noexcept
+    -> ch8::trap;
 constexpr auto op_3xkk(ch8::chip8_data& data, std::uint16_t opcode) -> void;
 constexpr auto op_4xkk(ch8::chip8_data& data, std::uint16_t opcode) -> void;
 constexpr auto op_5xy0(ch8::chip8_data& data, std::uint16_t opcode) -> void;
@@ -23,20 +22,20 @@ constexpr auto op_8xy2(ch8::chip8_data& data, std::uint16_t opcode) -> void;
 constexpr auto op_8xy3(ch8::chip8_data& data, std::uint16_t opcode) -> void;
 constexpr auto op_8xy4(ch8::chip8_data& data, std::uint16_t opcode) -> void;
 constexpr auto op_8xy5(ch8::chip8_data& data, std::uint16_t opcode) -> void;
-constexpr auto
-op_8xy6(ch8::chip8_data& data, std::uint16_t opcode, bool accurate) -> void;
+template <typename Quirks>
+constexpr auto op_8xy6(ch8::chip8_data& data, std::uint16_t opcode) -> void;
 constexpr auto op_8xy7(ch8::chip8_data& data, std::uint16_t opcode) -> void;
-constexpr auto
-op_8xyE(ch8::chip8_data& data, std::uint16_t opcode, bool accurate) -> void;
+template <typename Quirks>
+constexpr auto op_8xyE(ch8::chip8_data& data, std::uint16_t opcode) -> void;
 constexpr auto op_9xy0(ch8::chip8_data& data, std::uint16_t opcode) -> void;
 constexpr auto op_Annn(ch8::chip8_data& data, std::uint16_t opcode) noexcept
     -> void;
 constexpr auto op_Bnnn(ch8::chip8_data& data, std::uint16_t opcode) -> void;
-auto op_Cxkk(ch8::chip8_data& data, std::mt19937& rng, std::uint16_t opcode)
-    -> void;
+auto op_Cxkk(
+    ch8::chip8_data& data, ch8::random_generator& rng,
+    std::uint16_t opcode) noexcept -> void;
 auto op_Dxyn(
-    ch8::chip8_data& data,
-    ch8::observable<const ch8::frame_buffer<64, 32>&>& on_draw,
+    ch8::chip8_data& data, ch8::frame_presenter& presenter,
     std::uint16_t opcode) -> void;
 auto op_Ex9E(ch8::chip8_data& data, std::uint16_t opcode) -> void;
 auto op_ExA1(ch8::chip8_data& data, std::uint16_t opcode) -> void;
@@ -46,10 +45,104 @@ constexpr auto op_Fx15(ch8::chip8_data& data, std::uint16_t opcode) -> void;
 constexpr auto op_Fx18(ch8::chip8_data& data, std::uint16_t opcode) -> void;
 constexpr auto op_Fx1E(ch8::chip8_data& data, std::uint16_t opcode) -> void;
 constexpr auto op_Fx29(ch8::chip8_data& data, std::uint16_t opcode) -> void;
-constexpr auto op_Fx33(ch8::chip8_data& data, std::uint16_t opcode) -> void;
-constexpr auto op_Fx55(ch8::chip8_data& data, std::uint16_t opcode) -> void;
+auto op_Fx33(
+    ch8::chip8_data& data, ch8::machine_events& events,
+    std::uint16_t opcode) -> void;
+auto op_Fx55(
+    ch8::chip8_data& data, ch8::machine_events& events,
+    std::uint16_t opcode) -> void;
 constexpr auto op_Fx65(ch8::chip8_data& data, std::uint16_t opcode) -> void;
-constexpr auto unknown_opcode() noexcept -> void;
+
+// Registers are addressed by an opcode nibble and memory by a 12-bit address,
+// so masking the index is enough to keep these accesses in bounds.
+constexpr auto
+register_at(ch8::chip8_data& data, const std::size_t index) noexcept
+    -> std::uint8_t&
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    return data.registers[index & 0xFU];
+}
+
+constexpr auto
+memory_at(ch8::chip8_data& data, const std::size_t address) noexcept
+    -> std::uint8_t&
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    return data.ram[address & 0xFFFU];
+}
+
+// Fetches the opcode at the program counter and steps past it.
+constexpr auto fetch_next(ch8::chip8_data& data) noexcept -> std::uint16_t
+{
+    const auto pc = std::size_t{data.program_counter};
+    data.program_counter += 2U;
+    return ch8::create_opcode(memory_at(data, pc), memory_at(data, pc + 1U));
+}
+
+struct idle_loop {
+    std::size_t offset;
+    std::size_t length;
+    std::uint8_t* polled_register;
+};
+
+// Recognises a jump to itself, an Fx0A that is still waiting, and a delay
+// timer poll (Fx07, 3xkk or 4xkk, then a jump back to the Fx07) that won't
+// exit before the timer next ticks. A length of 0 means the program counter
+// isn't in an idle loop.
+auto find_idle_loop(ch8::chip8_data& data) noexcept -> idle_loop
+{
+    const auto opcode_at = [&data](std::size_t address) {
+        return ch8::create_opcode(
+            memory_at(data, address), memory_at(data, address + 1U));
+    };
+
+    const auto pc = std::size_t{data.program_counter};
+    if (pc + 1U >= data.ram.size()) {
+        return {0, 0, nullptr};
+    }
+
+    const auto opcode = opcode_at(pc);
+
+    if (opcode == (0x1000U | pc)) {
+        return {0, 1, nullptr};
+    }
+
+    if (data.waiting_for_keypress && (opcode & 0xF0FFU) == 0xF00AU) {
+        const auto key = register_at(data, (opcode & 0x0F00U) >> 8U);
+        const auto waiting = key == 0xFF ? data.keypad.none()
+                                         : data.keypad.test(key & 0xFU);
+        return {0, waiting ? 1U : 0U, nullptr};
+    }
+
+    for (auto offset = std::size_t{0}; offset < 3; ++offset) {
+        const auto start = pc - offset * 2U;
+        if (start > pc || start + 5U >= data.ram.size()) {
+            continue;
+        }
+
+        const auto read = opcode_at(start);
+        const auto test = opcode_at(start + 2U);
+        const auto jump = opcode_at(start + 4U);
+
+        const auto reg = (read & 0x0F00U) >> 8U;
+        const auto value = test & 0x00FFU;
+        const auto polls = (read & 0xF0FFU) == 0xF007U &&
+                           (test & 0x0F00U) >> 8U == reg &&
+                           jump == (0x1000U | start);
+        if (!polls) {
+            continue;
+        }
+
+        const auto skip = test & 0xF000U;
+        const auto stays = (skip == 0x3000U && data.delay_timer != value) ||
+                           (skip == 0x4000U && data.delay_timer == value);
+        if (stays) {
+            return {offset, 3, &register_at(data, reg)};
+        }
+    }
+
+    return {0, 0, nullptr};
+}
 
 constexpr auto chip8_font = std::array<std::uint8_t, 80>{
     0xF0, 0x90, 0x90, 0x90, 0xF0, 0x20, 0x60, 0x20, 0x20, 0x70, 0xF0, 0x10,
@@ -73,210 +166,969 @@ ch8::chip8_data::chip8_data() noexcept
     , waiting_for_keypress{false}
 {
     std::copy(chip8_font.begin(), chip8_font.end(), ram.begin());
-    screen.clear({0, 0, 0, 255});
-}
-
-template <typename Generator>
-[[nodiscard]] auto make_random_engine() -> Generator
-{
-    auto seed_data = std::array<std::uint32_t, Generator::state_size>{};
-    auto random_device = std::random_device{};
-    std::generate(seed_data.begin(), seed_data.end(), std::ref(random_device));
-    auto seed_seq = std::seed_seq(seed_data.begin(), seed_data.end());
-
-    return Generator{seed_seq};
 }
 
 ch8::chip8_system::chip8_system()
     : data{}
     , updates_per_second{800}
+    , max_updates_per_execute{1'000}
     , accurate_8xyE{true}
     , accurate_8xy6{true}
-    , time_since_update{0}
-    , time_since_timer_update{0}
-    , rng{make_random_engine<decltype(rng)>()}
+    , skip_idle_loops{true}
+    , engine{execution_engine::interpreter}
+    , timing{timing_model::fixed}
+    , update_progress{0}
+    , timer_phase{0}
+    , cycles{0}
+    , cycle_credit{0}
+    , frame_phase{0}
+    , machine_cycles{0}
+    , rng{}
+    , cache{}
+    , compiler{}
+    , native{}
+    , idle{}
+    , tracer{nullptr}
+    , profiling{nullptr}
+{
+}
+
+// Every row is filled, so decoding an instruction is a single lookup. Quirks
+// are resolved here, once per instantiation, instead of in the handlers.
+template <typename Quirks>
+constexpr auto ch8::chip8_system::make_instructions() -> instruction_table
+{
+    auto table = instruction_table{};
+
+    const auto fill_row = [&table](std::size_t row, instruction op) {
+        for (auto low_byte = std::size_t{0}; low_byte < 256; ++low_byte) {
+            table[row][low_byte] = op;
+        }
+    };
+
+    for (auto row = std::size_t{0}; row < table.size(); ++row) {
+        fill_row(row, [](chip8_system&, std::uint16_t) {
+            return trap::unknown_opcode;
+        });
+    }
+
+    // 0nnn calls a machine code routine on the original hardware and is
+    // ignored here.
+    fill_row(0x0, [](chip8_system&, std::uint16_t) { return trap::none; });
+    table[0x0][0xE0] = [](chip8_system& system, std::uint16_t opcode) {
+        if (opcode == 0x00E0) {
+            op_00E0(system.data, system.presenter);
+        }
+        return trap::none;
+    };
+    table[0x0][0xEE] = [](chip8_system& system, std::uint16_t opcode) {
+        if (opcode == 0x00EE) {
+            return op_00EE(system.data);
+        }
+        return trap::none;
+    };
+
+    fill_row(0x1, [](chip8_system& system, std::uint16_t opcode) {
+        op_1nnn(system.data, opcode);
+        return trap::none;
+    });
+    fill_row(0x2, [](chip8_system& system, std::uint16_t opcode) {
+        return op_2nnn(system.data, opcode);
+    });
+    fill_row(0x3, [](chip8_system& system, std::uint16_t opcode) {
+        op_3xkk(system.data, opcode);
+        return trap::none;
+    });
+    fill_row(0x4, [](chip8_system& system, std::uint16_t opcode) {
+        op_4xkk(system.data, opcode);
+        return trap::none;
+    });
+    fill_row(0x6, [](chip8_system& system, std::uint16_t opcode) {
+        op_6xkk(system.data, opcode);
+        return trap::none;
+    });
+    fill_row(0x7, [](chip8_system& system, std::uint16_t opcode) {
+        op_7xkk(system.data, opcode);
+        return trap::none;
+    });
+
+    auto row_8 = std::array<instruction, 16>{};
+    for (auto& op : row_8) {
+        op = [](chip8_system&, std::uint16_t) { return trap::unknown_opcode; };
+    }
+    row_8[0x0] = [](chip8_system& system, std::uint16_t opcode) {
+        op_8xy0(system.data, opcode);
+        return trap::none;
+    };
+    row_8[0x1] = [](chip8_system& system, std::uint16_t opcode) {
+        op_8xy1(system.data, opcode);
+        return trap::none;
+    };
+    row_8[0x2] = [](chip8_system& system, std::uint16_t opcode) {
+        op_8xy2(system.data, opcode);
+        return trap::none;
+    };
+    row_8[0x3] = [](chip8_system& system, std::uint16_t opcode) {
+        op_8xy3(system.data, opcode);
+        return trap::none;
+    };
+    row_8[0x4] = [](chip8_system& system, std::uint16_t opcode) {
+        op_8xy4(system.data, opcode);
+        return trap::none;
+    };
+    row_8[0x5] = [](chip8_system& system, std::uint16_t opcode) {
+        op_8xy5(system.data, opcode);
+        return trap::none;
+    };
+    row_8[0x6] = [](chip8_system& system, std::uint16_t opcode) {
+        op_8xy6<Quirks>(system.data, opcode);
+        return trap::none;
+    };
+    row_8[0x7] = [](chip8_system& system, std::uint16_t opcode) {
+        op_8xy7(system.data, opcode);
+        return trap::none;
+    };
+    row_8[0xE] = [](chip8_system& system, std::uint16_t opcode) {
+        op_8xyE<Quirks>(system.data, opcode);
+        return trap::none;
+    };
+    for (auto low_byte = std::size_t{0}; low_byte < 256; ++low_byte) {
+        table[0x8][low_byte] = row_8[low_byte & 0xFU];
+    }
+
+    // 5xyN and 9xyN are only defined for N = 0.
+    for (auto low_byte = std::size_t{0}; low_byte < 256; low_byte += 16) {
+        table[0x5][low_byte] = [](chip8_system& system, std::uint16_t opcode) {
+            op_5xy0(system.data, opcode);
+            return trap::none;
+        };
+        table[0x9][low_byte] = [](chip8_system& system, std::uint16_t opcode) {
+            op_9xy0(system.data, opcode);
+            return trap::none;
+        };
+    }
+    fill_row(0xA, [](chip8_system& system, std::uint16_t opcode) {
+        op_Annn(system.data, opcode);
+        return trap::none;
+    });
+    fill_row(0xB, [](chip8_system& system, std::uint16_t opcode) {
+        op_Bnnn(system.data, opcode);
+        return trap::none;
+    });
+    fill_row(0xC, [](chip8_system& system, std::uint16_t opcode) {
+        op_Cxkk(system.data, system.rng, opcode);
+        return trap::none;
+    });
+    fill_row(0xD, [](chip8_system& system, std::uint16_t opcode) {
+        op_Dxyn(system.data, system.presenter, opcode);
+        return trap::none;
+    });
+
+    table[0xE][0x9E] = [](chip8_system& system, std::uint16_t opcode) {
+        op_Ex9E(system.data, opcode);
+        return trap::none;
+    };
+    table[0xE][0xA1] = [](chip8_system& system, std::uint16_t opcode) {
+        op_ExA1(system.data, opcode);
+        return trap::none;
+    };
+
+    table[0xF][0x07] = [](chip8_system& system, std::uint16_t opcode) {
+        op_Fx07(system.data, opcode);
+        return trap::none;
+    };
+    table[0xF][0x0A] = [](chip8_system& system, std::uint16_t opcode) {
+        op_Fx0A(system.data, opcode);
+        return trap::none;
+    };
+    table[0xF][0x15] = [](chip8_system& system, std::uint16_t opcode) {
+        op_Fx15(system.data, opcode);
+        return trap::none;
+    };
+    table[0xF][0x18] = [](chip8_system& system, std::uint16_t opcode) {
+        op_Fx18(system.data, opcode);
+        return trap::none;
+    };
+    table[0xF][0x1E] = [](chip8_system& system, std::uint16_t opcode) {
+        op_Fx1E(system.data, opcode);
+        return trap::none;
+    };
+    table[0xF][0x29] = [](chip8_system& system, std::uint16_t opcode) {
+        op_Fx29(system.data, opcode);
+        return trap::none;
+    };
+    table[0xF][0x33] = [](chip8_system& system, std::uint16_t opcode) {
+        op_Fx33(system.data, system.events, opcode);
+        return trap::none;
+    };
+    table[0xF][0x55] = [](chip8_system& system, std::uint16_t opcode) {
+        op_Fx55(system.data, system.events, opcode);
+        return trap::none;
+    };
+    table[0xF][0x65] = [](chip8_system& system, std::uint16_t opcode) {
+        op_Fx65(system.data, opcode);
+        return trap::none;
+    };
+
+    return table;
+}
+
+template <typename Quirks>
+const ch8::instruction_table ch8::chip8_system::instructions =
+    make_instructions<Quirks>();
+
+auto ch8::chip8_system::step() noexcept -> trap
 {
+    return with_quirks(accurate_8xy6, accurate_8xyE, [this](auto quirk_set) {
+        return step<decltype(quirk_set)>();
+    });
 }
 
-auto ch8::chip8_system::step() -> void
+template <typename Quirks>
+auto ch8::chip8_system::step() noexcept -> trap
 {
-    const auto byte1 = data.ram.at(data.program_counter);
-    const auto byte2 = data.ram.at(data.program_counter + 1U);
-    const auto opcode = create_opcode(byte1, byte2);
+    const auto pc = data.program_counter;
+    if (pc + 1U >= data.ram.size()) {
+        return trap::pc_out_of_range;
+    }
+
+    const auto opcode =
+        create_opcode(memory_at(data, pc), memory_at(data, pc + 1U));
 
     if (!data.waiting_for_keypress) {
         data.program_counter += 2;
     }
 
-    switch (opcode & 0xF000U) {
-    case 0x0000:
-        switch (opcode) {
-        case 0x00E0:
-            op_00E0(data, on_draw);
-            break;
-        case 0x00EE:
-            op_00EE(data);
-            break;
-        default:
-            unknown_opcode();
+    const auto sampled = profiling != nullptr && profiling->count(pc, opcode);
+    const auto started =
+        sampled ? profiler::clock::now() : profiler::clock::time_point{};
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    const auto result = instructions<Quirks>[opcode >> 12U][opcode & 0x00FFU](
+        *this, opcode);
+    if (sampled) {
+        profiling->sample(opcode, profiler::clock::now() - started);
+    }
+    if (result != trap::none) {
+        data.program_counter = pc;
+    }
+
+#if defined(CH8_INSTRUCTION_TRACE)
+    if (tracer != nullptr && result == trap::none) {
+        const auto x = static_cast<std::uint8_t>((opcode & 0x0F00U) >> 8U);
+        tracer->push({pc, opcode, data.i_register, x, register_at(data, x)});
+    }
+#endif
+
+    return result;
+}
+
+template auto ch8::chip8_system::step<ch8::quirks<false, false>>() noexcept
+    -> trap;
+template auto ch8::chip8_system::step<ch8::quirks<false, true>>() noexcept
+    -> trap;
+template auto ch8::chip8_system::step<ch8::quirks<true, false>>() noexcept
+    -> trap;
+template auto ch8::chip8_system::step<ch8::quirks<true, true>>() noexcept
+    -> trap;
+
+// Sound and the key wait are synced once the run is over, rather than after
+// every instruction, so the engines don't need to report them.
+auto ch8::chip8_system::run(const std::size_t instruction_count) -> trap
+{
+    return settle(run_skipping_idle(instruction_count));
+}
+
+// Idle loops only change the program counter, and Vx for a delay timer poll,
+// until a timer ticks or the keypad changes. Neither can happen during a run,
+// so whole iterations are skipped rather than executed.
+auto ch8::chip8_system::run_skipping_idle(std::size_t instruction_count)
+    -> trap
+{
+    while (skip_idle_loops && !instrumented() && instruction_count > 0) {
+        const auto loop = find_idle_loop(data);
+        if (loop.length == 0) {
             break;
         }
-        break;
-    case 0x1000:
-        op_1nnn(data, opcode);
-        break;
-    case 0x2000:
-        op_2nnn(data, opcode);
-        break;
-    case 0x3000:
-        op_3xkk(data, opcode);
-        break;
-    case 0x4000:
-        op_4xkk(data, opcode);
-        break;
-    case 0x5000:
-        op_5xy0(data, opcode);
-        break;
-    case 0x6000:
-        op_6xkk(data, opcode);
-        break;
-    case 0x7000:
-        op_7xkk(data, opcode);
-        break;
-    case 0x8000:
-        switch (opcode & 0x000FU) {
-        case 0x0000:
-            op_8xy0(data, opcode);
-            break;
-        case 0x0001:
-            op_8xy1(data, opcode);
-            break;
-        case 0x0002:
-            op_8xy2(data, opcode);
-            break;
-        case 0x0003:
-            op_8xy3(data, opcode);
-            break;
-        case 0x0004:
-            op_8xy4(data, opcode);
-            break;
-        case 0x0005:
-            op_8xy5(data, opcode);
-            break;
-        case 0x0006:
-            op_8xy6(data, opcode, accurate_8xy6);
-            break;
-        case 0x0007:
-            op_8xy7(data, opcode);
-            break;
-        case 0x000E:
-            op_8xyE(data, opcode, accurate_8xyE);
-            break;
-        default:
-            unknown_opcode();
-            break;
+
+        if (loop.offset != 0) {
+            const auto count =
+                std::min(instruction_count, loop.length - loop.offset);
+            const auto result = run_engine(count);
+            if (result != trap::none) {
+                return result;
+            }
+            instruction_count -= count;
+            continue;
         }
-        break;
-    case 0x9000:
-        op_9xy0(data, opcode);
-        break;
-    case 0xA000:
-        op_Annn(data, opcode);
-        break;
-    case 0xB000:
-        op_Bnnn(data, opcode);
-        break;
-    case 0xC000:
-        op_Cxkk(data, rng, opcode);
-        break;
-    case 0xD000:
-        op_Dxyn(data, on_draw, opcode);
-        break;
-    case 0xE000:
-        switch (opcode & 0x00FFU) {
-        case 0x009E:
-            op_Ex9E(data, opcode);
-            break;
-        case 0x00A1:
-            op_ExA1(data, opcode);
-            break;
-        default:
-            unknown_opcode();
-            break;
+
+        const auto skipped =
+            instruction_count - instruction_count % loop.length;
+        if (skipped > 0) {
+            if (loop.polled_register != nullptr) {
+                *loop.polled_register = data.delay_timer;
+            }
+            ++idle.fast_forwards;
+            idle.skipped_instructions += skipped;
         }
+        instruction_count -= skipped;
         break;
-    case 0xF000:
-        switch (opcode & 0x00FFU) {
-        case 0x0007:
-            op_Fx07(data, opcode);
-            break;
-        case 0x000A:
-            op_Fx0A(data, opcode);
-            break;
-        case 0x0015:
-            op_Fx15(data, opcode);
-            break;
-        case 0x0018:
-            op_Fx18(data, opcode);
-            break;
-        case 0x001E:
-            op_Fx1E(data, opcode);
-            break;
-        case 0x0029:
-            op_Fx29(data, opcode);
-            break;
-        case 0x0033:
-            op_Fx33(data, opcode);
-            break;
-        case 0x0055:
-            op_Fx55(data, opcode);
-            break;
-        case 0x0065:
-            op_Fx65(data, opcode);
-            break;
-        default:
-            unknown_opcode();
-            break;
+    }
+
+    return run_engine(instruction_count);
+}
+
+auto ch8::chip8_system::run_engine(const std::size_t instruction_count)
+    -> trap
+{
+    switch (instrumented() ? execution_engine::interpreter : engine) {
+    case execution_engine::cached:
+        return cache.run(*this, instruction_count);
+    case execution_engine::threaded:
+        return with_quirks(
+            accurate_8xy6, accurate_8xyE,
+            [this, instruction_count](auto quirk_set) {
+                return run_threaded<decltype(quirk_set)>(instruction_count);
+            });
+    case execution_engine::jit:
+        return compiler.run(*this, instruction_count);
+    case execution_engine::native:
+        // Native blocks store to ram themselves, so watched writes are only
+        // seen by interpreting.
+        if (!events.observed(machine_event::memory_write)) {
+            return native.run(*this, instruction_count);
         }
-        break;
+        [[fallthrough]];
     default:
-        unknown_opcode();
-        break;
+        return with_quirks(
+            accurate_8xy6, accurate_8xyE,
+            [this, instruction_count](auto quirk_set) {
+                for (auto i = std::size_t{0}; i < instruction_count; ++i) {
+                    const auto result = step<decltype(quirk_set)>();
+                    if (result != trap::none) {
+                        return result;
+                    }
+                }
+                return trap::none;
+            });
+    }
+}
+
+auto ch8::chip8_system::active_instructions() const noexcept
+    -> const instruction_table&
+{
+    const instruction_table* table = nullptr;
+    with_quirks(accurate_8xy6, accurate_8xyE, [&table](auto quirk_set) {
+        table = &instructions<decltype(quirk_set)>;
+    });
+
+    return *table;
+}
+
+// The program counter is already past the first instruction of the pair, so
+// each handler fetches the second one from there.
+auto ch8::chip8_system::fused_instruction(const fusion kind) noexcept
+    -> instruction
+{
+    switch (kind) {
+    case fusion::load_and_draw:
+        return [](chip8_system& system, std::uint16_t opcode) {
+            op_Annn(system.data, opcode);
+            const auto second = fetch_next(system.data);
+            op_Dxyn(system.data, system.presenter, second);
+            return trap::none;
+        };
+    case fusion::load_pair:
+        return [](chip8_system& system, std::uint16_t opcode) {
+            op_6xkk(system.data, opcode);
+            op_6xkk(system.data, fetch_next(system.data));
+            return trap::none;
+        };
+    case fusion::skip_and_jump:
+        return [](chip8_system& system, std::uint16_t opcode) {
+            const auto next = system.data.program_counter;
+            if ((opcode & 0xF000U) == 0x3000U) {
+                op_3xkk(system.data, opcode);
+            }
+            else {
+                op_4xkk(system.data, opcode);
+            }
+            if (system.data.program_counter == next) {
+                op_1nnn(system.data, fetch_next(system.data));
+            }
+            return trap::none;
+        };
+    case fusion::add_and_load:
+        return [](chip8_system& system, std::uint16_t opcode) {
+            op_Fx1E(system.data, opcode);
+            op_Fx65(system.data, fetch_next(system.data));
+            return trap::none;
+        };
+    case fusion::none:
+    default:
+        return nullptr;
+    }
+}
+
+#if defined(CH8_THREADED_INTERPRETER)
+enum class threaded_op : std::uint8_t {
+    unknown,
+    op_0nnn,
+    op_00E0,
+    op_00EE,
+    op_1nnn,
+    op_2nnn,
+    op_3xkk,
+    op_4xkk,
+    op_5xy0,
+    op_6xkk,
+    op_7xkk,
+    op_8xy0,
+    op_8xy1,
+    op_8xy2,
+    op_8xy3,
+    op_8xy4,
+    op_8xy5,
+    op_8xy6,
+    op_8xy7,
+    op_8xyE,
+    op_9xy0,
+    op_Annn,
+    op_Bnnn,
+    op_Cxkk,
+    op_Dxyn,
+    op_Ex9E,
+    op_ExA1,
+    op_Fx07,
+    op_Fx0A,
+    op_Fx15,
+    op_Fx18,
+    op_Fx1E,
+    op_Fx29,
+    op_Fx33,
+    op_Fx55,
+    op_Fx65,
+    count
+};
+
+// Same layout as chip8_system::instructions, but holding label indices for
+// the threaded interpreter instead of function pointers.
+constexpr auto threaded_ops = []() constexpr {
+    using row = std::array<threaded_op, 256>;
+    auto table = std::array<row, 16>{};
+
+    const auto fill_row = [&table](std::size_t index, threaded_op op) {
+        for (auto low_byte = std::size_t{0}; low_byte < 256; ++low_byte) {
+            table[index][low_byte] = op;
+        }
+    };
+
+    for (auto index = std::size_t{0}; index < table.size(); ++index) {
+        fill_row(index, threaded_op::unknown);
+    }
+
+    fill_row(0x0, threaded_op::op_0nnn);
+    table[0x0][0xE0] = threaded_op::op_00E0;
+    table[0x0][0xEE] = threaded_op::op_00EE;
+    fill_row(0x1, threaded_op::op_1nnn);
+    fill_row(0x2, threaded_op::op_2nnn);
+    fill_row(0x3, threaded_op::op_3xkk);
+    fill_row(0x4, threaded_op::op_4xkk);
+    fill_row(0x6, threaded_op::op_6xkk);
+    fill_row(0x7, threaded_op::op_7xkk);
+
+    for (auto low_byte = std::size_t{0}; low_byte < 256; ++low_byte) {
+        constexpr auto row_8 = std::array<threaded_op, 16>{
+            threaded_op::op_8xy0, threaded_op::op_8xy1, threaded_op::op_8xy2,
+            threaded_op::op_8xy3, threaded_op::op_8xy4, threaded_op::op_8xy5,
+            threaded_op::op_8xy6, threaded_op::op_8xy7, threaded_op::unknown,
+            threaded_op::unknown, threaded_op::unknown, threaded_op::unknown,
+            threaded_op::unknown, threaded_op::unknown, threaded_op::op_8xyE,
+            threaded_op::unknown};
+        table[0x8][low_byte] = row_8[low_byte & 0xFU];
+    }
+
+    for (auto low_byte = std::size_t{0}; low_byte < 256; low_byte += 16) {
+        table[0x5][low_byte] = threaded_op::op_5xy0;
+        table[0x9][low_byte] = threaded_op::op_9xy0;
+    }
+    fill_row(0xA, threaded_op::op_Annn);
+    fill_row(0xB, threaded_op::op_Bnnn);
+    fill_row(0xC, threaded_op::op_Cxkk);
+    fill_row(0xD, threaded_op::op_Dxyn);
+
+    table[0xE][0x9E] = threaded_op::op_Ex9E;
+    table[0xE][0xA1] = threaded_op::op_ExA1;
+
+    table[0xF][0x07] = threaded_op::op_Fx07;
+    table[0xF][0x0A] = threaded_op::op_Fx0A;
+    table[0xF][0x15] = threaded_op::op_Fx15;
+    table[0xF][0x18] = threaded_op::op_Fx18;
+    table[0xF][0x1E] = threaded_op::op_Fx1E;
+    table[0xF][0x29] = threaded_op::op_Fx29;
+    table[0xF][0x33] = threaded_op::op_Fx33;
+    table[0xF][0x55] = threaded_op::op_Fx55;
+    table[0xF][0x65] = threaded_op::op_Fx65;
+
+    return table;
+}();
+
+#    pragma GCC diagnostic push
+#    pragma GCC diagnostic ignored "-Wpedantic"
+
+// Every handler ends by fetching and dispatching the next instruction itself,
+// so each one gets its own indirect branch instead of sharing the one in
+// step().
+template <typename Quirks>
+auto ch8::chip8_system::run_threaded(std::size_t instruction_count) -> trap
+{
+    static void* const targets[] = {
+        &&unknown, &&do_0nnn, &&do_00E0, &&do_00EE, &&do_1nnn, &&do_2nnn,
+        &&do_3xkk, &&do_4xkk, &&do_5xy0, &&do_6xkk, &&do_7xkk, &&do_8xy0,
+        &&do_8xy1, &&do_8xy2, &&do_8xy3, &&do_8xy4, &&do_8xy5, &&do_8xy6,
+        &&do_8xy7, &&do_8xyE, &&do_9xy0, &&do_Annn, &&do_Bnnn, &&do_Cxkk,
+        &&do_Dxyn, &&do_Ex9E, &&do_ExA1, &&do_Fx07, &&do_Fx0A, &&do_Fx15,
+        &&do_Fx18, &&do_Fx1E, &&do_Fx29, &&do_Fx33, &&do_Fx55, &&do_Fx65};
+
+    static_assert(
+        std::size(targets) == static_cast<std::size_t>(threaded_op::count));
+
+    auto pc = std::uint16_t{0};
+    auto opcode = std::uint16_t{0};
+    auto result = trap::none;
+
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#    define CH8_DISPATCH()                                                     \
+        if (instruction_count == 0) {                                          \
+            return trap::none;                                                 \
+        }                                                                      \
+        pc = data.program_counter;                                             \
+        if (pc + 1U >= data.ram.size()) {                                      \
+            return trap::pc_out_of_range;                                      \
+        }                                                                      \
+        --instruction_count;                                                   \
+        opcode = create_opcode(memory_at(data, pc), memory_at(data, pc + 1U)); \
+        if (!data.waiting_for_keypress) {                                      \
+            data.program_counter += 2;                                         \
+        }                                                                      \
+        goto* targets[static_cast<std::size_t>(                                \
+            threaded_ops[opcode >> 12U][opcode & 0x00FFU])]
+
+    CH8_DISPATCH();
+
+unknown:
+    data.program_counter = pc;
+    return trap::unknown_opcode;
+do_0nnn:
+    CH8_DISPATCH();
+do_00E0:
+    if (opcode == 0x00E0) {
+        op_00E0(data, presenter);
+    }
+    CH8_DISPATCH();
+do_00EE:
+    if (opcode == 0x00EE) {
+        result = op_00EE(data);
+        if (result != trap::none) {
+            data.program_counter = pc;
+            return result;
+        }
+    }
+    CH8_DISPATCH();
+do_1nnn:
+    op_1nnn(data, opcode);
+    CH8_DISPATCH();
+do_2nnn:
+    result = op_2nnn(data, opcode);
+    if (result != trap::none) {
+        data.program_counter = pc;
+        return result;
+    }
+    CH8_DISPATCH();
+do_3xkk:
+    op_3xkk(data, opcode);
+    CH8_DISPATCH();
+do_4xkk:
+    op_4xkk(data, opcode);
+    CH8_DISPATCH();
+do_5xy0:
+    op_5xy0(data, opcode);
+    CH8_DISPATCH();
+do_6xkk:
+    op_6xkk(data, opcode);
+    CH8_DISPATCH();
+do_7xkk:
+    op_7xkk(data, opcode);
+    CH8_DISPATCH();
+do_8xy0:
+    op_8xy0(data, opcode);
+    CH8_DISPATCH();
+do_8xy1:
+    op_8xy1(data, opcode);
+    CH8_DISPATCH();
+do_8xy2:
+    op_8xy2(data, opcode);
+    CH8_DISPATCH();
+do_8xy3:
+    op_8xy3(data, opcode);
+    CH8_DISPATCH();
+do_8xy4:
+    op_8xy4(data, opcode);
+    CH8_DISPATCH();
+do_8xy5:
+    op_8xy5(data, opcode);
+    CH8_DISPATCH();
+do_8xy6:
+    op_8xy6<Quirks>(data, opcode);
+    CH8_DISPATCH();
+do_8xy7:
+    op_8xy7(data, opcode);
+    CH8_DISPATCH();
+do_8xyE:
+    op_8xyE<Quirks>(data, opcode);
+    CH8_DISPATCH();
+do_9xy0:
+    op_9xy0(data, opcode);
+    CH8_DISPATCH();
+do_Annn:
+    op_Annn(data, opcode);
+    CH8_DISPATCH();
+do_Bnnn:
+    op_Bnnn(data, opcode);
+    CH8_DISPATCH();
+do_Cxkk:
+    op_Cxkk(data, rng, opcode);
+    CH8_DISPATCH();
+do_Dxyn:
+    op_Dxyn(data, presenter, opcode);
+    CH8_DISPATCH();
+do_Ex9E:
+    op_Ex9E(data, opcode);
+    CH8_DISPATCH();
+do_ExA1:
+    op_ExA1(data, opcode);
+    CH8_DISPATCH();
+do_Fx07:
+    op_Fx07(data, opcode);
+    CH8_DISPATCH();
+do_Fx0A:
+    op_Fx0A(data, opcode);
+    CH8_DISPATCH();
+do_Fx15:
+    op_Fx15(data, opcode);
+    CH8_DISPATCH();
+do_Fx18:
+    op_Fx18(data, opcode);
+    CH8_DISPATCH();
+do_Fx1E:
+    op_Fx1E(data, opcode);
+    CH8_DISPATCH();
+do_Fx29:
+    op_Fx29(data, opcode);
+    CH8_DISPATCH();
+do_Fx33:
+    op_Fx33(data, events, opcode);
+    CH8_DISPATCH();
+do_Fx55:
+    op_Fx55(data, events, opcode);
+    CH8_DISPATCH();
+do_Fx65:
+    op_Fx65(data, opcode);
+    CH8_DISPATCH();
+
+#    undef CH8_DISPATCH
+}
+
+#    pragma GCC diagnostic pop
+#else
+template <typename Quirks>
+auto ch8::chip8_system::run_threaded(std::size_t instruction_count) -> trap
+{
+    for (; instruction_count > 0; --instruction_count) {
+        const auto result = step<Quirks>();
+        if (result != trap::none) {
+            return result;
+        }
     }
+
+    return trap::none;
 }
+#endif
 
-auto ch8::chip8_system::execute(const delta_time dt) -> void
+// Whatever was drawn since the last vblank is presented at the end, trap or
+// not, so the host sees the screen the batch left behind.
+auto ch8::chip8_system::execute(const delta_time dt) -> trap
 {
-    namespace chrono = std::chrono;
-    using namespace std::chrono_literals;
+    const auto result = timing == timing_model::cosmac_vip ? execute_vip(dt)
+                                                           : execute_fixed(dt);
+    present();
+    return result;
+}
 
-    time_since_timer_update += dt;
-    time_since_update += dt;
+// Runs every instruction owed for dt, up to max_updates_per_execute. Time
+// past the cap is dropped so a slow host can't fall further and further
+// behind. Timers follow emulated time, which is the instruction count divided
+// by updates_per_second, so they slow down with the program when the budget
+// cuts an update short. Runs are split where a 60 Hz tick falls, which keeps
+// the timers constant inside every run and out of the step loop entirely.
+auto ch8::chip8_system::execute_fixed(const delta_time dt) -> trap
+{
+    constexpr auto period = std::int64_t{1'000'000};
+    constexpr auto timer_frequency = std::int64_t{60};
+
+    const auto frequency = std::int64_t{std::max(updates_per_second, 0)};
+    if (frequency == 0) {
+        return trap::none;
+    }
 
-    if (time_since_timer_update >= 16ms) {
-        if (data.sound_timer > 0) {
-            data.sound_timer--;
+    update_progress += std::int64_t{dt.count()} * frequency;
+    const auto owed = static_cast<std::size_t>(update_progress / period);
+    update_progress %= period;
+
+    for (auto count = std::min(owed, max_updates_per_execute); count > 0;) {
+        for (; timer_phase >= frequency; timer_phase -= frequency) {
+            vblank();
+        }
+        const auto until_tick = static_cast<std::size_t>(
+            (frequency - timer_phase + timer_frequency - 1) / timer_frequency);
+        const auto slice = std::min(count, until_tick);
+
+        const auto result = run(slice);
+        if (result != trap::none) {
+            return result;
         }
-        if (data.delay_timer > 0) {
-            data.delay_timer--;
+        count -= slice;
+        cycles += slice;
+
+        timer_phase += static_cast<std::int64_t>(slice) * timer_frequency;
+        for (; timer_phase >= frequency; timer_phase -= frequency) {
+            vblank();
         }
-        time_since_timer_update = 0us;
     }
 
-    if (updates_per_second <= 0) {
-        return;
+    return trap::none;
+}
+
+// Runs instructions until the machine cycles owed for dt are spent. When an
+// instruction ends past a frame, the display and its interrupt take their
+// cycles and the timers tick.
+auto ch8::chip8_system::execute_vip(const delta_time dt) -> trap
+{
+    constexpr auto period = std::int64_t{1'000'000};
+    constexpr auto frame = vip::cycles_per_frame;
+
+    update_progress +=
+        std::int64_t{dt.count()} * std::int64_t{vip::cycles_per_second};
+    cycle_credit += update_progress / period;
+    update_progress %= period;
+
+    return settle(with_quirks(
+        accurate_8xy6, accurate_8xyE, [this](auto quirk_set) {
+            auto budget = max_updates_per_execute;
+            while (cycle_credit > 0) {
+                if (budget == 0) {
+                    cycle_credit = 0;
+                    break;
+                }
+                --budget;
+
+                const auto result = step_vip<decltype(quirk_set)>();
+                if (result != trap::none) {
+                    return result;
+                }
+
+                if (frame_phase >= frame) {
+                    frame_phase = frame_phase - frame + vip::stolen_cycles;
+                    cycle_credit -= std::int64_t{vip::stolen_cycles};
+                    machine_cycles += vip::stolen_cycles;
+                    vblank();
+                }
+            }
+            return trap::none;
+        }));
+}
+
+// Looks the cost up before the instruction changes the state it depends on,
+// except for whether a skip was taken, which only shows afterwards.
+template <typename Quirks>
+auto ch8::chip8_system::step_vip() noexcept -> trap
+{
+    const auto pc = data.program_counter;
+    const auto opcode = create_opcode(
+        data.ram[pc % data.ram.size()], data.ram[(pc + 1U) % data.ram.size()]);
+    const auto x = std::size_t{(opcode & 0x0F00U) >> 8U};
+    const auto& cost = vip::timing[timing_index(opcode)];
+    const auto unaligned = (data.registers[x] & 0x7U) != 0;
+
+    const auto result = step<Quirks>();
+    if (result != trap::none) {
+        return result;
+    }
+
+    const auto taken = data.program_counter == pc + 4U;
+    const auto cycles_used = cost.base + cost.per_register * (x + 1U) +
+                             cost.unaligned * std::size_t{unaligned} +
+                             cost.skip_taken * std::size_t{taken};
+
+    cycle_credit -= static_cast<std::int64_t>(cycles_used);
+    frame_phase += cycles_used;
+    machine_cycles += cycles_used;
+    ++cycles;
+    return trap::none;
+}
+
+// Reports what a run left behind: a trap, and whether sound or the key wait
+// changed.
+auto ch8::chip8_system::settle(const trap result) -> trap
+{
+    events.sync(data);
+    if (result != trap::none) {
+        events.trapped(result);
     }
+    return result;
+}
+
+auto ch8::chip8_system::vblank() -> void
+{
+    update_timers();
+    present();
+}
 
-    const auto tick = chrono::microseconds{1'000'000 / updates_per_second};
-    if (time_since_update >= tick) {
-        step();
-        time_since_update = 0us;
+auto ch8::chip8_system::present() -> void
+{
+    presenter.present(data.screen);
+}
+
+// Counts both timers down by one 60 Hz tick.
+auto ch8::chip8_system::update_timers() noexcept -> void
+{
+    if (data.sound_timer > 0) {
+        data.sound_timer--;
     }
+    if (data.delay_timer > 0) {
+        data.delay_timer--;
+        if (data.delay_timer == 0) {
+            events.delay_timer_zero();
+        }
+    }
+    events.sync(data);
+}
+
+auto ch8::chip8_system::trace(trace_ring* const ring) noexcept -> void
+{
+    tracer = ring;
+}
+
+auto ch8::chip8_system::profile(profiler* const counts) noexcept -> void
+{
+    profiling = counts;
+}
+
+// The block engines don't go through step(), where instructions are traced
+// and profiled, and skipped idle loop iterations would be missing.
+auto ch8::chip8_system::instrumented() const noexcept -> bool
+{
+#if defined(CH8_INSTRUCTION_TRACE)
+    return tracer != nullptr || profiling != nullptr;
+#else
+    return profiling != nullptr;
+#endif
 }
 
 auto ch8::chip8_system::reset() noexcept -> void
 {
     data = chip8_data{};
+    update_progress = 0;
+    timer_phase = 0;
+    cycles = 0;
+    cycle_credit = 0;
+    frame_phase = 0;
+    machine_cycles = 0;
+    cache.clear();
+    compiler.clear();
+    presenter.discard();
+    events.sync(data);
+}
+
+auto ch8::chip8_system::seed(
+    const std::uint64_t value, const random_engine kind) -> void
+{
+    rng.seed(value, kind);
+}
+
+auto ch8::chip8_system::cache_stats() const noexcept
+    -> const block_cache::statistics&
+{
+    return cache.stats();
+}
+
+auto ch8::chip8_system::jit_stats() const noexcept
+    -> const jit_compiler::statistics&
+{
+    return compiler.stats();
+}
+
+auto ch8::chip8_system::native_stats() const noexcept
+    -> const native_code::statistics&
+{
+    return native.stats();
+}
+
+auto ch8::chip8_system::idle_stats() const noexcept -> const idle_statistics&
+{
+    return idle;
+}
+
+auto ch8::chip8_system::cycle_count() const noexcept -> std::uint64_t
+{
+    return cycles;
+}
+
+auto ch8::chip8_system::machine_cycle_count() const noexcept
+    -> std::uint64_t
+{
+    return machine_cycles;
+}
+
+auto ch8::chip8_system::random() const noexcept -> const random_generator&
+{
+    return rng;
+}
+
+auto ch8::chip8_system::presentation() const noexcept -> presentation_mode
+{
+    return presenter.mode;
+}
+
+auto ch8::chip8_system::presentation(const presentation_mode mode) noexcept
+    -> void
+{
+    presenter.mode = mode;
+}
+
+auto ch8::chip8_system::detach_observer(
+    const observable_event event, const observer_handle handle) -> bool
+{
+    switch (event) {
+    case observable_event::draw:
+        return presenter.on_draw.detach(handle);
+    case observable_event::frame:
+        return presenter.on_frame.detach(handle);
+    default:
+        return false;
+    }
+}
+
+auto ch8::chip8_system::detach_observer(
+    const machine_event event, const observer_handle handle) -> bool
+{
+    return events.detach(event, handle);
+}
+
+auto ch8::chip8_system::watch_memory(const memory_range range) noexcept
+    -> void
+{
+    events.watch(range);
 }
 
 [[nodiscard]] auto
@@ -303,31 +1155,33 @@ ch8::chip8_system::load_program(const std::filesystem::path& program_file)
     return ch8::load_status::ok;
 }
 
-[[nodiscard]] constexpr auto
-create_opcode(const std::uint8_t byte1, const std::uint8_t byte2) noexcept
-    -> std::uint16_t
+// The module has to outlive the system; it is normally a static emitted by
+// chip8-aot.
+auto ch8::chip8_system::load_native(const native_module& module) -> void
 {
-    auto opcode = std::uint16_t{0x0};
-    opcode |= byte1;
-    opcode <<= 8U;
-    opcode |= byte2;
-
-    return opcode;
+    native.load(module);
 }
 
 auto op_00E0(
-    ch8::chip8_data& data,
-    ch8::observable<const ch8::frame_buffer<64, 32>&>& on_draw) -> void
+    ch8::chip8_data& data, ch8::frame_presenter& presenter) -> void
 {
-    data.screen.clear({0, 0, 0, 255});
-    on_draw.notify(data.screen);
+    data.screen.mark_clean();
+    data.screen.clear();
+    presenter.draw(data.screen, data.screen.dirty());
 }
 
-constexpr auto op_00EE(ch8::chip8_data& data) -> void
+constexpr auto op_00EE(ch8::chip8_data& data) noexcept -> ch8::trap
 {
     const auto sp = static_cast<std::size_t>(data.stack_pointer);
-    data.program_counter = data.stack.at(sp);
+    if (sp >= data.stack.size()) {
+        return ch8::trap::stack_underflow;
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    data.program_counter = data.stack[sp];
     data.stack_pointer--;
+
+    return ch8::trap::none;
 }
 
 constexpr auto
@@ -336,20 +1190,28 @@ op_1nnn(ch8::chip8_data& data, const std::uint16_t opcode) noexcept -> void
     data.program_counter = opcode & 0x0FFFU;
 }
 
-constexpr auto op_2nnn(ch8::chip8_data& data, const std::uint16_t opcode)
-    -> void
+constexpr auto
+op_2nnn(ch8::chip8_data& data, const std::uint16_t opcode) noexcept
+    -> ch8::trap
 {
+    const auto sp = static_cast<std::size_t>(data.stack_pointer + 1);
+    if (sp >= data.stack.size()) {
+        return ch8::trap::stack_overflow;
+    }
+
     data.stack_pointer++;
-    const auto sp = static_cast<std::size_t>(data.stack_pointer);
-    data.stack.at(sp) = data.program_counter;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    data.stack[sp] = data.program_counter;
     data.program_counter = opcode & 0x0FFFU;
+
+    return ch8::trap::none;
 }
 
 constexpr auto op_3xkk(ch8::chip8_data& data, const std::uint16_t opcode)
     -> void
 {
     const auto reg = (opcode & 0x0F00U) >> 8U;
-    const auto reg_value = data.registers.at(reg);
+    const auto reg_value = register_at(data, reg);
 
     const auto value = static_cast<std::uint8_t>(opcode & 0x00FFU);
 
@@ -362,7 +1224,7 @@ constexpr auto op_4xkk(ch8::chip8_data& data, const std::uint16_t opcode)
     -> void
 {
     const auto reg = (opcode & 0x0F00U) >> 8U;
-    const auto reg_value = data.registers.at(reg);
+    const auto reg_value = register_at(data, reg);
     const auto value = static_cast<std::uint8_t>(opcode & 0x00FFU);
 
     if (reg_value != value) {
@@ -376,7 +1238,7 @@ constexpr auto op_5xy0(ch8::chip8_data& data, const std::uint16_t opcode)
     const auto reg_x = (opcode & 0x0F00U) >> 8U;
     const auto reg_y = (opcode & 0x00F0U) >> 4U;
 
-    if (data.registers.at(reg_x) == data.registers.at(reg_y)) {
+    if (register_at(data, reg_x) == register_at(data, reg_y)) {
         data.program_counter += 2U;
     }
 }
@@ -386,7 +1248,7 @@ constexpr auto op_6xkk(ch8::chip8_data& data, const std::uint16_t opcode)
 {
     const auto reg = (opcode & 0x0F00U) >> 8U;
     const auto value = static_cast<std::uint8_t>(opcode & 0x00FFU);
-    data.registers.at(reg) = value;
+    register_at(data, reg) = value;
 }
 
 constexpr auto op_7xkk(ch8::chip8_data& data, const std::uint16_t opcode)
@@ -394,7 +1256,7 @@ constexpr auto op_7xkk(ch8::chip8_data& data, const std::uint16_t opcode)
 {
     const auto value = static_cast<std::uint8_t>(opcode & 0x00FFU);
     const auto reg = (opcode & 0x0F00U) >> 8U;
-    data.registers.at(reg) += value;
+    register_at(data, reg) += value;
 }
 
 constexpr auto op_8xy0(ch8::chip8_data& data, const std::uint16_t opcode)
@@ -402,7 +1264,7 @@ constexpr auto op_8xy0(ch8::chip8_data& data, const std::uint16_t opcode)
 {
     const auto reg_x = (opcode & 0x0F00U) >> 8U;
     const auto reg_y = (opcode & 0x00F0U) >> 4U;
-    data.registers.at(reg_x) = data.registers.at(reg_y);
+    register_at(data, reg_x) = register_at(data, reg_y);
 }
 
 constexpr auto op_8xy1(ch8::chip8_data& data, const std::uint16_t opcode)
@@ -410,7 +1272,7 @@ constexpr auto op_8xy1(ch8::chip8_data& data, const std::uint16_t opcode)
 {
     const auto reg_x = (opcode & 0x0F00U) >> 8U;
     const auto reg_y = (opcode & 0x00F0U) >> 4U;
-    data.registers.at(reg_x) |= data.registers.at(reg_y);
+    register_at(data, reg_x) |= register_at(data, reg_y);
 }
 
 constexpr auto op_8xy2(ch8::chip8_data& data, const std::uint16_t opcode)
@@ -418,7 +1280,7 @@ constexpr auto op_8xy2(ch8::chip8_data& data, const std::uint16_t opcode)
 {
     const auto reg_x = (opcode & 0x0F00U) >> 8U;
     const auto reg_y = (opcode & 0x00F0U) >> 4U;
-    data.registers.at(reg_x) &= data.registers.at(reg_y);
+    register_at(data, reg_x) &= register_at(data, reg_y);
 }
 
 constexpr auto op_8xy3(ch8::chip8_data& data, const std::uint16_t opcode)
@@ -426,7 +1288,7 @@ constexpr auto op_8xy3(ch8::chip8_data& data, const std::uint16_t opcode)
 {
     const auto reg_x = (opcode & 0x0F00U) >> 8U;
     const auto reg_y = (opcode & 0x00F0U) >> 4U;
-    data.registers.at(reg_x) ^= data.registers.at(reg_y);
+    register_at(data, reg_x) ^= register_at(data, reg_y);
 }
 
 constexpr auto op_8xy4(ch8::chip8_data& data, const std::uint16_t opcode)
@@ -435,18 +1297,18 @@ constexpr auto op_8xy4(ch8::chip8_data& data, const std::uint16_t opcode)
     const auto reg_x = (opcode & 0x0F00U) >> 8U;
     const auto reg_y = (opcode & 0x00F0U) >> 4U;
 
-    const auto x_value = data.registers.at(reg_x);
-    const auto y_value = data.registers.at(reg_y);
+    const auto x_value = register_at(data, reg_x);
+    const auto y_value = register_at(data, reg_y);
 
     const auto new_value = static_cast<unsigned>(x_value + y_value);
 
-    data.registers.at(reg_x) = static_cast<std::uint8_t>(new_value);
+    register_at(data, reg_x) = static_cast<std::uint8_t>(new_value);
 
     if (new_value > 255) {
-        data.registers.at(0xF) = 1;
+        register_at(data, 0xF) = 1;
     }
     else {
-        data.registers.at(0xF) = 0;
+        register_at(data, 0xF) = 0;
     }
 }
 
@@ -456,33 +1318,33 @@ constexpr auto op_8xy5(ch8::chip8_data& data, const std::uint16_t opcode)
     const auto reg_x = (opcode & 0x0F00U) >> 8U;
     const auto reg_y = (opcode & 0x00F0U) >> 4U;
 
-    const auto x_value = data.registers.at(reg_x);
-    const auto y_value = data.registers.at(reg_y);
+    const auto x_value = register_at(data, reg_x);
+    const auto y_value = register_at(data, reg_y);
 
-    data.registers.at(reg_x) = x_value - y_value;
+    register_at(data, reg_x) = x_value - y_value;
 
     if (x_value > y_value) {
-        data.registers.at(0xF) = 1;
+        register_at(data, 0xF) = 1;
     }
     else {
-        data.registers.at(0xF) = 0;
+        register_at(data, 0xF) = 0;
     }
 }
 
-constexpr auto
-op_8xy6(ch8::chip8_data& data, const std::uint16_t opcode, bool accurate)
+template <typename Quirks>
+constexpr auto op_8xy6(ch8::chip8_data& data, const std::uint16_t opcode)
     -> void
 {
     const auto reg_x = (opcode & 0x0F00U) >> 8U;
     const auto reg_y = (opcode & 0x00F0U) >> 4U;
 
-    const auto val =
-        accurate ? data.registers.at(reg_y) : data.registers.at(reg_x);
+    const auto val = Quirks::accurate_8xy6 ? register_at(data, reg_y)
+                                           : register_at(data, reg_x);
 
     const auto lsb = static_cast<std::uint8_t>(val & 0b00000001U);
 
-    data.registers.at(reg_x) = val >> 1U;
-    data.registers.at(0xF) = lsb;
+    register_at(data, reg_x) = val >> 1U;
+    register_at(data, 0xF) = lsb;
 }
 
 constexpr auto op_8xy7(ch8::chip8_data& data, const std::uint16_t opcode)
@@ -491,33 +1353,33 @@ constexpr auto op_8xy7(ch8::chip8_data& data, const std::uint16_t opcode)
     const auto reg_x = (opcode & 0x0F00U) >> 8U;
     const auto reg_y = (opcode & 0x00F0U) >> 4U;
 
-    const auto x_value = data.registers.at(reg_x);
-    const auto y_value = data.registers.at(reg_y);
+    const auto x_value = register_at(data, reg_x);
+    const auto y_value = register_at(data, reg_y);
 
-    data.registers.at(reg_x) = y_value - x_value;
+    register_at(data, reg_x) = y_value - x_value;
 
     if (y_value > x_value) {
-        data.registers.at(0xF) = 1;
+        register_at(data, 0xF) = 1;
     }
     else {
-        data.registers.at(0xF) = 0;
+        register_at(data, 0xF) = 0;
     }
 }
 
-constexpr auto
-op_8xyE(ch8::chip8_data& data, const std::uint16_t opcode, bool accurate)
+template <typename Quirks>
+constexpr auto op_8xyE(ch8::chip8_data& data, const std::uint16_t opcode)
     -> void
 {
     const auto reg_x = (opcode & 0x0F00U) >> 8U;
     const auto reg_y = (opcode & 0x00F0U) >> 4U;
 
-    const auto val =
-        accurate ? data.registers.at(reg_y) : data.registers.at(reg_x);
+    const auto val = Quirks::accurate_8xyE ? register_at(data, reg_y)
+                                           : register_at(data, reg_x);
 
     const auto msb = static_cast<std::uint8_t>(val >> 7U);
 
-    data.registers.at(reg_x) = static_cast<std::uint8_t>(val << 1U);
-    data.registers.at(0xF) = msb;
+    register_at(data, reg_x) = static_cast<std::uint8_t>(val << 1U);
+    register_at(data, 0xF) = msb;
 }
 
 constexpr auto op_9xy0(ch8::chip8_data& data, const std::uint16_t opcode)
@@ -526,7 +1388,7 @@ constexpr auto op_9xy0(ch8::chip8_data& data, const std::uint16_t opcode)
     const auto reg_x = (opcode & 0x0F00U) >> 8U;
     const auto reg_y = (opcode & 0x00F0U) >> 4U;
 
-    if (data.registers.at(reg_x) != data.registers.at(reg_y)) {
+    if (register_at(data, reg_x) != register_at(data, reg_y)) {
         data.program_counter += 2;
     }
 }
@@ -540,77 +1402,50 @@ op_Annn(ch8::chip8_data& data, const std::uint16_t opcode) noexcept -> void
 constexpr auto op_Bnnn(ch8::chip8_data& data, const std::uint16_t opcode)
     -> void
 {
-    data.program_counter = (opcode & 0x0FFFU) + data.registers.at(0x0);
+    data.program_counter = (opcode & 0x0FFFU) + register_at(data, 0x0);
 }
 
 auto op_Cxkk(
-    ch8::chip8_data& data, std::mt19937& rng, const std::uint16_t opcode)
-    -> void
+    ch8::chip8_data& data, ch8::random_generator& rng,
+    const std::uint16_t opcode) noexcept -> void
 {
     const auto reg = (opcode & 0x0F00U) >> 8U;
-
-    auto dist = std::uniform_int_distribution{0U, 255U};
-    const auto random_number = static_cast<std::uint8_t>(dist(rng));
+    const auto random_number = rng.next_byte();
 
     const auto value = static_cast<std::uint8_t>(opcode & 0x00FFU);
 
-    data.registers.at(reg) = value & random_number;
+    register_at(data, reg) = value & random_number;
 }
 
 auto op_Dxyn(
-    ch8::chip8_data& data,
-    ch8::observable<const ch8::frame_buffer<64, 32>&>& on_draw,
+    ch8::chip8_data& data, ch8::frame_presenter& presenter,
     const std::uint16_t opcode) -> void
 {
     const auto x_reg = (opcode & 0x0F00U) >> 8U;
     const auto y_reg = (opcode & 0x00F0U) >> 4U;
-    const auto x_pos = data.registers.at(x_reg);
-    const auto y_pos = data.registers.at(y_reg);
+    const auto x_pos = register_at(data, x_reg);
+    const auto y_pos = register_at(data, y_reg);
     const auto sprite_size = opcode & 0x000FU;
 
-    bool erased_a_pixel = false;
-
-    for (auto sprite_y = std::size_t{0}; sprite_y < sprite_size; ++sprite_y) {
-        const auto sprite_byte = data.ram.at(data.i_register + sprite_y);
-
-        for (auto sprite_x = std::size_t{0}; sprite_x < 8; ++sprite_x) {
-            const auto mask =
-                static_cast<std::uint8_t>(0b10000000U >> sprite_x);
-
-            const auto sprite_pixel = (sprite_byte & mask) > 0;
-
-            const auto screen_height = data.screen.height();
-            const auto screen_width = data.screen.width();
-
-            const auto screen_y_pos = (sprite_y + y_pos) % screen_height;
-            const auto screen_x_pos = (sprite_x + x_pos) % screen_width;
-
-            const auto old_pixel =
-                data.screen.pixel(screen_x_pos, screen_y_pos) !=
-                ch8::color{0, 0, 0, 255};
-
-            const auto new_pixel = static_cast<bool>(old_pixel ^ sprite_pixel);
-
-            if (!new_pixel && old_pixel) {
-                erased_a_pixel = true;
-            }
-
-            const auto color = new_pixel ? ch8::color{255, 255, 255, 255}
-                                         : ch8::color{0, 0, 0, 255};
-
-            data.screen.pixel(screen_x_pos, screen_y_pos, color);
-        }
+    auto sprite = std::array<std::uint8_t, 15>{};
+    for (auto row = std::size_t{0}; row < sprite_size; ++row) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        sprite[row] = memory_at(data, data.i_register + row);
     }
 
-    data.registers.at(0xF) = static_cast<std::uint8_t>(erased_a_pixel);
-    on_draw.notify(data.screen);
+    data.screen.mark_clean();
+    const auto erased_a_pixel = data.screen.draw_sprite(
+        x_pos, y_pos, {sprite.data(), sprite_size});
+
+    register_at(data, 0xF) = static_cast<std::uint8_t>(erased_a_pixel);
+    presenter.draw(data.screen, data.screen.dirty());
 }
 
 auto op_Ex9E(ch8::chip8_data& data, const std::uint16_t opcode) -> void
 {
     const auto reg = (opcode & 0x0F00U) >> 8U;
-    const auto key = data.registers.at(reg);
-    if (data.keypad.test(key)) {
+    const auto key = register_at(data, reg);
+    if (data.keypad[key & 0xFU]) {
         data.program_counter += 2U;
     }
 }
@@ -618,8 +1453,8 @@ auto op_Ex9E(ch8::chip8_data& data, const std::uint16_t opcode) -> void
 auto op_ExA1(ch8::chip8_data& data, const std::uint16_t opcode) -> void
 {
     const auto reg = (opcode & 0x0F00U) >> 8U;
-    const auto key = data.registers.at(reg);
-    if (!data.keypad.test(key)) {
+    const auto key = register_at(data, reg);
+    if (!data.keypad[key & 0xFU]) {
         data.program_counter += 2U;
     }
 }
@@ -628,17 +1463,17 @@ constexpr auto op_Fx07(ch8::chip8_data& data, const std::uint16_t opcode)
     -> void
 {
     const auto reg = (opcode & 0x0F00U) >> 8U;
-    data.registers.at(reg) = data.delay_timer;
+    register_at(data, reg) = data.delay_timer;
 }
 
 auto op_Fx0A(ch8::chip8_data& data, const std::uint16_t opcode) -> void
 {
     const auto reg = (opcode & 0x0F00U) >> 8U;
-    const auto reg_val = data.registers.at(reg);
+    const auto reg_val = register_at(data, reg);
 
     if (!data.waiting_for_keypress) {
         data.keypad.reset();
-        data.registers.at(reg) = 0xFF;
+        register_at(data, reg) = 0xFF;
 
         data.waiting_for_keypress = true;
         data.program_counter -= 2U;
@@ -646,11 +1481,11 @@ auto op_Fx0A(ch8::chip8_data& data, const std::uint16_t opcode) -> void
     else if (reg_val == 0xFF) {
         for (auto i = std::size_t{0}; i < data.keypad.size(); ++i) {
             if (data.keypad.test(i)) {
-                data.registers.at(reg) = static_cast<std::uint8_t>(i);
+                register_at(data, reg) = static_cast<std::uint8_t>(i);
             }
         }
     }
-    else if (reg_val != 0xFF && !data.keypad.test(reg_val)) {
+    else if (reg_val != 0xFF && !data.keypad[reg_val & 0xFU]) {
         data.waiting_for_keypress = false;
         data.program_counter += 2U;
     }
@@ -660,48 +1495,52 @@ constexpr auto op_Fx15(ch8::chip8_data& data, const std::uint16_t opcode)
     -> void
 {
     const auto reg = (0x0F00U & opcode) >> 8U;
-    data.delay_timer = data.registers.at(reg);
+    data.delay_timer = register_at(data, reg);
 }
 
 constexpr auto op_Fx18(ch8::chip8_data& data, const std::uint16_t opcode)
     -> void
 {
     const auto reg = (0x0F00U & opcode) >> 8U;
-    data.sound_timer = data.registers.at(reg);
+    data.sound_timer = register_at(data, reg);
 }
 
 constexpr auto op_Fx1E(ch8::chip8_data& data, const std::uint16_t opcode)
     -> void
 {
     const auto reg = (0x0F00U & opcode) >> 8U;
-    data.i_register += data.registers.at(reg);
+    data.i_register += register_at(data, reg);
 }
 
 constexpr auto op_Fx29(ch8::chip8_data& data, const std::uint16_t opcode)
     -> void
 {
     const auto reg = (0x0F00U & opcode) >> 8U;
-    data.i_register = data.registers.at(reg) * 5U;
+    data.i_register = register_at(data, reg) * 5U;
 }
 
-constexpr auto op_Fx33(ch8::chip8_data& data, const std::uint16_t opcode)
-    -> void
+auto op_Fx33(
+    ch8::chip8_data& data, ch8::machine_events& events,
+    const std::uint16_t opcode) -> void
 {
     const auto reg = (0x0F00U & opcode) >> 8U;
-    const auto reg_val = data.registers.at(reg);
+    const auto reg_val = register_at(data, reg);
 
-    data.ram.at(data.i_register) = (reg_val / 100) % 10;
-    data.ram.at(data.i_register + 1U) = (reg_val / 10) % 10;
-    data.ram.at(data.i_register + 2U) = reg_val % 10;
+    memory_at(data, data.i_register) = (reg_val / 100) % 10;
+    memory_at(data, data.i_register + 1U) = (reg_val / 10) % 10;
+    memory_at(data, data.i_register + 2U) = reg_val % 10;
+    events.wrote(data.i_register, data.i_register + 2U);
 }
 
-constexpr auto op_Fx55(ch8::chip8_data& data, const std::uint16_t opcode)
-    -> void
+auto op_Fx55(
+    ch8::chip8_data& data, ch8::machine_events& events,
+    const std::uint16_t opcode) -> void
 {
     const auto reg = (0x0F00U & opcode) >> 8U;
     for (auto i = std::size_t{0}; i <= reg; ++i) {
-        data.ram.at(data.i_register + i) = data.registers.at(i);
+        memory_at(data, data.i_register + i) = register_at(data, i);
     }
+    events.wrote(data.i_register, data.i_register + reg);
 }
 
 constexpr auto op_Fx65(ch8::chip8_data& data, const std::uint16_t opcode)
@@ -709,10 +1548,6 @@ constexpr auto op_Fx65(ch8::chip8_data& data, const std::uint16_t opcode)
 {
     const auto reg = (0x0F00U & opcode) >> 8U;
     for (auto i = std::size_t{0}; i <= reg; ++i) {
-        data.registers.at(i) = data.ram.at(data.i_register + i);
+        register_at(data, i) = memory_at(data, data.i_register + i);
     }
 }
-
-constexpr auto unknown_opcode() noexcept -> void
-{
-}
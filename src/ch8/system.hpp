@@ -1,14 +1,26 @@
 #ifndef CHIP8_SYSTEM_HPP
 #define CHIP8_SYSTEM_HPP
 
+#include "ch8/block_cache.hpp"
 #include "ch8/frame_buffer.hpp"
+#include "ch8/instruction.hpp"
+#include "ch8/jit_compiler.hpp"
+#include "ch8/machine_events.hpp"
+#include "ch8/native_code.hpp"
 #include "ch8/observable.hpp"
+#include "ch8/presenter.hpp"
+#include "ch8/profiler.hpp"
+#include "ch8/quirks.hpp"
+#include "ch8/random.hpp"
+#include "ch8/timing.hpp"
+#include "ch8/trace.hpp"
 #include <array>
 #include <bitset>
 #include <chrono>
 #include <cstdint>
 #include <filesystem>
-#include <random>
+#include <type_traits>
+#include <utility>
 
 namespace ch8 {
     struct chip8_data;
@@ -27,28 +39,95 @@ namespace ch8 {
         std::array<std::uint8_t, 16> registers;
         std::array<std::uint16_t, 16> stack;
         std::bitset<16> keypad;
-        ch8::frame_buffer<64, 32> screen;
+        ch8::packed_frame_buffer<64, 32> screen;
         bool waiting_for_keypress;
     };
 
     enum class load_status { ok, file_too_big, file_does_not_exist };
+    enum class execution_engine {
+        interpreter,
+        cached,
+        threaded,
+        jit,
+        native
+    };
 
     class chip8_system {
     public:
         using delta_time = std::chrono::microseconds;
-        enum class observable_event { draw };
+        // Draw observers get the screen and the region the instruction
+        // changed, which is empty when it changed nothing. Frame observers
+        // get the screen and a frame_info. Observers taking the region or
+        // frame_info are attached with observe_event<Event>, so a mismatch
+        // doesn't compile; observers taking only the screen work with both.
+        enum class observable_event { draw, frame };
+
+        struct idle_statistics {
+            std::uint64_t fast_forwards;
+            std::uint64_t skipped_instructions;
+        };
 
         chip8_system();
 
         auto load_program(const std::filesystem::path& program_file)
             -> load_status;
+        auto load_native(const native_module& module) -> void;
 
         template <typename Callback>
-        auto observe_event(observable_event event, Callback&& observer) -> void;
+        auto observe_event(observable_event event, Callback&& observer)
+            -> observer_handle;
+        template <observable_event Event, typename Callback>
+        auto observe_event(Callback&& observer) -> observer_handle;
+        // Machine events are raised by run() and execute(), but not step().
+        template <machine_event Event, typename Callback>
+        auto observe(Callback&& observer) -> observer_handle;
+        // Returns false if the observer was already detached.
+        auto detach_observer(observable_event event, observer_handle handle)
+            -> bool;
+        auto detach_observer(machine_event event, observer_handle handle)
+            -> bool;
+        // Limits memory_write events to writes overlapping range.
+        auto watch_memory(memory_range range) noexcept -> void;
+        // Records every instruction run into ring until called with nullptr.
+        // Nothing is recorded unless trace_ring::supported(), and while
+        // tracing, every engine interprets and idle loops are run in full.
+        auto trace(trace_ring* ring) noexcept -> void;
+        // Counts every instruction run in counts until called with nullptr.
+        // While profiling, every engine interprets and idle loops are run in
+        // full.
+        auto profile(profiler* counts) noexcept -> void;
 
-        auto step() -> void;
-        auto execute(delta_time dt) -> void;
+        auto step() noexcept -> trap;
+        template <typename Quirks>
+        auto step() noexcept -> trap;
+        auto run(std::size_t instruction_count) -> trap;
+        auto execute(delta_time dt) -> trap;
+        auto update_timers() noexcept -> void;
+        // Presents the draws since the last frame. execute() does this on
+        // its own; run() and step() leave it to the caller.
+        auto present() -> void;
         auto reset() noexcept -> void;
+        // Makes Cxkk repeat the same numbers on every run with this seed.
+        auto seed(
+            std::uint64_t value, random_engine kind = random_engine::xoshiro)
+            -> void;
+
+        [[nodiscard]] auto cache_stats() const noexcept
+            -> const block_cache::statistics&;
+        [[nodiscard]] auto jit_stats() const noexcept
+            -> const jit_compiler::statistics&;
+        [[nodiscard]] auto native_stats() const noexcept
+            -> const native_code::statistics&;
+        [[nodiscard]] auto idle_stats() const noexcept
+            -> const idle_statistics&;
+        [[nodiscard]] auto random() const noexcept -> const random_generator&;
+        [[nodiscard]] auto presentation() const noexcept -> presentation_mode;
+        auto presentation(presentation_mode mode) noexcept -> void;
+        // Instructions run by execute(). With fixed timing, these are what
+        // the timers count; with cosmac_vip timing, machine cycles are.
+        [[nodiscard]] auto cycle_count() const noexcept -> std::uint64_t;
+        [[nodiscard]] auto machine_cycle_count() const noexcept
+            -> std::uint64_t;
 
         // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
         chip8_data data;
@@ -56,29 +135,105 @@ namespace ch8 {
         // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
         int updates_per_second;
         // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+        std::size_t max_updates_per_execute;
+        // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
         bool accurate_8xyE;
         // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
         bool accurate_8xy6;
+        // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+        bool skip_idle_loops;
+        // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+        execution_engine engine;
+        // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+        timing_model timing;
 
     private:
-        observable<const frame_buffer<64, 32>&> on_draw;
-        std::chrono::microseconds time_since_update;
-        std::chrono::microseconds time_since_timer_update;
-        std::mt19937 rng;
+        friend class block_cache;
+
+        template <typename Quirks>
+        static constexpr auto make_instructions() -> instruction_table;
+
+        template <typename Quirks>
+        static const instruction_table instructions;
+
+        [[nodiscard]] auto active_instructions() const noexcept
+            -> const instruction_table&;
+        [[nodiscard]] static auto fused_instruction(fusion kind) noexcept
+            -> instruction;
+
+        auto run_skipping_idle(std::size_t instruction_count) -> trap;
+        auto run_engine(std::size_t instruction_count) -> trap;
+        auto execute_fixed(delta_time dt) -> trap;
+        auto execute_vip(delta_time dt) -> trap;
+        template <typename Quirks>
+        auto step_vip() noexcept -> trap;
+        template <typename Quirks>
+        auto run_threaded(std::size_t instruction_count) -> trap;
+
+        [[nodiscard]] auto instrumented() const noexcept -> bool;
+        auto settle(trap result) -> trap;
+        auto vblank() -> void;
+
+        frame_presenter presenter;
+        machine_events events;
+        // Progress towards the next instruction in millionths of a period,
+        // and towards the next timer tick in sixtieths of an instruction, so
+        // nothing is lost to rounding.
+        std::int64_t update_progress;
+        std::int64_t timer_phase;
+        std::uint64_t cycles;
+        // Machine cycles owed to the program, which goes negative when an
+        // instruction overruns, and how far into the current frame it is.
+        std::int64_t cycle_credit;
+        std::uint64_t frame_phase;
+        std::uint64_t machine_cycles;
+        random_generator rng;
+        block_cache cache;
+        jit_compiler compiler;
+        native_code native;
+        idle_statistics idle;
+        trace_ring* tracer;
+        profiler* profiling;
     };
 } // namespace ch8
 
 template <typename Callback>
 auto ch8::chip8_system::observe_event(
-    observable_event event, Callback&& observer) -> void
+    observable_event event, Callback&& observer) -> observer_handle
 {
+    static_assert(
+        std::is_invocable_v<Callback&, const frame_presenter::screen_type&>,
+        "observers taking more than the screen need observe_event<Event>");
+
     switch (event) {
     case observable_event::draw:
-        on_draw.attach(observer);
-        break;
+        return observe_event<observable_event::draw>(
+            std::forward<Callback>(observer));
+    case observable_event::frame:
+        return observe_event<observable_event::frame>(
+            std::forward<Callback>(observer));
     default:
-        break;
+        return observer_handle{0};
     }
 }
 
+template <ch8::chip8_system::observable_event Event, typename Callback>
+auto ch8::chip8_system::observe_event(Callback&& observer) -> observer_handle
+{
+    if constexpr (Event == observable_event::draw) {
+        return detail::attach_screen_observer(
+            presenter.on_draw, std::forward<Callback>(observer));
+    }
+    else {
+        return detail::attach_screen_observer(
+            presenter.on_frame, std::forward<Callback>(observer));
+    }
+}
+
+template <ch8::machine_event Event, typename Callback>
+auto ch8::chip8_system::observe(Callback&& observer) -> observer_handle
+{
+    return events.attach<Event>(std::forward<Callback>(observer));
+}
+
 #endif // CHIP8_SYSTEM_HPP
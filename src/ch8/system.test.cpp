@@ -1,8 +1,11 @@
 #include "ch8/system.hpp"
+#include "ch8/system_state.test.hpp"
 #include <algorithm>
+#include <array>
 #include <catch2/catch.hpp>
 #include <fstream>
 #include <random>
+#include <utility>
 #include <vector>
 
 auto operator"" _u8(unsigned long long num) -> std::uint8_t
@@ -20,6 +23,17 @@ auto operator"" _u16(unsigned long long num) -> std::uint16_t
     return static_cast<std::uint16_t>(num);
 }
 
+template <std::size_t Width, std::size_t Height>
+auto turn_on_each_pixel(ch8::packed_frame_buffer<Width, Height>& screen)
+    -> void
+{
+    for (auto x = std::size_t{0}; x < Width; ++x) {
+        for (auto y = std::size_t{0}; y < Height; ++y) {
+            screen.pixel(x, y, true);
+        }
+    }
+}
+
 TEST_CASE("ch8::chip8_data::program_start is 0x200")
 {
     STATIC_REQUIRE(ch8::chip8_data::program_start == 0x200);
@@ -77,12 +91,12 @@ TEST_CASE("ch8::chip8_system constructor sets each key in the keypad to false")
     REQUIRE(system.data.keypad.none());
 }
 
-TEST_CASE("ch8::chip8_system constructor sets each pixel in screen to black")
+TEST_CASE("ch8::chip8_system constructor sets each pixel in screen to off")
 {
     const auto system = ch8::chip8_system{};
     for (auto x = std::size_t{0}; x < system.data.screen.width(); ++x) {
         for (auto y = std::size_t{0}; y < system.data.screen.height(); ++y) {
-            REQUIRE(system.data.screen.pixel(x, y) == ch8::color{0, 0, 0, 255});
+            REQUIRE_FALSE(system.data.screen.pixel(x, y));
         }
     }
 }
@@ -228,7 +242,7 @@ TEST_CASE("load_program does not modify ram if file doesn't exist")
     REQUIRE(system.data.ram == ch8::chip8_data{}.ram);
 }
 
-TEST_CASE("00E0 sets each pixel in the display to black")
+TEST_CASE("00E0 turns off each pixel in the display")
 {
     auto system = ch8::chip8_system{};
     system.data.ram.at(system.data.program_counter) = 0x00;
@@ -236,7 +250,7 @@ TEST_CASE("00E0 sets each pixel in the display to black")
 
     for (auto x = std::size_t{0}; x < system.data.screen.width(); ++x) {
         for (auto y = std::size_t{0}; y < system.data.screen.height(); ++y) {
-            system.data.screen.pixel(x, y, {59, 38, 29, 58});
+            system.data.screen.pixel(x, y, true);
         }
     }
 
@@ -244,7 +258,7 @@ TEST_CASE("00E0 sets each pixel in the display to black")
 
     for (auto x = std::size_t{0}; x < system.data.screen.width(); ++x) {
         for (auto y = std::size_t{0}; y < system.data.screen.height(); ++y) {
-            REQUIRE(system.data.screen.pixel(x, y) == ch8::color{0, 0, 0, 255});
+            REQUIRE_FALSE(system.data.screen.pixel(x, y));
         }
     }
 }
@@ -278,6 +292,21 @@ TEST_CASE("00E0 notifies draw event observers")
     REQUIRE(observer_called);
 }
 
+TEST_CASE(
+    "0nnn opcodes other than 00E0 and 00EE only advance the program counter")
+{
+    auto system = ch8::chip8_system{};
+    system.data.ram.at(system.data.program_counter) = 0x01;
+    system.data.ram.at(system.data.program_counter + 1U) = 0xE0;
+    system.data.screen.pixel(3, 4, true);
+
+    const auto pc = system.data.program_counter;
+    system.step();
+
+    REQUIRE(system.data.program_counter == pc + 2);
+    REQUIRE(system.data.screen.pixel(3, 4));
+}
+
 TEST_CASE("00EE decrements the stack pointer")
 {
     auto system = ch8::chip8_system{};
@@ -294,7 +323,7 @@ TEST_CASE("00EE decrements the stack pointer")
     REQUIRE(system.data.stack_pointer == expected);
 }
 
-TEST_CASE("00EE throws std::out_of_range if the stack pointer is less than 0")
+TEST_CASE("00EE traps on stack underflow if the stack pointer is less than 0")
 {
     auto system = ch8::chip8_system{};
     system.data.ram.at(system.data.program_counter) = 0x00;
@@ -302,7 +331,9 @@ TEST_CASE("00EE throws std::out_of_range if the stack pointer is less than 0")
 
     system.data.stack_pointer = -1;
 
-    REQUIRE_THROWS_AS(system.step(), std::out_of_range);
+    REQUIRE(system.step() == ch8::trap::stack_underflow);
+    REQUIRE(system.data.program_counter == 0x200);
+    REQUIRE(system.data.stack_pointer == -1);
 }
 
 TEST_CASE(
@@ -367,16 +398,18 @@ TEST_CASE("2nnn puts the program counter on top of the stack")
     REQUIRE(stack_top == pc + 2U);
 }
 
-TEST_CASE("2nnn throws std::out_of_range when stack pointer >= stack size - 1")
+TEST_CASE("2nnn traps on stack overflow when stack pointer >= stack size - 1")
 {
     auto system = ch8::chip8_system{};
     system.data.ram.at(system.data.program_counter) = 0x23;
     system.data.ram.at(system.data.program_counter + 1U) = 0xD9;
 
-    system.data.stack_pointer =
-        static_cast<std::int8_t>(system.data.stack.size()) - 1;
+    const auto sp = static_cast<std::int8_t>(system.data.stack.size() - 1U);
+    system.data.stack_pointer = sp;
 
-    REQUIRE_THROWS_AS(system.step(), std::out_of_range);
+    REQUIRE(system.step() == ch8::trap::stack_overflow);
+    REQUIRE(system.data.program_counter == 0x200);
+    REQUIRE(system.data.stack_pointer == sp);
 }
 
 TEST_CASE("2nnn sets the program counter to nnn")
@@ -1151,6 +1184,42 @@ TEST_CASE("Cxkk increments the program counter by 2")
     REQUIRE(system.data.program_counter == pc + 2);
 }
 
+TEST_CASE("Cxkk repeats its numbers for the same seed")
+{
+    const auto kind = GENERATE(
+        ch8::random_engine::xoshiro, ch8::random_engine::mersenne_twister);
+
+    auto first = ch8::chip8_system{};
+    auto second = ch8::chip8_system{};
+    for (auto* system : {&first, &second}) {
+        system->seed(1234, kind);
+        system->data.ram.at(0x200) = 0xC0;
+        system->data.ram.at(0x201) = 0xFF;
+        system->data.ram.at(0x202) = 0x12;
+        system->data.ram.at(0x203) = 0x00;
+    }
+
+    for (auto i = 0; i < 50; ++i) {
+        first.step();
+        second.step();
+        REQUIRE(first.data.registers.at(0) == second.data.registers.at(0));
+    }
+}
+
+TEST_CASE("Cxkk masks the random number with kk")
+{
+    auto system = ch8::chip8_system{};
+    system.data.ram.at(0x200) = 0xC3;
+    system.data.ram.at(0x201) = 0x0F;
+    system.data.ram.at(0x202) = 0x12;
+    system.data.ram.at(0x203) = 0x00;
+
+    for (auto i = 0; i < 50; ++i) {
+        system.step();
+        REQUIRE(system.data.registers.at(3) <= 0x0F);
+    }
+}
+
 TEST_CASE("Dxyn draws a sprite pointed to by the i register to the screen")
 {
     auto sprite = GENERATE(
@@ -1188,21 +1257,19 @@ TEST_CASE("Dxyn draws a sprite pointed to by the i register to the screen")
     for (auto y = std::size_t{0}; y < sprite.size(); ++y) {
         const auto sprite_byte = sprite.at(y);
 
-        const auto sprite_bit_to_color =
+        const auto sprite_bit_to_pixel =
             [&sprite_byte](const std::uint8_t mask) {
-                constexpr auto white = ch8::color{255, 255, 255, 255};
-                constexpr auto black = ch8::color{0, 0, 0, 255};
-                return (sprite_byte & mask) > 0 ? white : black;
+                return (sprite_byte & mask) > 0;
             };
 
-        expected_screen.pixel(0, y, sprite_bit_to_color(0b10000000));
-        expected_screen.pixel(1, y, sprite_bit_to_color(0b01000000));
-        expected_screen.pixel(2, y, sprite_bit_to_color(0b00100000));
-        expected_screen.pixel(3, y, sprite_bit_to_color(0b00010000));
-        expected_screen.pixel(4, y, sprite_bit_to_color(0b00001000));
-        expected_screen.pixel(5, y, sprite_bit_to_color(0b00000100));
-        expected_screen.pixel(6, y, sprite_bit_to_color(0b00000010));
-        expected_screen.pixel(7, y, sprite_bit_to_color(0b00000001));
+        expected_screen.pixel(0, y, sprite_bit_to_pixel(0b10000000));
+        expected_screen.pixel(1, y, sprite_bit_to_pixel(0b01000000));
+        expected_screen.pixel(2, y, sprite_bit_to_pixel(0b00100000));
+        expected_screen.pixel(3, y, sprite_bit_to_pixel(0b00010000));
+        expected_screen.pixel(4, y, sprite_bit_to_pixel(0b00001000));
+        expected_screen.pixel(5, y, sprite_bit_to_pixel(0b00000100));
+        expected_screen.pixel(6, y, sprite_bit_to_pixel(0b00000010));
+        expected_screen.pixel(7, y, sprite_bit_to_pixel(0b00000001));
     }
 
     for (auto x = std::size_t{0}; x < system.data.screen.width(); ++x) {
@@ -1241,21 +1308,19 @@ TEST_CASE("Dxyn draws sprites to the position stored in Vx, Vy on the screen")
     for (auto y = std::size_t{0}; y < sprite.size(); ++y) {
         const auto sprite_byte = sprite.at(y);
 
-        const auto sprite_bit_to_color =
+        const auto sprite_bit_to_pixel =
             [&sprite_byte](const std::uint8_t mask) {
-                constexpr auto white = ch8::color{255, 255, 255, 255};
-                constexpr auto black = ch8::color{0, 0, 0, 255};
-                return (sprite_byte & mask) > 0 ? white : black;
+                return (sprite_byte & mask) > 0;
             };
 
-        expected_screen.pixel(0 + 8, y + 2, sprite_bit_to_color(0b10000000));
-        expected_screen.pixel(1 + 8, y + 2, sprite_bit_to_color(0b01000000));
-        expected_screen.pixel(2 + 8, y + 2, sprite_bit_to_color(0b00100000));
-        expected_screen.pixel(3 + 8, y + 2, sprite_bit_to_color(0b00010000));
-        expected_screen.pixel(4 + 8, y + 2, sprite_bit_to_color(0b00001000));
-        expected_screen.pixel(5 + 8, y + 2, sprite_bit_to_color(0b00000100));
-        expected_screen.pixel(6 + 8, y + 2, sprite_bit_to_color(0b00000010));
-        expected_screen.pixel(7 + 8, y + 2, sprite_bit_to_color(0b00000001));
+        expected_screen.pixel(0 + 8, y + 2, sprite_bit_to_pixel(0b10000000));
+        expected_screen.pixel(1 + 8, y + 2, sprite_bit_to_pixel(0b01000000));
+        expected_screen.pixel(2 + 8, y + 2, sprite_bit_to_pixel(0b00100000));
+        expected_screen.pixel(3 + 8, y + 2, sprite_bit_to_pixel(0b00010000));
+        expected_screen.pixel(4 + 8, y + 2, sprite_bit_to_pixel(0b00001000));
+        expected_screen.pixel(5 + 8, y + 2, sprite_bit_to_pixel(0b00000100));
+        expected_screen.pixel(6 + 8, y + 2, sprite_bit_to_pixel(0b00000010));
+        expected_screen.pixel(7 + 8, y + 2, sprite_bit_to_pixel(0b00000001));
     }
 
     for (auto x = std::size_t{0}; x < system.data.screen.width(); ++x) {
@@ -1290,7 +1355,7 @@ TEST_CASE("Dxyn xors sprites onto the screen")
         sprite.begin(), sprite.end(),
         system.data.ram.begin() + system.data.i_register);
 
-    system.data.screen.data().fill(255_u8);
+    turn_on_each_pixel(system.data.screen);
 
     system.data.ram.at(system.data.program_counter) = 0xD9;
     system.data.ram.at(system.data.program_counter + 1U) = 0xA5U;
@@ -1300,26 +1365,24 @@ TEST_CASE("Dxyn xors sprites onto the screen")
     system.step();
 
     auto expected_screen = ch8::chip8_data{}.screen;
-    expected_screen.data().fill(255_u8);
+    turn_on_each_pixel(expected_screen);
 
     for (auto y = std::size_t{0}; y < inverted_sprite.size(); ++y) {
         const auto sprite_byte = inverted_sprite.at(y);
 
-        const auto sprite_bit_to_color =
+        const auto sprite_bit_to_pixel =
             [&sprite_byte](const std::uint8_t mask) {
-                constexpr auto white = ch8::color{255, 255, 255, 255};
-                constexpr auto black = ch8::color{0, 0, 0, 255};
-                return (sprite_byte & mask) > 0 ? white : black;
+                return (sprite_byte & mask) > 0;
             };
 
-        expected_screen.pixel(0 + 4, y + 7, sprite_bit_to_color(0b10000000));
-        expected_screen.pixel(1 + 4, y + 7, sprite_bit_to_color(0b01000000));
-        expected_screen.pixel(2 + 4, y + 7, sprite_bit_to_color(0b00100000));
-        expected_screen.pixel(3 + 4, y + 7, sprite_bit_to_color(0b00010000));
-        expected_screen.pixel(4 + 4, y + 7, sprite_bit_to_color(0b00001000));
-        expected_screen.pixel(5 + 4, y + 7, sprite_bit_to_color(0b00000100));
-        expected_screen.pixel(6 + 4, y + 7, sprite_bit_to_color(0b00000010));
-        expected_screen.pixel(7 + 4, y + 7, sprite_bit_to_color(0b00000001));
+        expected_screen.pixel(0 + 4, y + 7, sprite_bit_to_pixel(0b10000000));
+        expected_screen.pixel(1 + 4, y + 7, sprite_bit_to_pixel(0b01000000));
+        expected_screen.pixel(2 + 4, y + 7, sprite_bit_to_pixel(0b00100000));
+        expected_screen.pixel(3 + 4, y + 7, sprite_bit_to_pixel(0b00010000));
+        expected_screen.pixel(4 + 4, y + 7, sprite_bit_to_pixel(0b00001000));
+        expected_screen.pixel(5 + 4, y + 7, sprite_bit_to_pixel(0b00000100));
+        expected_screen.pixel(6 + 4, y + 7, sprite_bit_to_pixel(0b00000010));
+        expected_screen.pixel(7 + 4, y + 7, sprite_bit_to_pixel(0b00000001));
     }
 
     for (auto x = std::size_t{0}; x < system.data.screen.width(); ++x) {
@@ -1358,11 +1421,9 @@ TEST_CASE("Dxyn wraps sprites to the left side of the screen")
     for (auto y = std::size_t{0}; y < sprite.size(); ++y) {
         const auto sprite_byte = sprite.at(y);
 
-        const auto sprite_bit_to_color =
+        const auto sprite_bit_to_pixel =
             [&sprite_byte](const std::uint8_t mask) {
-                constexpr auto white = ch8::color{255, 255, 255, 255};
-                constexpr auto black = ch8::color{0, 0, 0, 255};
-                return (sprite_byte & mask) > 0 ? white : black;
+                return (sprite_byte & mask) > 0;
             };
 
         const auto x_pos = [&expected_screen](auto x) {
@@ -1370,21 +1431,21 @@ TEST_CASE("Dxyn wraps sprites to the left side of the screen")
         };
 
         expected_screen.pixel(
-            x_pos(0 + 60), y + 4, sprite_bit_to_color(0b10000000));
+            x_pos(0 + 60), y + 4, sprite_bit_to_pixel(0b10000000));
         expected_screen.pixel(
-            x_pos(1 + 60), y + 4, sprite_bit_to_color(0b01000000));
+            x_pos(1 + 60), y + 4, sprite_bit_to_pixel(0b01000000));
         expected_screen.pixel(
-            x_pos(2 + 60), y + 4, sprite_bit_to_color(0b00100000));
+            x_pos(2 + 60), y + 4, sprite_bit_to_pixel(0b00100000));
         expected_screen.pixel(
-            x_pos(3 + 60), y + 4, sprite_bit_to_color(0b00010000));
+            x_pos(3 + 60), y + 4, sprite_bit_to_pixel(0b00010000));
         expected_screen.pixel(
-            x_pos(4 + 60), y + 4, sprite_bit_to_color(0b00001000));
+            x_pos(4 + 60), y + 4, sprite_bit_to_pixel(0b00001000));
         expected_screen.pixel(
-            x_pos(5 + 60), y + 4, sprite_bit_to_color(0b00000100));
+            x_pos(5 + 60), y + 4, sprite_bit_to_pixel(0b00000100));
         expected_screen.pixel(
-            x_pos(6 + 60), y + 4, sprite_bit_to_color(0b00000010));
+            x_pos(6 + 60), y + 4, sprite_bit_to_pixel(0b00000010));
         expected_screen.pixel(
-            x_pos(7 + 60), y + 4, sprite_bit_to_color(0b00000001));
+            x_pos(7 + 60), y + 4, sprite_bit_to_pixel(0b00000001));
     }
 
     for (auto x = std::size_t{0}; x < system.data.screen.width(); ++x) {
@@ -1423,22 +1484,20 @@ TEST_CASE("Dxyn wraps sprites to the top of the screen")
     for (auto y = std::size_t{0}; y < sprite.size(); ++y) {
         const auto sprite_byte = sprite.at(y);
 
-        const auto sprite_bit_to_color =
+        const auto sprite_bit_to_pixel =
             [&sprite_byte](const std::uint8_t mask) {
-                constexpr auto white = ch8::color{255, 255, 255, 255};
-                constexpr auto black = ch8::color{0, 0, 0, 255};
-                return (sprite_byte & mask) > 0 ? white : black;
+                return (sprite_byte & mask) > 0;
             };
 
         const auto y_pos = (y + 30) % expected_screen.height();
-        expected_screen.pixel(9, y_pos, sprite_bit_to_color(0b10000000));
-        expected_screen.pixel(10, y_pos, sprite_bit_to_color(0b01000000));
-        expected_screen.pixel(11, y_pos, sprite_bit_to_color(0b00100000));
-        expected_screen.pixel(12, y_pos, sprite_bit_to_color(0b00010000));
-        expected_screen.pixel(13, y_pos, sprite_bit_to_color(0b00001000));
-        expected_screen.pixel(14, y_pos, sprite_bit_to_color(0b00000100));
-        expected_screen.pixel(15, y_pos, sprite_bit_to_color(0b00000010));
-        expected_screen.pixel(16, y_pos, sprite_bit_to_color(0b00000001));
+        expected_screen.pixel(9, y_pos, sprite_bit_to_pixel(0b10000000));
+        expected_screen.pixel(10, y_pos, sprite_bit_to_pixel(0b01000000));
+        expected_screen.pixel(11, y_pos, sprite_bit_to_pixel(0b00100000));
+        expected_screen.pixel(12, y_pos, sprite_bit_to_pixel(0b00010000));
+        expected_screen.pixel(13, y_pos, sprite_bit_to_pixel(0b00001000));
+        expected_screen.pixel(14, y_pos, sprite_bit_to_pixel(0b00000100));
+        expected_screen.pixel(15, y_pos, sprite_bit_to_pixel(0b00000010));
+        expected_screen.pixel(16, y_pos, sprite_bit_to_pixel(0b00000001));
     }
 
     for (auto x = std::size_t{0}; x < system.data.screen.width(); ++x) {
@@ -1468,7 +1527,7 @@ TEST_CASE("Dxyn sets VF to 1 when pixels are erased")
         sprite.begin(), sprite.end(),
         system.data.ram.begin() + system.data.i_register);
 
-    system.data.screen.data().fill(255_u8);
+    turn_on_each_pixel(system.data.screen);
 
     system.data.ram.at(system.data.program_counter) = 0xD9;
     system.data.ram.at(system.data.program_counter + 1U) = 0xA5U;
@@ -1537,6 +1596,51 @@ TEST_CASE("Dxyn notifies draw event observers")
     REQUIRE(observer_called);
 }
 
+TEST_CASE("Dxyn passes draw event observers the region it changed")
+{
+    auto system = ch8::chip8_system{};
+    system.data.i_register = 0x300;
+    system.data.ram.at(0x300) = 0b0110'0000;
+    system.data.ram.at(0x301) = 0b0000'0000;
+    system.data.ram.at(0x302) = 0b0000'0001;
+    system.data.registers.at(0x1) = 20;
+    system.data.registers.at(0x2) = 9;
+    system.data.screen.pixel(0, 0, true);
+
+    auto region = ch8::screen_region{};
+    system.observe_event<ch8::chip8_system::observable_event::draw>(
+        [&](const auto&, const ch8::screen_region& changed) {
+            region = changed;
+        });
+
+    system.data.ram.at(system.data.program_counter) = 0xD1;
+    system.data.ram.at(system.data.program_counter + 1U) = 0x23;
+    system.step();
+    REQUIRE(region == ch8::screen_region{20, 9, 8, 3});
+
+    system.data.i_register = 0x301;
+    system.data.ram.at(system.data.program_counter) = 0xD1;
+    system.data.ram.at(system.data.program_counter + 1U) = 0x21;
+    system.step();
+    REQUIRE(region.empty());
+}
+
+TEST_CASE("00E0 passes an empty region when the screen was already off")
+{
+    auto system = ch8::chip8_system{};
+
+    auto region = ch8::screen_region{1, 1, 1, 1};
+    system.observe_event<ch8::chip8_system::observable_event::draw>(
+        [&](const auto&, const ch8::screen_region& changed) {
+            region = changed;
+        });
+
+    system.data.ram.at(system.data.program_counter) = 0x00;
+    system.data.ram.at(system.data.program_counter + 1U) = 0xE0;
+    system.step();
+    REQUIRE(region.empty());
+}
+
 TEST_CASE(
     "Ex9E increments the program counter by 4 if key stored in Vx is pressed")
 {
@@ -2034,3 +2138,790 @@ TEST_CASE("Fx65 increments the program counter by 2")
     system.step();
     REQUIRE(system.data.program_counter == pc + 2);
 }
+
+TEST_CASE("run executes the given number of instructions with every engine")
+{
+    constexpr auto rom = std::array<std::uint8_t, 4>{
+        0x70, 0x01, // 200: ADD V0, 0x01
+        0x12, 0x00, // 202: JP 0x200
+    };
+
+    auto system = ch8::chip8_system{};
+    system.engine = GENERATE(
+        ch8::execution_engine::interpreter, ch8::execution_engine::cached,
+        ch8::execution_engine::threaded);
+    load(system, rom);
+
+    system.run(11);
+
+    REQUIRE(system.data.registers.at(0) == 6);
+    REQUIRE(system.data.program_counter == 0x202);
+}
+
+TEST_CASE("run with the threaded engine leaves the same state as step()")
+{
+    constexpr auto rom = std::array<std::uint8_t, 28>{
+        0x60, 0x00, // 200: LD V0, 0x00
+        0x70, 0x03, // 202: ADD V0, 0x03
+        0x81, 0x04, // 204: ADD V1, V0
+        0x82, 0x1E, // 206: SHL V2, V1
+        0x22, 0x14, // 208: CALL 0x214
+        0x30, 0x3C, // 20A: SE V0, 0x3C
+        0x12, 0x02, // 20C: JP 0x202
+        0x00, 0xE0, // 20E: CLS
+        0x12, 0x10, // 210: JP 0x210
+        0x00, 0x00, // 212: padding
+        0xA3, 0x00, // 214: LD I, 0x300
+        0xF2, 0x33, // 216: LD B, V2
+        0xD0, 0x13, // 218: DRW V0, V1, 3
+        0x00, 0xEE, // 21A: RET
+    };
+
+    const auto instruction_count = GENERATE(1U, 9U, 200U);
+
+    auto stepped = ch8::chip8_system{};
+    auto threaded = ch8::chip8_system{};
+    threaded.engine = ch8::execution_engine::threaded;
+    load(stepped, rom);
+    load(threaded, rom);
+
+    for (auto i = 0U; i < instruction_count; ++i) {
+        stepped.step();
+    }
+    threaded.run(instruction_count);
+
+    require_same_state(threaded.data, stepped.data);
+}
+
+TEST_CASE("step<Quirks> ignores the runtime quirk flags")
+{
+    auto system = ch8::chip8_system{};
+    system.accurate_8xy6 = false;
+    system.data.ram.at(0x200) = 0x81;
+    system.data.ram.at(0x201) = 0x26;
+    system.data.registers.at(0x1) = 0b1000;
+    system.data.registers.at(0x2) = 0b0100;
+
+    system.step<ch8::quirks<true, true>>();
+
+    REQUIRE(system.data.registers.at(0x1) == 0b0010);
+}
+
+TEST_CASE("step uses the quirks matching the runtime flags when they change")
+{
+    constexpr auto rom = std::array<std::uint8_t, 4>{
+        0x81, 0x2E, // 200: SHL V1, V2
+        0x12, 0x00, // 202: JP 0x200
+    };
+
+    const auto engine = GENERATE(
+        ch8::execution_engine::interpreter, ch8::execution_engine::cached,
+        ch8::execution_engine::threaded, ch8::execution_engine::jit);
+
+    auto system = ch8::chip8_system{};
+    system.engine = engine;
+    load(system, rom);
+    system.data.registers.at(0x2) = 0b0001;
+
+    system.accurate_8xyE = false;
+    system.run(40);
+    REQUIRE(system.data.registers.at(0x1) == 0b0000);
+
+    system.accurate_8xyE = true;
+    system.run(2);
+    REQUIRE(system.data.registers.at(0x1) == 0b0010);
+
+    system.accurate_8xyE = false;
+    system.run(2);
+    REQUIRE(system.data.registers.at(0x1) == 0b0100);
+}
+
+TEST_CASE("step traps when the program counter runs off the end of ram")
+{
+    auto system = ch8::chip8_system{};
+    system.data.program_counter = 0xFFF;
+
+    REQUIRE(system.step() == ch8::trap::pc_out_of_range);
+    REQUIRE(system.data.program_counter == 0xFFF);
+}
+
+TEST_CASE("step traps on unknown opcodes without changing state")
+{
+    const auto opcode = GENERATE(
+        0x5121_u16, 0x912F_u16, 0x812F_u16, 0xE1A0_u16, 0xF3FF_u16);
+    const auto engine = GENERATE(
+        ch8::execution_engine::interpreter, ch8::execution_engine::cached,
+        ch8::execution_engine::threaded, ch8::execution_engine::jit);
+
+    const auto rom = std::array<std::uint8_t, 4>{
+        0x70, 0x01, // 200: ADD V0, 0x01
+        static_cast<std::uint8_t>(opcode >> 8U),
+        static_cast<std::uint8_t>(opcode & 0xFFU),
+    };
+
+    auto system = ch8::chip8_system{};
+    system.engine = engine;
+    load(system, rom);
+
+    REQUIRE(system.run(10) == ch8::trap::unknown_opcode);
+    REQUIRE(system.data.program_counter == 0x202);
+    REQUIRE(system.data.registers.at(0x0) == 0x01);
+    REQUIRE(system.data.registers.at(0x1) == 0x00);
+}
+
+TEST_CASE("0nnn is ignored")
+{
+    const auto opcode = GENERATE(0x0345_u16, 0x00FF_u16, 0x0012_u16);
+    const auto engine = GENERATE(
+        ch8::execution_engine::interpreter, ch8::execution_engine::cached,
+        ch8::execution_engine::threaded, ch8::execution_engine::jit);
+
+    auto system = ch8::chip8_system{};
+    system.engine = engine;
+    system.data.ram.at(0x200) = static_cast<std::uint8_t>(opcode >> 8U);
+    system.data.ram.at(0x201) = static_cast<std::uint8_t>(opcode & 0xFFU);
+
+    REQUIRE(system.run(1) == ch8::trap::none);
+    REQUIRE(system.data.program_counter == 0x202);
+}
+
+TEST_CASE("Fx55 and Fx65 wrap addresses past the end of ram")
+{
+    auto system = ch8::chip8_system{};
+    system.data.i_register = 0xFFF;
+    system.data.registers.at(0x0) = 0xAB;
+    system.data.registers.at(0x1) = 0xCD;
+    system.data.ram.at(0x200) = 0xF1;
+    system.data.ram.at(0x201) = 0x55;
+    system.data.ram.at(0x202) = 0xF1;
+    system.data.ram.at(0x203) = 0x65;
+
+    REQUIRE(system.step() == ch8::trap::none);
+    REQUIRE(system.data.ram.at(0xFFF) == 0xAB);
+    REQUIRE(system.data.ram.at(0x000) == 0xCD);
+
+    system.data.registers = {};
+    REQUIRE(system.step() == ch8::trap::none);
+    REQUIRE(system.data.registers.at(0x0) == 0xAB);
+    REQUIRE(system.data.registers.at(0x1) == 0xCD);
+}
+
+TEST_CASE("execute runs every instruction owed for the elapsed time")
+{
+    auto system = ch8::chip8_system{};
+    system.updates_per_second = 1000;
+
+    system.execute(std::chrono::milliseconds{16});
+
+    REQUIRE(system.data.program_counter == 0x200 + 16 * 2);
+}
+
+TEST_CASE("execute carries partial instructions over to the next call")
+{
+    auto system = ch8::chip8_system{};
+    system.updates_per_second = 600;
+
+    for (auto i = 0; i < 5; ++i) {
+        system.execute(std::chrono::milliseconds{1});
+    }
+
+    REQUIRE(system.data.program_counter == 0x200 + 3 * 2);
+}
+
+TEST_CASE("execute drops instructions past max_updates_per_execute")
+{
+    auto system = ch8::chip8_system{};
+    system.updates_per_second = 1000;
+    system.max_updates_per_execute = 10;
+
+    system.execute(std::chrono::seconds{1});
+    REQUIRE(system.data.program_counter == 0x200 + 10 * 2);
+
+    system.execute(std::chrono::milliseconds{1});
+    REQUIRE(system.data.program_counter == 0x200 + 11 * 2);
+}
+
+TEST_CASE("execute ticks the timers between the right instructions")
+{
+    constexpr auto rom = std::array<std::uint8_t, 12>{
+        0xF0, 0x07, // 200: LD V0, DT
+        0xF1, 0x07, // 202: LD V1, DT
+        0xF2, 0x07, // 204: LD V2, DT
+        0xF3, 0x07, // 206: LD V3, DT
+        0xF4, 0x07, // 208: LD V4, DT
+        0xF5, 0x07, // 20A: LD V5, DT
+    };
+
+    auto system = ch8::chip8_system{};
+    load(system, rom);
+    system.updates_per_second = 180;
+    system.data.delay_timer = 10;
+
+    system.execute(std::chrono::microseconds{33'334});
+
+    const auto expected = std::array<std::uint8_t, 6>{10, 10, 10, 9, 9, 9};
+    REQUIRE(std::equal(
+        expected.begin(), expected.end(), system.data.registers.begin()));
+    REQUIRE(system.data.delay_timer == 8);
+}
+
+TEST_CASE("execute ticks the timers 60 times per emulated second")
+{
+    const auto updates = GENERATE(60, 500, 700, 800, 1000);
+
+    auto system = ch8::chip8_system{};
+    system.updates_per_second = updates;
+    system.data.delay_timer = 100;
+    system.data.sound_timer = 200;
+
+    for (auto i = 0; i < 1000; ++i) {
+        system.execute(std::chrono::milliseconds{1});
+    }
+
+    REQUIRE(system.cycle_count() == static_cast<std::uint64_t>(updates));
+    REQUIRE(system.data.delay_timer == 40);
+    REQUIRE(system.data.sound_timer == 140);
+}
+
+TEST_CASE("execute ticks the timers for the instructions it ran")
+{
+    auto system = ch8::chip8_system{};
+    system.updates_per_second = 600;
+    system.max_updates_per_execute = 100;
+    system.data.delay_timer = 50;
+
+    system.execute(std::chrono::seconds{1});
+
+    REQUIRE(system.cycle_count() == 100);
+    REQUIRE(system.data.delay_timer == 40);
+}
+
+TEST_CASE("execute leaves the timers alone while updates_per_second is 0")
+{
+    auto system = ch8::chip8_system{};
+    system.updates_per_second = 0;
+    system.data.delay_timer = 50;
+
+    system.execute(std::chrono::seconds{1});
+
+    REQUIRE(system.cycle_count() == 0);
+    REQUIRE(system.data.delay_timer == 50);
+}
+
+TEST_CASE("reset starts execute's emulated time over")
+{
+    constexpr auto rom = std::array<std::uint8_t, 2>{
+        0x12, 0x00, // 200: JP 0x200
+    };
+
+    auto system = ch8::chip8_system{};
+    load(system, rom);
+    system.execute(std::chrono::milliseconds{10});
+    REQUIRE(system.cycle_count() == 8);
+
+    system.reset();
+    REQUIRE(system.cycle_count() == 0);
+
+    load(system, rom);
+    system.data.delay_timer = 5;
+    system.execute(std::chrono::milliseconds{9});
+
+    REQUIRE(system.cycle_count() == 7);
+    REQUIRE(system.data.delay_timer == 5);
+}
+
+TEST_CASE("per_frame presentation merges the draws of an execute call")
+{
+    constexpr auto rom = std::array<std::uint8_t, 6>{
+        0xD0, 0x11, // 200: DRW V0, V1, 1
+        0x70, 0x08, // 202: ADD V0, 0x08
+        0x12, 0x00, // 204: JP 0x200
+    };
+
+    auto system = ch8::chip8_system{};
+    load(system, rom);
+    system.updates_per_second = 600;
+    system.presentation(ch8::presentation_mode::per_frame);
+
+    auto draws = std::size_t{0};
+    auto frames = std::vector<ch8::frame_info>{};
+    system.observe_event(
+        ch8::chip8_system::observable_event::draw,
+        [&](const auto&) { ++draws; });
+    system.observe_event<ch8::chip8_system::observable_event::frame>(
+        [&](const auto&, const ch8::frame_info& info) {
+            frames.push_back(info);
+        });
+
+    system.execute(std::chrono::milliseconds{10});
+
+    REQUIRE(draws == 0);
+    REQUIRE(frames.size() == 1);
+    REQUIRE(frames.front().draws == 2);
+    REQUIRE(frames.front().changed == ch8::screen_region{0, 0, 16, 1});
+}
+
+TEST_CASE("execute presents a frame at every vblank that follows a draw")
+{
+    constexpr auto rom = std::array<std::uint8_t, 8>{
+        0xD0, 0x11, // 200: DRW V0, V1, 1
+        0x60, 0x08, // 202: LD V0, 0x08
+        0xD0, 0x11, // 204: DRW V0, V1, 1
+        0x12, 0x06, // 206: JP 0x206
+    };
+
+    auto system = ch8::chip8_system{};
+    load(system, rom);
+    system.updates_per_second = 60;
+
+    auto frames = std::vector<std::size_t>{};
+    system.observe_event<ch8::chip8_system::observable_event::frame>(
+        [&](const auto&, const ch8::frame_info& info) {
+            frames.push_back(info.draws);
+        });
+
+    system.execute(std::chrono::milliseconds{100});
+
+    REQUIRE(frames == std::vector<std::size_t>{1, 1});
+}
+
+TEST_CASE("run leaves presenting to the caller")
+{
+    auto system = ch8::chip8_system{};
+    system.data.ram.at(0x200) = 0x00; // 200: CLS
+    system.data.ram.at(0x201) = 0xE0;
+
+    auto frames = std::size_t{0};
+    system.observe_event(
+        ch8::chip8_system::observable_event::frame,
+        [&](const auto&) { ++frames; });
+
+    system.run(1);
+    REQUIRE(frames == 0);
+
+    system.present();
+    system.present();
+    REQUIRE(frames == 1);
+}
+
+TEST_CASE("Detached draw observers are no longer notified")
+{
+    auto system = ch8::chip8_system{};
+    system.data.ram.at(0x200) = 0x00; // 200: CLS
+    system.data.ram.at(0x201) = 0xE0;
+    system.data.ram.at(0x202) = 0x12; // 202: JP 0x200
+    system.data.ram.at(0x203) = 0x00;
+
+    auto draws = std::size_t{0};
+    const auto handle = system.observe_event(
+        ch8::chip8_system::observable_event::draw,
+        [&](const auto&) { ++draws; });
+
+    system.run(2);
+    REQUIRE(system.detach_observer(
+        ch8::chip8_system::observable_event::draw, handle));
+    REQUIRE_FALSE(system.detach_observer(
+        ch8::chip8_system::observable_event::frame, handle));
+    system.run(2);
+    REQUIRE(draws == 1);
+}
+
+TEST_CASE("cosmac_vip timing ticks the timers once per 3668 machine cycles")
+{
+    auto system = ch8::chip8_system{};
+    system.timing = ch8::timing_model::cosmac_vip;
+    system.max_updates_per_execute = 100'000;
+    system.data.delay_timer = 100;
+    system.data.ram.at(0x200) = 0x60; // 200: LD V0, 0x01
+    system.data.ram.at(0x201) = 0x01;
+    system.data.ram.at(0x202) = 0x12; // 202: JP 0x200
+    system.data.ram.at(0x203) = 0x00;
+
+    system.execute(std::chrono::seconds{1});
+
+    REQUIRE(system.data.delay_timer == 40);
+    // The last frame's interrupt runs past the second and is paid back by
+    // the next call.
+    const auto cycles = system.machine_cycle_count();
+    REQUIRE(cycles >= ch8::vip::cycles_per_second);
+    REQUIRE(
+        cycles < ch8::vip::cycles_per_second + ch8::vip::stolen_cycles + 63);
+
+    // Each frame leaves 3668 - 1070 cycles for pairs costing 46 + 63.
+    const auto pairs = (ch8::vip::cycles_per_second -
+                        60 * ch8::vip::stolen_cycles) /
+                       109;
+    REQUIRE(system.cycle_count() / 2 >= pairs - 60);
+    REQUIRE(system.cycle_count() / 2 <= pairs + 60);
+}
+
+TEST_CASE("cosmac_vip timing charges unaligned sprites more")
+{
+    const auto run_draw = [](std::uint8_t x) {
+        auto system = ch8::chip8_system{};
+        system.timing = ch8::timing_model::cosmac_vip;
+        system.data.registers.at(0) = x;
+        system.data.ram.at(0x200) = 0xD0; // 200: DRW V0, V1, 5
+        system.data.ram.at(0x201) = 0x15;
+        system.data.ram.at(0x202) = 0x12; // 202: JP 0x200
+        system.data.ram.at(0x203) = 0x00;
+
+        system.execute(std::chrono::milliseconds{10});
+        return system.cycle_count();
+    };
+
+    REQUIRE(run_draw(8) > run_draw(3));
+    REQUIRE(run_draw(8) == run_draw(16));
+}
+
+TEST_CASE("cosmac_vip timing charges by the number of registers copied")
+{
+    const auto vip = ch8::vip::timing;
+    const auto fx65 = [&vip](std::uint16_t opcode) {
+        const auto& cost = vip.at(ch8::timing_index(opcode));
+        const auto x = std::size_t{(opcode & 0x0F00U) >> 8U};
+        return cost.base + cost.per_register * (x + 1);
+    };
+
+    REQUIRE(fx65(0xF065) < fx65(0xF165));
+    REQUIRE(fx65(0xFF65) - fx65(0xF065) == 15 * 14);
+}
+
+TEST_CASE("cosmac_vip timing charges the VIP interpreter's machine cycles")
+{
+    const auto [opcode, base, skip_taken] =
+        GENERATE(table<std::uint16_t, int, int>({
+            {0x00E0, 2112, 0}, {0x00EE, 63, 0}, {0x1234, 63, 0},
+            {0x2234, 63, 0},   {0x3122, 50, 4}, {0x4122, 50, 4},
+            {0x5120, 54, 4},   {0x6122, 46, 0}, {0x7122, 50, 0},
+            {0x8124, 84, 0},   {0x9120, 54, 4}, {0xA234, 52, 0},
+            {0xB234, 63, 0},   {0xC1FF, 76, 0}, {0xE19E, 54, 4},
+            {0xE1A1, 54, 4},   {0xF107, 50, 0}, {0xF10A, 50, 0},
+            {0xF115, 50, 0},   {0xF118, 50, 0}, {0xF11E, 59, 0},
+            {0xF129, 60, 0},   {0xF133, 244, 0},
+        }));
+
+    const auto& cost = ch8::vip::timing.at(ch8::timing_index(opcode));
+    REQUIRE(cost.base == base);
+    REQUIRE(cost.skip_taken == skip_taken);
+    REQUIRE(cost.per_register == 0);
+    REQUIRE(cost.unaligned == 0);
+}
+
+TEST_CASE("cosmac_vip timing charges Dxyn by sprite height")
+{
+    const auto height = GENERATE(range(0, 16));
+
+    const auto opcode = static_cast<std::uint16_t>(0xD010 + height);
+    const auto& cost = ch8::vip::timing.at(ch8::timing_index(opcode));
+    REQUIRE(cost.base == 66 + height * 17);
+    REQUIRE(cost.unaligned == height * 14);
+}
+
+TEST_CASE("reset starts cosmac_vip timing over")
+{
+    const auto run_frame = [](ch8::chip8_system& system) {
+        system.timing = ch8::timing_model::cosmac_vip;
+        system.data.ram.at(0x200) = 0x12; // 200: JP 0x200
+        system.data.ram.at(0x201) = 0x00;
+        system.data.delay_timer = 5;
+        system.execute(std::chrono::milliseconds{16});
+    };
+
+    auto fresh = ch8::chip8_system{};
+    run_frame(fresh);
+
+    auto reused = ch8::chip8_system{};
+    run_frame(reused);
+    reused.execute(std::chrono::milliseconds{9});
+    reused.reset();
+    REQUIRE(reused.machine_cycle_count() == 0);
+    run_frame(reused);
+
+    REQUIRE(reused.machine_cycle_count() == fresh.machine_cycle_count());
+    REQUIRE(reused.cycle_count() == fresh.cycle_count());
+    REQUIRE(reused.data.delay_timer == fresh.data.delay_timer);
+}
+
+TEST_CASE("cosmac_vip timing returns traps")
+{
+    auto system = ch8::chip8_system{};
+    system.timing = ch8::timing_model::cosmac_vip;
+    system.data.ram.at(0x200) = 0x00; // 200: RET
+    system.data.ram.at(0x201) = 0xEE;
+
+    REQUIRE(
+        system.execute(std::chrono::milliseconds{1}) ==
+        ch8::trap::stack_underflow);
+    REQUIRE(system.data.program_counter == 0x200);
+}
+
+TEST_CASE("run skips jumps to self")
+{
+    auto system = ch8::chip8_system{};
+    system.data.ram.at(0x200) = 0x12;
+    system.data.ram.at(0x201) = 0x00;
+
+    REQUIRE(system.run(1000) == ch8::trap::none);
+
+    REQUIRE(system.data.program_counter == 0x200);
+    REQUIRE(system.idle_stats().fast_forwards == 1);
+    REQUIRE(system.idle_stats().skipped_instructions == 1000);
+}
+
+TEST_CASE("skipping idle loops leaves the same state as running them")
+{
+    constexpr auto rom = std::array<std::uint8_t, 14>{
+        0x70, 0x01, // 200: ADD V0, 0x01
+        0xF3, 0x07, // 202: LD V3, DT
+        0x33, 0x00, // 204: SE V3, 0x00
+        0x12, 0x02, // 206: JP 0x202
+        0xF4, 0x07, // 208: LD V4, DT
+        0x44, 0x00, // 20A: SNE V4, 0x00
+        0x12, 0x08, // 20C: JP 0x208
+    };
+
+    const auto engine = GENERATE(
+        ch8::execution_engine::interpreter, ch8::execution_engine::cached,
+        ch8::execution_engine::threaded, ch8::execution_engine::jit);
+    const auto instruction_count = GENERATE(1U, 2U, 7U, 50U);
+
+    auto skipped = ch8::chip8_system{};
+    auto executed = ch8::chip8_system{};
+    executed.skip_idle_loops = false;
+
+    for (auto* system : {&skipped, &executed}) {
+        load(*system, rom);
+        system->engine = engine;
+        system->updates_per_second = 1000;
+        system->data.delay_timer = 3;
+    }
+
+    for (auto i = 0; i < 30; ++i) {
+        skipped.run(instruction_count);
+        executed.run(instruction_count);
+        require_same_state(skipped.data, executed.data);
+
+        skipped.execute(std::chrono::milliseconds{9});
+        executed.execute(std::chrono::milliseconds{9});
+        require_same_state(skipped.data, executed.data);
+    }
+
+    REQUIRE(skipped.idle_stats().skipped_instructions > 0);
+    REQUIRE(executed.idle_stats().skipped_instructions == 0);
+}
+
+TEST_CASE("run skips Fx0A until a key is pressed")
+{
+    auto system = ch8::chip8_system{};
+    system.data.ram.at(0x200) = 0xF5;
+    system.data.ram.at(0x201) = 0x0A;
+
+    system.run(1);
+    REQUIRE(system.data.waiting_for_keypress);
+
+    system.run(100);
+    REQUIRE(system.idle_stats().skipped_instructions == 100);
+
+    system.data.keypad.set(0x7);
+    system.run(1);
+    REQUIRE(system.data.registers.at(0x5) == 0x7);
+    REQUIRE(system.idle_stats().skipped_instructions == 100);
+
+    system.run(100);
+    REQUIRE(system.idle_stats().skipped_instructions == 200);
+
+    system.data.keypad.reset();
+    system.run(1);
+    REQUIRE_FALSE(system.data.waiting_for_keypress);
+    REQUIRE(system.data.program_counter == 0x202);
+}
+
+TEST_CASE("Sound observers hear the sound timer start and run out")
+{
+    constexpr auto rom = std::array<std::uint8_t, 6>{
+        0x60, 0x02, // 200: LD V0, 0x02
+        0xF0, 0x18, // 202: LD ST, V0
+        0x12, 0x04, // 204: JP 0x204
+    };
+
+    auto system = ch8::chip8_system{};
+    load(system, rom);
+    auto sound = std::vector<bool>{};
+    system.observe<ch8::machine_event::sound_start>(
+        [&sound]() { sound.push_back(true); });
+    system.observe<ch8::machine_event::sound_stop>(
+        [&sound]() { sound.push_back(false); });
+
+    system.run(2);
+    REQUIRE(sound == std::vector<bool>{true});
+
+    system.update_timers();
+    system.update_timers();
+    system.update_timers();
+    REQUIRE(sound == std::vector<bool>{true, false});
+}
+
+TEST_CASE("Key wait observers see Fx0A start and finish waiting")
+{
+    constexpr auto rom = std::array<std::uint8_t, 4>{
+        0xF3, 0x0A, // 200: LD V3, K
+        0x12, 0x02, // 202: JP 0x202
+    };
+
+    auto system = ch8::chip8_system{};
+    load(system, rom);
+    auto starts = 0;
+    auto ends = 0;
+    system.observe<ch8::machine_event::key_wait_start>(
+        [&starts]() { ++starts; });
+    system.observe<ch8::machine_event::key_wait_end>([&ends]() { ++ends; });
+
+    system.run(5);
+    REQUIRE(starts == 1);
+    REQUIRE(ends == 0);
+
+    system.data.keypad.set(0x7);
+    system.run(1);
+    system.data.keypad.reset();
+    system.run(5);
+    REQUIRE(starts == 1);
+    REQUIRE(ends == 1);
+    REQUIRE(system.data.registers[3] == 0x7);
+}
+
+TEST_CASE("Delay timer observers are told when it reaches zero")
+{
+    auto system = ch8::chip8_system{};
+    system.data.delay_timer = 2;
+    auto zeroes = 0;
+    system.observe<ch8::machine_event::delay_timer_zero>(
+        [&zeroes]() { ++zeroes; });
+
+    system.update_timers();
+    REQUIRE(zeroes == 0);
+    system.update_timers();
+    system.update_timers();
+    REQUIRE(zeroes == 1);
+}
+
+TEST_CASE("Trap observers get the trap that stopped execution")
+{
+    auto system = ch8::chip8_system{};
+    system.data.ram.at(0x200) = 0x00; // 200: RET
+    system.data.ram.at(0x201) = 0xEE;
+
+    auto traps = std::vector<ch8::trap>{};
+    system.observe<ch8::machine_event::trap>(
+        [&traps](ch8::trap reason) { traps.push_back(reason); });
+
+    REQUIRE(system.execute(std::chrono::seconds{1}) != ch8::trap::none);
+    REQUIRE(traps == std::vector<ch8::trap>{ch8::trap::stack_underflow});
+}
+
+TEST_CASE("Memory write observers see writes to the watched range")
+{
+    constexpr auto rom = std::array<std::uint8_t, 10>{
+        0xA3, 0x00, // 200: LD I, 0x300
+        0xF2, 0x55, // 202: LD [I], V2
+        0xA4, 0x00, // 204: LD I, 0x400
+        0xF0, 0x33, // 206: LD B, V0
+        0x12, 0x08, // 208: JP 0x208
+    };
+
+    const auto engine = GENERATE(
+        ch8::execution_engine::interpreter, ch8::execution_engine::cached,
+        ch8::execution_engine::threaded, ch8::execution_engine::jit);
+
+    auto system = ch8::chip8_system{};
+    system.engine = engine;
+    load(system, rom);
+    system.watch_memory({0x3F0, 0x4FF});
+
+    auto writes = std::vector<std::pair<int, int>>{};
+    system.observe<ch8::machine_event::memory_write>(
+        [&writes](const ch8::memory_range& range) {
+            writes.emplace_back(range.first, range.last);
+        });
+
+    system.run(10);
+    REQUIRE(writes == std::vector<std::pair<int, int>>{{0x400, 0x402}});
+}
+
+TEST_CASE("Traced systems record every instruction they run")
+{
+    if (!ch8::trace_ring::supported()) {
+        return;
+    }
+
+    constexpr auto rom = std::array<std::uint8_t, 8>{
+        0xA3, 0x00, // 200: LD I, 0x300
+        0x63, 0x05, // 202: LD V3, 5
+        0x73, 0x02, // 204: ADD V3, 2
+        0x12, 0x06, // 206: JP 0x206
+    };
+
+    const auto engine = GENERATE(
+        ch8::execution_engine::interpreter, ch8::execution_engine::cached,
+        ch8::execution_engine::threaded, ch8::execution_engine::jit);
+
+    auto system = ch8::chip8_system{};
+    system.engine = engine;
+    load(system, rom);
+
+    auto ring = ch8::trace_ring{16};
+    system.trace(&ring);
+    system.run(6);
+
+    auto trace = std::vector<ch8::trace_record>(16);
+    trace.resize(ring.pop(trace));
+    REQUIRE(trace.size() == 6);
+
+    REQUIRE(trace[0].program_counter == 0x200);
+    REQUIRE(trace[0].i_register == 0x300);
+    REQUIRE(trace[2].opcode == 0x7302);
+    REQUIRE(trace[2].changed_register == 3);
+    REQUIRE(trace[2].value == 7);
+    REQUIRE(trace[5].program_counter == 0x206);
+
+    system.trace(nullptr);
+    system.run(4);
+    REQUIRE(ring.size() == 0);
+}
+
+TEST_CASE("Profiled systems count every instruction they run")
+{
+    constexpr auto rom = std::array<std::uint8_t, 6>{
+        0x63, 0x05, // 200: LD V3, 5
+        0x73, 0x02, // 202: ADD V3, 2
+        0x12, 0x02, // 204: JP 0x202
+    };
+
+    const auto engine = GENERATE(
+        ch8::execution_engine::interpreter, ch8::execution_engine::cached,
+        ch8::execution_engine::threaded, ch8::execution_engine::jit);
+
+    auto system = ch8::chip8_system{};
+    system.engine = engine;
+    load(system, rom);
+
+    auto profiler = ch8::profiler{2};
+    system.profile(&profiler);
+    system.run(9);
+
+    REQUIRE(profiler.instructions() == 9);
+    REQUIRE(profiler.executions_at(0x200) == 1);
+    REQUIRE(profiler.executions_at(0x202) == 4);
+    REQUIRE(profiler.statistics(ch8::opcode_class::op_1nnn).executions == 4);
+
+    auto samples = std::uint64_t{0};
+    for (auto i = std::size_t{0}; i < ch8::opcode_classes; ++i) {
+        samples +=
+            profiler.statistics(static_cast<ch8::opcode_class>(i)).samples;
+    }
+    REQUIRE(samples == 4);
+
+    system.profile(nullptr);
+    system.run(4);
+    REQUIRE(profiler.instructions() == 9);
+}
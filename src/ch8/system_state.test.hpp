@@ -0,0 +1,35 @@
+#ifndef CH8_SYSTEM_STATE_TEST_HPP
+#define CH8_SYSTEM_STATE_TEST_HPP
+
+#include "ch8/system.hpp"
+#include <algorithm>
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+
+template <std::size_t Size>
+auto load(ch8::chip8_system& system, const std::array<std::uint8_t, Size>& rom)
+    -> void
+{
+    std::copy(
+        rom.begin(), rom.end(),
+        system.data.ram.begin() + ch8::chip8_data::program_start);
+}
+
+inline auto
+require_same_state(const ch8::chip8_data& a, const ch8::chip8_data& b) -> void
+{
+    REQUIRE(a.program_counter == b.program_counter);
+    REQUIRE(a.i_register == b.i_register);
+    REQUIRE(a.delay_timer == b.delay_timer);
+    REQUIRE(a.sound_timer == b.sound_timer);
+    REQUIRE(a.stack_pointer == b.stack_pointer);
+    REQUIRE(a.ram == b.ram);
+    REQUIRE(a.registers == b.registers);
+    REQUIRE(a.stack == b.stack);
+    REQUIRE(a.keypad == b.keypad);
+    REQUIRE(a.screen.data() == b.screen.data());
+    REQUIRE(a.waiting_for_keypress == b.waiting_for_keypress);
+}
+
+#endif // CH8_SYSTEM_STATE_TEST_HPP
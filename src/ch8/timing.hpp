@@ -0,0 +1,121 @@
+#ifndef CH8_TIMING_HPP
+#define CH8_TIMING_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ch8 {
+    // fixed gives every instruction one slot of updates_per_second.
+    // cosmac_vip charges each instruction the machine cycles the original
+    // interpreter spent on it, ignores updates_per_second and always runs on
+    // the interpreter, without skipping idle loops.
+    enum class timing_model { fixed, cosmac_vip };
+
+    // What one instruction costs in machine cycles, before the parts that
+    // depend on the machine state: each register Fx55 and Fx65 copy, a
+    // sprite that doesn't start on a byte boundary and a skip being taken.
+    struct instruction_timing {
+        std::uint16_t base;
+        std::uint8_t per_register;
+        std::uint8_t unaligned;
+        std::uint8_t skip_taken;
+    };
+
+    using timing_table = std::array<instruction_timing, 16 * 256>;
+
+    [[nodiscard]] constexpr auto timing_index(std::uint16_t opcode) noexcept
+        -> std::size_t;
+    [[nodiscard]] constexpr auto make_vip_timing() noexcept -> timing_table;
+} // namespace ch8
+
+namespace ch8::vip {
+    // A 1.76064 MHz 1802 takes 8 clock cycles per machine cycle.
+    constexpr auto cycles_per_second = std::uint64_t{220'080};
+    constexpr auto cycles_per_frame = std::uint64_t{3'668};
+
+    // The 1861 takes one machine cycle per byte it displays, 8 bytes on each
+    // of 128 lines, and the interrupt routine that sets it up and counts
+    // the timers down takes the rest.
+    constexpr auto display_cycles = std::uint64_t{1'024};
+    constexpr auto interrupt_cycles = std::uint64_t{46};
+    constexpr auto stolen_cycles = display_cycles + interrupt_cycles;
+
+    // Fetching and dispatching an instruction, paid by every instruction.
+    constexpr auto dispatch_cycles = 40;
+} // namespace ch8::vip
+
+constexpr auto ch8::timing_index(const std::uint16_t opcode) noexcept
+    -> std::size_t
+{
+    return (std::size_t{opcode} >> 12U) * 256U + (opcode & 0x00FFU);
+}
+
+// Costs are the published execution times of the VIP interpreter's routines,
+// in machine cycles, on top of the fetch and decode every instruction pays.
+// A skip costs the time of not skipping, plus skip_taken when it skips. The
+// 00E0 routine clears 256 bytes with a four-instruction loop, 8 machine
+// cycles per byte, after 24 cycles of setup. Dxyn shifts every row of an
+// unaligned sprite into two bytes.
+constexpr auto ch8::make_vip_timing() noexcept -> timing_table
+{
+    constexpr auto dispatch = vip::dispatch_cycles;
+    auto table = timing_table{};
+
+    const auto fill_row = [&table](std::size_t row, instruction_timing t) {
+        for (auto low = std::size_t{0}; low < 256; ++low) {
+            table[row * 256 + low] = t;
+        }
+    };
+    const auto cost = [](int cycles) {
+        return static_cast<std::uint16_t>(cycles);
+    };
+
+    fill_row(0x0, {cost(dispatch), 0, 0, 0});
+    table[0x0E0] = {cost(dispatch + 24 + 256 * 8), 0, 0, 0};
+    table[0x0EE] = {cost(dispatch + 23), 0, 0, 0};
+    fill_row(0x1, {cost(dispatch + 23), 0, 0, 0});
+    fill_row(0x2, {cost(dispatch + 23), 0, 0, 0});
+    fill_row(0x3, {cost(dispatch + 10), 0, 0, 4});
+    fill_row(0x4, {cost(dispatch + 10), 0, 0, 4});
+    fill_row(0x5, {cost(dispatch + 14), 0, 0, 4});
+    fill_row(0x6, {cost(dispatch + 6), 0, 0, 0});
+    fill_row(0x7, {cost(dispatch + 10), 0, 0, 0});
+    fill_row(0x8, {cost(dispatch + 44), 0, 0, 0});
+    fill_row(0x9, {cost(dispatch + 14), 0, 0, 4});
+    fill_row(0xA, {cost(dispatch + 12), 0, 0, 0});
+    fill_row(0xB, {cost(dispatch + 23), 0, 0, 0});
+    fill_row(0xC, {cost(dispatch + 36), 0, 0, 0});
+
+    for (auto low = std::size_t{0}; low < 256; ++low) {
+        const auto rows = static_cast<int>(low & 0xFU);
+        table[0xD00 + low] = {
+            cost(dispatch + 26 + rows * 17),
+            0,
+            static_cast<std::uint8_t>(rows * 14),
+            0};
+    }
+
+    fill_row(0xE, {cost(dispatch), 0, 0, 0});
+    table[0xE9E] = {cost(dispatch + 14), 0, 0, 4};
+    table[0xEA1] = {cost(dispatch + 14), 0, 0, 4};
+
+    fill_row(0xF, {cost(dispatch), 0, 0, 0});
+    table[0xF07] = {cost(dispatch + 10), 0, 0, 0};
+    table[0xF0A] = {cost(dispatch + 10), 0, 0, 0};
+    table[0xF15] = {cost(dispatch + 10), 0, 0, 0};
+    table[0xF18] = {cost(dispatch + 10), 0, 0, 0};
+    table[0xF1E] = {cost(dispatch + 19), 0, 0, 0};
+    table[0xF29] = {cost(dispatch + 20), 0, 0, 0};
+    table[0xF33] = {cost(dispatch + 204), 0, 0, 0};
+    table[0xF55] = {cost(dispatch + 14), 14, 0, 0};
+    table[0xF65] = {cost(dispatch + 14), 14, 0, 0};
+
+    return table;
+}
+
+namespace ch8::vip {
+    inline constexpr auto timing = make_vip_timing();
+} // namespace ch8::vip
+
+#endif // CH8_TIMING_HPP
@@ -0,0 +1,220 @@
+#include "ch8/trace.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <istream>
+#include <ostream>
+
+namespace {
+    constexpr auto magic = std::array{'C', 'H', '8', 'T', 'R', 'A', 'C', 'E'};
+    constexpr auto version = std::uint16_t{1};
+    constexpr auto record_size = std::uint16_t{sizeof(ch8::trace_record)};
+
+    using encoded_record = std::array<char, sizeof(ch8::trace_record)>;
+
+    constexpr auto low(const std::uint16_t value) noexcept -> char
+    {
+        return static_cast<char>(value & 0xFFU);
+    }
+
+    constexpr auto high(const std::uint16_t value) noexcept -> char
+    {
+        return static_cast<char>(value >> 8U);
+    }
+
+    constexpr auto byte_at(const encoded_record& bytes, std::size_t index)
+        -> std::uint8_t
+    {
+        return static_cast<std::uint8_t>(bytes.at(index));
+    }
+
+    constexpr auto word_at(const encoded_record& bytes, std::size_t index)
+        -> std::uint16_t
+    {
+        return static_cast<std::uint16_t>(
+            byte_at(bytes, index) | byte_at(bytes, index + 1) << 8U);
+    }
+
+    constexpr auto encode(const ch8::trace_record& record) noexcept
+        -> encoded_record
+    {
+        return {
+            low(record.program_counter), high(record.program_counter),
+            low(record.opcode),          high(record.opcode),
+            low(record.i_register),      high(record.i_register),
+            static_cast<char>(record.changed_register),
+            static_cast<char>(record.value)};
+    }
+
+    constexpr auto decode(const encoded_record& bytes) -> ch8::trace_record
+    {
+        return {
+            word_at(bytes, 0), word_at(bytes, 2), word_at(bytes, 4),
+            byte_at(bytes, 6), byte_at(bytes, 7)};
+    }
+} // namespace
+
+auto ch8::trace_ring::supported() noexcept -> bool
+{
+#if defined(CH8_INSTRUCTION_TRACE)
+    return true;
+#else
+    return false;
+#endif
+}
+
+ch8::trace_ring::trace_ring(const std::size_t capacity)
+    : records(std::max(std::size_t{2}, capacity))
+    , mask{0}
+{
+    auto rounded = std::size_t{1};
+    while (rounded < records.size()) {
+        rounded <<= 1U;
+    }
+    records.resize(rounded);
+    mask = rounded - 1;
+}
+
+auto ch8::trace_ring::pop(const gsl::span<trace_record> out) noexcept
+    -> std::size_t
+{
+    const auto at = tail.load(std::memory_order_relaxed);
+    const auto available = head.load(std::memory_order_acquire) - at;
+    const auto count = std::min(available, out.size());
+
+    for (auto i = std::size_t{0}; i < count; ++i) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        out[i] = records[(at + i) & mask];
+    }
+    tail.store(at + count, std::memory_order_release);
+    return count;
+}
+
+auto ch8::trace_ring::capacity() const noexcept -> std::size_t
+{
+    return records.size();
+}
+
+auto ch8::trace_ring::size() const noexcept -> std::size_t
+{
+    return head.load(std::memory_order_acquire) -
+           tail.load(std::memory_order_acquire);
+}
+
+auto ch8::trace_ring::dropped() const noexcept -> std::uint64_t
+{
+    return dropped_records.load(std::memory_order_relaxed);
+}
+
+auto ch8::write_trace_header(std::ostream& out) -> void
+{
+    out.write(magic.data(), magic.size());
+    const auto fields =
+        std::array{low(version), high(version), low(record_size),
+                   high(record_size)};
+    out.write(fields.data(), fields.size());
+}
+
+auto ch8::write_trace(
+    std::ostream& out, const gsl::span<const trace_record> trace) -> void
+{
+    for (const auto& record : trace) {
+        const auto bytes = encode(record);
+        out.write(bytes.data(), bytes.size());
+    }
+}
+
+auto ch8::read_trace(std::istream& in, std::vector<trace_record>& trace)
+    -> trace_status
+{
+    auto header = std::array<char, magic.size() + 4>{};
+    if (!in.read(header.data(), header.size()) ||
+        !std::equal(magic.begin(), magic.end(), header.begin())) {
+        return trace_status::not_a_trace;
+    }
+
+    const auto field = [&header](const std::size_t index) {
+        return static_cast<std::uint16_t>(
+            static_cast<std::uint8_t>(header.at(index)) |
+            static_cast<std::uint8_t>(header.at(index + 1)) << 8U);
+    };
+    if (field(magic.size()) != version ||
+        field(magic.size() + 2) != record_size) {
+        return trace_status::unsupported_version;
+    }
+
+    auto bytes = encoded_record{};
+    while (in.read(bytes.data(), bytes.size())) {
+        trace.push_back(decode(bytes));
+    }
+    return trace_status::ok;
+}
+
+ch8::trace_writer::trace_writer(
+    trace_ring& ring, const std::filesystem::path& file_path)
+    : source{ring}
+    , file{file_path, std::ios::binary}
+{
+    write_trace_header(file);
+    if (!file) {
+        failed.store(true, std::memory_order_relaxed);
+        return;
+    }
+    thread = std::thread{[this]() { drain(); }};
+}
+
+ch8::trace_writer::~trace_writer()
+{
+    stop();
+}
+
+auto ch8::trace_writer::stop() -> void
+{
+    running.store(false, std::memory_order_release);
+    if (thread.joinable()) {
+        thread.join();
+        file.close();
+    }
+}
+
+auto ch8::trace_writer::written() const noexcept -> std::uint64_t
+{
+    return written_records.load(std::memory_order_relaxed);
+}
+
+auto ch8::trace_writer::good() const noexcept -> bool
+{
+    return !failed.load(std::memory_order_relaxed);
+}
+
+// Polls rather than being woken, so pushing never has to signal anything.
+// Once stopped, the ring is emptied before the thread returns. A write that
+// fails ends the thread there, leaving the ring to fill up and drop.
+auto ch8::trace_writer::drain() -> void
+{
+    auto buffer = std::vector<trace_record>(4096);
+    auto stopping = false;
+    while (true) {
+        const auto count = source.pop(buffer);
+        if (count > 0) {
+            write_trace(file, {buffer.data(), count});
+            if (!file) {
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+            written_records.fetch_add(count, std::memory_order_relaxed);
+            continue;
+        }
+
+        if (stopping) {
+            break;
+        }
+        stopping = !running.load(std::memory_order_acquire);
+        if (!stopping) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+    }
+
+    file.flush();
+    failed.store(!file, std::memory_order_relaxed);
+}
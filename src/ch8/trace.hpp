@@ -0,0 +1,115 @@
+#ifndef CH8_TRACE_HPP
+#define CH8_TRACE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <gsl-lite/gsl-lite.hpp>
+#include <iosfwd>
+#include <thread>
+#include <vector>
+
+namespace ch8 {
+    // One executed instruction. The changed register is the x of the opcode
+    // and value is Vx once the instruction has run, which covers every
+    // instruction that changes a single register.
+    struct trace_record {
+        std::uint16_t program_counter;
+        std::uint16_t opcode;
+        std::uint16_t i_register;
+        std::uint8_t changed_register;
+        std::uint8_t value;
+    };
+
+    static_assert(sizeof(trace_record) == 8);
+
+    // A fixed-size ring between the thread running the program, which
+    // pushes, and a single reader, which pops. Neither ever waits for the
+    // other: records pushed while the ring is full are dropped and counted.
+    class trace_ring {
+    public:
+        // Records are only made by builds with INSTRUCTION_TRACE on.
+        [[nodiscard]] static auto supported() noexcept -> bool;
+
+        // The capacity is rounded up to a power of two.
+        explicit trace_ring(std::size_t capacity = std::size_t{1} << 16U);
+
+        auto push(const trace_record& record) noexcept -> bool;
+        // Moves up to out.size() of the oldest records into out and returns
+        // how many it moved.
+        auto pop(gsl::span<trace_record> out) noexcept -> std::size_t;
+
+        [[nodiscard]] auto capacity() const noexcept -> std::size_t;
+        [[nodiscard]] auto size() const noexcept -> std::size_t;
+        [[nodiscard]] auto dropped() const noexcept -> std::uint64_t;
+
+    private:
+        std::vector<trace_record> records;
+        std::size_t mask;
+        // Kept on separate cache lines so the two threads don't fight over
+        // them.
+        alignas(64) std::atomic<std::size_t> head{0};
+        alignas(64) std::atomic<std::size_t> tail{0};
+        std::atomic<std::uint64_t> dropped_records{0};
+    };
+
+    enum class trace_status { ok, not_a_trace, unsupported_version };
+
+    // A trace file is "CH8TRACE", a 16-bit version and a 16-bit record size,
+    // followed by the records, with every field little-endian.
+    auto write_trace_header(std::ostream& out) -> void;
+    auto write_trace(std::ostream& out, gsl::span<const trace_record> trace)
+        -> void;
+    // A partial record at the end, from a writer that didn't finish, is
+    // ignored.
+    auto read_trace(std::istream& in, std::vector<trace_record>& trace)
+        -> trace_status;
+
+    // Drains a ring to a trace file on a background thread until stopped.
+    // If the file can't be opened or written, good() turns false and the
+    // ring is no longer drained.
+    class trace_writer {
+    public:
+        trace_writer(trace_ring& ring, const std::filesystem::path& file);
+        trace_writer(const trace_writer&) = delete;
+        trace_writer(trace_writer&&) = delete;
+        ~trace_writer();
+
+        auto operator=(const trace_writer&) -> trace_writer& = delete;
+        auto operator=(trace_writer&&) -> trace_writer& = delete;
+
+        // Writes what is left in the ring and closes the file.
+        auto stop() -> void;
+
+        [[nodiscard]] auto written() const noexcept -> std::uint64_t;
+        [[nodiscard]] auto good() const noexcept -> bool;
+
+    private:
+        auto drain() -> void;
+
+        trace_ring& source;
+        std::ofstream file;
+        std::atomic<bool> running{true};
+        std::atomic<std::uint64_t> written_records{0};
+        std::atomic<bool> failed{false};
+        std::thread thread;
+    };
+} // namespace ch8
+
+inline auto ch8::trace_ring::push(const trace_record& record) noexcept -> bool
+{
+    const auto at = head.load(std::memory_order_relaxed);
+    if (at - tail.load(std::memory_order_acquire) == records.size()) {
+        dropped_records.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+    records[at & mask] = record;
+    head.store(at + 1, std::memory_order_release);
+    return true;
+}
+
+#endif // CH8_TRACE_HPP
@@ -0,0 +1,187 @@
+#include "ch8/trace.hpp"
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+    auto record_at(const std::uint16_t pc) -> ch8::trace_record
+    {
+        return {
+            pc, static_cast<std::uint16_t>(0x6000U | (pc & 0xFFU)), 0x300,
+            static_cast<std::uint8_t>(pc & 0xFU),
+            static_cast<std::uint8_t>(pc)};
+    }
+
+    auto same(const ch8::trace_record& a, const ch8::trace_record& b) -> bool
+    {
+        return a.program_counter == b.program_counter &&
+               a.opcode == b.opcode && a.i_register == b.i_register &&
+               a.changed_register == b.changed_register &&
+               a.value == b.value;
+    }
+} // namespace
+
+TEST_CASE("trace_ring rounds its capacity up to a power of two")
+{
+    REQUIRE(ch8::trace_ring{5}.capacity() == 8);
+    REQUIRE(ch8::trace_ring{64}.capacity() == 64);
+    REQUIRE(ch8::trace_ring{0}.capacity() == 2);
+}
+
+TEST_CASE("trace_ring pops records in the order they were pushed")
+{
+    auto ring = ch8::trace_ring{8};
+    for (auto pc = std::uint16_t{0x200}; pc < 0x20A; pc += 2) {
+        REQUIRE(ring.push(record_at(pc)));
+    }
+    REQUIRE(ring.size() == 5);
+
+    auto out = std::vector<ch8::trace_record>(3);
+    REQUIRE(ring.pop(out) == 3);
+    REQUIRE(same(out[0], record_at(0x200)));
+    REQUIRE(same(out[2], record_at(0x204)));
+
+    REQUIRE(ring.pop(out) == 2);
+    REQUIRE(same(out[1], record_at(0x208)));
+    REQUIRE(ring.pop(out) == 0);
+}
+
+TEST_CASE("trace_ring drops and counts records pushed while full")
+{
+    auto ring = ch8::trace_ring{4};
+    for (auto pc = std::uint16_t{0}; pc < 6; ++pc) {
+        ring.push(record_at(pc));
+    }
+    REQUIRE(ring.size() == 4);
+    REQUIRE(ring.dropped() == 2);
+
+    auto out = std::vector<ch8::trace_record>(4);
+    REQUIRE(ring.pop(out) == 4);
+    REQUIRE(same(out[3], record_at(3)));
+    REQUIRE(ring.push(record_at(7)));
+}
+
+TEST_CASE("trace_ring hands every record to a reader on another thread")
+{
+    constexpr auto count = 100'000U;
+    auto ring = ch8::trace_ring{256};
+
+    auto producer = std::thread{[&ring]() {
+        for (auto i = 0U; i < count; ++i) {
+            while (!ring.push(record_at(static_cast<std::uint16_t>(i)))) {
+                std::this_thread::yield();
+            }
+        }
+    }};
+
+    auto in_order = true;
+    auto received = 0U;
+    auto out = std::vector<ch8::trace_record>(64);
+    while (received < count) {
+        const auto popped = ring.pop(out);
+        for (auto i = std::size_t{0}; i < popped; ++i, ++received) {
+            in_order = in_order &&
+                       same(out[i], record_at(
+                                        static_cast<std::uint16_t>(received)));
+        }
+    }
+    producer.join();
+
+    REQUIRE(in_order);
+}
+
+TEST_CASE("read_trace reads back what write_trace wrote")
+{
+    const auto records =
+        std::vector{record_at(0x200), record_at(0x2FE), record_at(0xFFF)};
+
+    auto stream = std::stringstream{};
+    ch8::write_trace_header(stream);
+    ch8::write_trace(stream, records);
+    stream << 'x';
+
+    auto read = std::vector<ch8::trace_record>{};
+    REQUIRE(ch8::read_trace(stream, read) == ch8::trace_status::ok);
+    REQUIRE(read.size() == records.size());
+    for (auto i = std::size_t{0}; i < read.size(); ++i) {
+        REQUIRE(same(read[i], records[i]));
+    }
+}
+
+TEST_CASE("Trace fields are written little-endian")
+{
+    const auto records =
+        std::vector{ch8::trace_record{0x0234, 0xF133, 0x0ABC, 0x1, 0x7F}};
+
+    auto stream = std::stringstream{};
+    ch8::write_trace(stream, records);
+
+    REQUIRE(
+        stream.str() ==
+        std::string{"\x34\x02\x33\xF1\xBC\x0A\x01\x7F", 8});
+}
+
+TEST_CASE("read_trace rejects files that aren't traces")
+{
+    auto read = std::vector<ch8::trace_record>{};
+
+    auto garbage = std::stringstream{"not a trace at all"};
+    REQUIRE(ch8::read_trace(garbage, read) == ch8::trace_status::not_a_trace);
+
+    auto newer =
+        std::stringstream{std::string{"CH8TRACE\x02\x00\x08\x00", 12}};
+    REQUIRE(
+        ch8::read_trace(newer, read) ==
+        ch8::trace_status::unsupported_version);
+}
+
+TEST_CASE("trace_writer drains the ring to a file")
+{
+    const auto path =
+        std::filesystem::temp_directory_path() / "ch8_trace_writer.trace";
+
+    auto ring = ch8::trace_ring{16};
+    {
+        auto writer = ch8::trace_writer{ring, path};
+        for (auto pc = std::uint16_t{0}; pc < 1000; ++pc) {
+            while (!ring.push(record_at(pc))) {
+                std::this_thread::yield();
+            }
+        }
+        writer.stop();
+        REQUIRE(writer.good());
+        REQUIRE(writer.written() == 1000);
+    }
+
+    auto file = std::ifstream{path, std::ios::binary};
+    auto read = std::vector<ch8::trace_record>{};
+    REQUIRE(ch8::read_trace(file, read) == ch8::trace_status::ok);
+    REQUIRE(read.size() == 1000);
+    REQUIRE(same(read.back(), record_at(999)));
+
+    file.close();
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("trace_writer reports a file it can't open")
+{
+    const auto path = std::filesystem::temp_directory_path() /
+                      "ch8_missing_directory" / "writer.trace";
+
+    auto ring = ch8::trace_ring{16};
+    auto writer = ch8::trace_writer{ring, path};
+    REQUIRE_FALSE(writer.good());
+
+    for (auto pc = std::uint16_t{0}; pc < 16; ++pc) {
+        REQUIRE(ring.push(record_at(pc)));
+    }
+    REQUIRE_FALSE(ring.push(record_at(16)));
+
+    writer.stop();
+    REQUIRE_FALSE(writer.good());
+    REQUIRE(writer.written() == 0);
+    REQUIRE_FALSE(std::filesystem::exists(path));
+}
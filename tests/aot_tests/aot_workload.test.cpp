@@ -0,0 +1,69 @@
+#include "aot_workload.hpp"
+#include "ch8/native_code.hpp"
+#include "ch8/system.hpp"
+#include "ch8/system_state.test.hpp"
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <iterator>
+
+// aot_workload.ch8 touches every instruction chip8-aot translates, along
+// with calls, skips, Bnnn, timers and drawing:
+//
+// 200: LD V0, 0x05       216: AND V7, V2        230: LD F, V0
+// 202: LD V1, 0x0A       218: XOR V8, V3        232: DRW VA, VB, 5
+// 204: LD I, 0x300       21A: LD V9, V4         234: LD I, 0x300
+// 206: CALL 0x230        21C: SE V0, 0x20       236: LD B, V1
+// 208: ADD V0, 0x01      21E: JP 0x208          238: LD V2, [I]
+// 20A: ADD V1, V0        220: CLS               23A: SNE VB, 0x00
+// 20C: SUB V2, V1        222: RND V9, 0x3F      23C: ADD VB, 0x03
+// 20E: SUBN V3, V2       224: LD DT, V9         23E: ADD I, V3
+// 210: SHL V4, V1        226: LD VA, DT         240: LD [I], VC
+// 212: SHR V5, V2        228: SE VA, V9         242: SKP VC
+// 214: OR V6, V1         22A: SNE VA, V9        244: SKNP VC
+//                        22C: JP V0, 0x1E0      246: LD ST, VD
+//                        22E: JP 0x200          248: RET
+auto load_workload(ch8::chip8_system& system) -> void
+{
+    const auto module = aot_workload();
+    std::copy_n(
+        module.program, module.program_size,
+        std::next(system.data.ram.begin(), ch8::chip8_data::program_start));
+}
+
+TEST_CASE("chip8-aot output leaves chip8_data in the same state as step()")
+{
+    const auto frames = GENERATE(1U, 2U, 10U, 100U);
+    constexpr auto per_frame = 13U;
+
+    auto stepped = ch8::chip8_system{};
+    auto native = ch8::chip8_system{};
+    native.engine = ch8::execution_engine::native;
+    native.load_native(aot_workload());
+    load_workload(stepped);
+    load_workload(native);
+    stepped.seed(1234);
+    native.seed(1234);
+
+    for (auto frame = 0U; frame < frames; ++frame) {
+        for (auto i = 0U; i < per_frame; ++i) {
+            REQUIRE(stepped.step() == ch8::trap::none);
+        }
+        REQUIRE(native.run(per_frame) == ch8::trap::none);
+        stepped.update_timers();
+        native.update_timers();
+    }
+
+    require_same_state(native.data, stepped.data);
+}
+
+TEST_CASE("chip8-aot output runs the workload natively")
+{
+    auto system = ch8::chip8_system{};
+    system.engine = ch8::execution_engine::native;
+    system.load_native(aot_workload());
+    load_workload(system);
+
+    system.run(1000);
+
+    REQUIRE(system.native_stats().native_instructions > 900);
+}